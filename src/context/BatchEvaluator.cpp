@@ -0,0 +1,361 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "context/BatchEvaluator.h"
+
+#include <iterator>
+
+#include "common/expression/ArithmeticExpression.h"
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/RelationalExpression.h"
+#include "common/expression/UnaryExpression.h"
+#include "context/EvalKernels.h"
+#include "service/GraphFlags.h"
+
+namespace nebula {
+namespace graph {
+
+class BatchEvaluator::Vector final {
+public:
+    void setConstant(const Value* value) {
+        mode_ = Mode::kConstant;
+        constant_ = value;
+    }
+
+    std::vector<const Value*>& refs() {
+        mode_ = Mode::kRefs;
+        refs_.clear();
+        return refs_;
+    }
+
+    std::vector<Value>& owned() {
+        mode_ = Mode::kOwned;
+        owned_.clear();
+        return owned_;
+    }
+
+    const Value& operator[](size_t i) const {
+        switch (mode_) {
+            case Mode::kConstant:
+                return *constant_;
+            case Mode::kRefs:
+                return *refs_[i];
+            case Mode::kOwned:
+                return owned_[i];
+        }
+        return Value::kEmpty;
+    }
+
+    bool allOf(Value::Type type, size_t size) const {
+        if (mode_ == Mode::kConstant) {
+            return constant_->type() == type;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            if ((*this)[i].type() != type) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void moveTo(size_t size, std::vector<Value>* result) {
+        if (mode_ == Mode::kOwned) {
+            std::move(owned_.begin(), owned_.end(), std::back_inserter(*result));
+            return;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            result->emplace_back((*this)[i]);
+        }
+    }
+
+private:
+    enum class Mode : uint8_t {
+        kConstant,
+        kRefs,
+        kOwned,
+    };
+
+    Mode                        mode_{Mode::kOwned};
+    const Value*                constant_{nullptr};
+    std::vector<const Value*>   refs_;
+    std::vector<Value>          owned_;
+};
+
+struct BatchEvaluator::Node {
+    enum class Type : uint8_t {
+        kConstant,
+        kColumn,
+        kNot,
+        kArithmetic,
+        kRelational,
+        kLogical,
+        // Evaluated row by row
+        kRow,
+    };
+
+    Node(Type t, Expression* e) : type(t), expr(e) {}
+
+    Type                                type;
+    Expression*                         expr;
+    // The column index of the input property
+    int64_t                             colIdx{-1};
+    std::vector<std::unique_ptr<Node>>  children;
+    Vector                              output;
+};
+
+namespace {
+
+using Node = BatchEvaluator::Node;
+using kernels::arithmetic;
+using kernels::compare;
+using kernels::isNumeric;
+using kernels::toDouble;
+
+// The rows of current batch
+struct Batch {
+    SequentialIter*                 iter;
+    size_t                          begin;
+    size_t                          size;
+    QueryExpressionContext*         ctx;
+    std::vector<const Row*>         rows;
+
+    Value evalRow(Expression* expr, size_t i) const {
+        iter->reset(begin + i);
+        return expr->eval((*ctx)(iter));
+    }
+};
+
+std::unique_ptr<Node> build(Expression* expr,
+                            const std::unordered_map<std::string, size_t>& colIndices) {
+    switch (expr->kind()) {
+        case Expression::Kind::kConstant: {
+            return std::make_unique<Node>(Node::Type::kConstant, expr);
+        }
+        case Expression::Kind::kInputProperty:
+        case Expression::Kind::kVarProperty: {
+            // Both are read from the columns of the input rows
+            auto node = std::make_unique<Node>(Node::Type::kColumn, expr);
+            auto found = colIndices.find(static_cast<PropertyExpression*>(expr)->prop());
+            if (found != colIndices.end()) {
+                node->colIdx = static_cast<int64_t>(found->second);
+            }
+            return node;
+        }
+        case Expression::Kind::kUnaryNot: {
+            auto node = std::make_unique<Node>(Node::Type::kNot, expr);
+            node->children.emplace_back(
+                build(static_cast<UnaryExpression*>(expr)->operand(), colIndices));
+            return node;
+        }
+        case Expression::Kind::kAdd:
+        case Expression::Kind::kMinus:
+        case Expression::Kind::kMultiply:
+        case Expression::Kind::kDivision:
+        case Expression::Kind::kMod: {
+            auto node = std::make_unique<Node>(Node::Type::kArithmetic, expr);
+            auto* binary = static_cast<BinaryExpression*>(expr);
+            node->children.emplace_back(build(binary->left(), colIndices));
+            node->children.emplace_back(build(binary->right(), colIndices));
+            return node;
+        }
+        case Expression::Kind::kRelEQ:
+        case Expression::Kind::kRelNE:
+        case Expression::Kind::kRelLT:
+        case Expression::Kind::kRelLE:
+        case Expression::Kind::kRelGT:
+        case Expression::Kind::kRelGE: {
+            auto node = std::make_unique<Node>(Node::Type::kRelational, expr);
+            auto* binary = static_cast<BinaryExpression*>(expr);
+            node->children.emplace_back(build(binary->left(), colIndices));
+            node->children.emplace_back(build(binary->right(), colIndices));
+            return node;
+        }
+        case Expression::Kind::kLogicalAnd:
+        case Expression::Kind::kLogicalOr: {
+            auto node = std::make_unique<Node>(Node::Type::kLogical, expr);
+            for (auto* operand : static_cast<LogicalExpression*>(expr)->operands()) {
+                node->children.emplace_back(build(operand, colIndices));
+            }
+            return node;
+        }
+        default:
+            return std::make_unique<Node>(Node::Type::kRow, expr);
+    }
+}
+
+void evalNode(Node* node, const Batch& batch) {
+    for (auto& child : node->children) {
+        evalNode(child.get(), batch);
+    }
+    auto size = batch.size;
+    auto kind = node->expr->kind();
+    switch (node->type) {
+        case Node::Type::kConstant: {
+            node->output.setConstant(&static_cast<ConstantExpression*>(node->expr)->value());
+            break;
+        }
+        case Node::Type::kColumn: {
+            if (node->colIdx < 0) {
+                node->output.setConstant(&Value::kNullValue);
+                break;
+            }
+            auto& refs = node->output.refs();
+            refs.reserve(size);
+            auto idx = static_cast<size_t>(node->colIdx);
+            for (auto* row : batch.rows) {
+                refs.emplace_back(idx < row->values.size() ? &row->values[idx]
+                                                           : &Value::kNullValue);
+            }
+            break;
+        }
+        case Node::Type::kNot: {
+            auto& operand = node->children[0]->output;
+            auto& out = node->output.owned();
+            out.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                if (operand[i].isBool()) {
+                    out.emplace_back(!operand[i].getBool());
+                } else {
+                    out.emplace_back(batch.evalRow(node->expr, i));
+                }
+            }
+            break;
+        }
+        case Node::Type::kRelational: {
+            auto& lhs = node->children[0]->output;
+            auto& rhs = node->children[1]->output;
+            auto& out = node->output.owned();
+            out.reserve(size);
+            if (lhs.allOf(Value::Type::INT, size) && rhs.allOf(Value::Type::INT, size)) {
+                for (size_t i = 0; i < size; ++i) {
+                    out.emplace_back(compare(kind, lhs[i].getInt(), rhs[i].getInt()));
+                }
+                break;
+            }
+            for (size_t i = 0; i < size; ++i) {
+                auto& l = lhs[i];
+                auto& r = rhs[i];
+                if (l.isInt() && r.isInt()) {
+                    out.emplace_back(compare(kind, l.getInt(), r.getInt()));
+                } else if (l.isStr() && r.isStr()) {
+                    out.emplace_back(compare(kind, l.getStr(), r.getStr()));
+                } else if (l.isFloat() && r.isFloat() &&
+                           (kind == Expression::Kind::kRelLT ||
+                            kind == Expression::Kind::kRelGT)) {
+                    // Equality of floats is checked with epsilon, leave it to the row path
+                    out.emplace_back(compare(kind, l.getFloat(), r.getFloat()));
+                } else if (l.isBool() && r.isBool() && (kind == Expression::Kind::kRelEQ ||
+                                                        kind == Expression::Kind::kRelNE)) {
+                    out.emplace_back(compare(kind, l.getBool(), r.getBool()));
+                } else {
+                    out.emplace_back(batch.evalRow(node->expr, i));
+                }
+            }
+            break;
+        }
+        case Node::Type::kArithmetic: {
+            auto& lhs = node->children[0]->output;
+            auto& rhs = node->children[1]->output;
+            auto& out = node->output.owned();
+            out.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                auto& l = lhs[i];
+                auto& r = rhs[i];
+                if (l.isInt() && r.isInt()) {
+                    int64_t result = 0;
+                    if (arithmetic(kind, l.getInt(), r.getInt(), &result)) {
+                        out.emplace_back(result);
+                        continue;
+                    }
+                } else if (isNumeric(l) && isNumeric(r)) {
+                    double result = 0.0;
+                    if (arithmetic(kind, toDouble(l), toDouble(r), &result)) {
+                        out.emplace_back(result);
+                        continue;
+                    }
+                }
+                out.emplace_back(batch.evalRow(node->expr, i));
+            }
+            break;
+        }
+        case Node::Type::kLogical: {
+            auto& out = node->output.owned();
+            out.reserve(size);
+            bool isAnd = kind == Expression::Kind::kLogicalAnd;
+            for (size_t i = 0; i < size; ++i) {
+                bool result = isAnd;
+                bool allBool = true;
+                for (auto& child : node->children) {
+                    auto& operand = child->output[i];
+                    if (!operand.isBool()) {
+                        allBool = false;
+                        break;
+                    }
+                    result = isAnd ? result && operand.getBool() : result || operand.getBool();
+                }
+                if (allBool) {
+                    out.emplace_back(result);
+                } else {
+                    out.emplace_back(batch.evalRow(node->expr, i));
+                }
+            }
+            break;
+        }
+        case Node::Type::kRow: {
+            auto& out = node->output.owned();
+            out.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                out.emplace_back(batch.evalRow(node->expr, i));
+            }
+            break;
+        }
+    }
+}
+
+}   // namespace
+
+// static
+std::unique_ptr<BatchEvaluator> BatchEvaluator::make(Expression* expr,
+                                                     const SequentialIter* iter) {
+    if (expr == nullptr || iter == nullptr || !iter->isSequentialIter()) {
+        return nullptr;
+    }
+    auto root = build(expr, iter->getColIndices());
+    if (root->type == Node::Type::kRow) {
+        return nullptr;
+    }
+    return std::unique_ptr<BatchEvaluator>(new BatchEvaluator(std::move(root)));
+}
+
+BatchEvaluator::BatchEvaluator(std::unique_ptr<Node> root) : root_(std::move(root)) {}
+
+BatchEvaluator::~BatchEvaluator() {}
+
+void BatchEvaluator::eval(SequentialIter* iter,
+                          size_t begin,
+                          size_t size,
+                          QueryExpressionContext& ctx,
+                          std::vector<Value>* result) {
+    DCHECK_LE(begin + size, iter->size());
+    Batch batch;
+    batch.iter = iter;
+    batch.begin = begin;
+    batch.size = size;
+    batch.ctx = &ctx;
+    batch.rows.reserve(size);
+    auto rows = iter->begin() + begin;
+    for (size_t i = 0; i < size; ++i) {
+        batch.rows.emplace_back(&*(rows + i));
+    }
+    evalNode(root_.get(), batch);
+    result->reserve(result->size() + size);
+    root_->output.moveTo(size, result);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CONTEXT_BATCHEVALUATOR_H_
+#define CONTEXT_BATCHEVALUATOR_H_
+
+#include "common/base/Base.h"
+#include "common/expression/Expression.h"
+#include "context/Iterator.h"
+#include "context/QueryExpressionContext.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * BatchEvaluator evaluates an expression over a batch of rows of a sequential iterator
+ * column by column instead of row by row.
+ *
+ * The input properties, i.e. `$-.prop' and `$var.prop', are bound to the column indices
+ * when building, the comparisons, the arithmetics and the logical AND/OR/NOT are computed
+ * by the kernels specialized for the bool, int, float and string values. Any other kind
+ * of expression, and the values the kernels don't handle, e.g. NULL, fall back to the
+ * row-at-a-time evaluation of the original expression.
+ */
+class BatchEvaluator final {
+public:
+    // A column of values, either referring to the input rows or owned
+    class Vector;
+
+    // Return nullptr if no part of `expr' could be evaluated in batch
+    static std::unique_ptr<BatchEvaluator> make(Expression* expr, const SequentialIter* iter);
+
+    ~BatchEvaluator();
+
+    // Evaluate the rows in [begin, begin + size) of `iter' and save the results into `result',
+    // the position of `iter' is unspecified after evaluating.
+    void eval(SequentialIter* iter,
+              size_t begin,
+              size_t size,
+              QueryExpressionContext& ctx,
+              std::vector<Value>* result);
+
+    struct Node;
+
+private:
+    explicit BatchEvaluator(std::unique_ptr<Node> root);
+
+    std::unique_ptr<Node>           root_;
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // CONTEXT_BATCHEVALUATOR_H_
@@ -0,0 +1,419 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "context/CompiledExpression.h"
+
+#include <regex>
+
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/UnaryExpression.h"
+#include "context/EvalKernels.h"
+#include "service/GraphFlags.h"
+#include "util/ExpressionUtils.h"
+
+namespace nebula {
+namespace graph {
+
+namespace {
+
+using kernels::arithmetic;
+using kernels::compare;
+using kernels::isNumeric;
+using kernels::toDouble;
+
+const Value kTrue(true);
+const Value kFalse(false);
+
+inline const Value& boolValue(bool value) {
+    return value ? kTrue : kFalse;
+}
+
+// The result of the string operators on the values not both strings: NULL if either is NULL,
+// or BAD_TYPE if either is neither a string nor NULL
+inline const Value& nullOfStrings(const Value& lhs, const Value& rhs) {
+    if (lhs.isBadNull() || rhs.isBadNull() || (!lhs.isNull() && !lhs.isStr()) ||
+        (!rhs.isNull() && !rhs.isStr())) {
+        return Value::kNullBadType;
+    }
+    return Value::kNullValue;
+}
+
+}   // namespace
+
+// static
+std::unique_ptr<CompiledExpression> CompiledExpression::compile(ObjectPool* pool,
+                                                                const Expression* expr) {
+    DCHECK(expr != nullptr);
+    if (!FLAGS_enable_expr_compile) {
+        std::unique_ptr<CompiledExpression> program(new CompiledExpression(expr->clone()));
+        program->root_ = fallback(program->expr_);
+        return program;
+    }
+    // The error of folding, e.g. divided by zero, is left to the evaluation
+    auto folded = ExpressionUtils::foldConstantExpr(pool, expr);
+    std::unique_ptr<CompiledExpression> program(
+        new CompiledExpression(folded.ok() ? folded.value() : expr->clone()));
+    program->root_ = program->build(program->expr_);
+    return program;
+}
+
+// static
+std::vector<std::unique_ptr<CompiledExpression>> CompiledExpression::compile(
+    ObjectPool* pool,
+    const std::vector<Expression*>& exprs) {
+    std::vector<std::unique_ptr<CompiledExpression>> programs;
+    programs.reserve(exprs.size());
+    for (auto* expr : exprs) {
+        programs.emplace_back(compile(pool, expr));
+    }
+    return programs;
+}
+
+CompiledExpression::Step CompiledExpression::build(Expression* expr) {
+    switch (expr->kind()) {
+        case Expression::Kind::kConstant: {
+            auto* value = &static_cast<ConstantExpression*>(expr)->value();
+            return [value](QueryExpressionContext&) -> const Value& { return *value; };
+        }
+        case Expression::Kind::kInputProperty:
+        case Expression::Kind::kVarProperty:
+        case Expression::Kind::kTagProperty:
+        case Expression::Kind::kSrcProperty:
+        case Expression::Kind::kDstProperty:
+        case Expression::Kind::kEdgeProperty:
+            return buildProperty(expr);
+        case Expression::Kind::kUnaryNot:
+            return buildNot(expr);
+        case Expression::Kind::kAdd:
+        case Expression::Kind::kMinus:
+        case Expression::Kind::kMultiply:
+        case Expression::Kind::kDivision:
+        case Expression::Kind::kMod:
+            return buildArithmetic(expr);
+        case Expression::Kind::kRelEQ:
+        case Expression::Kind::kRelNE:
+        case Expression::Kind::kRelLT:
+        case Expression::Kind::kRelLE:
+        case Expression::Kind::kRelGT:
+        case Expression::Kind::kRelGE:
+            return buildRelational(expr);
+        case Expression::Kind::kRelIn:
+        case Expression::Kind::kRelNotIn:
+            return buildIn(expr);
+        case Expression::Kind::kRelREG:
+            return buildRegex(expr);
+        case Expression::Kind::kContains:
+        case Expression::Kind::kNotContains:
+        case Expression::Kind::kStartsWith:
+        case Expression::Kind::kNotStartsWith:
+        case Expression::Kind::kEndsWith:
+        case Expression::Kind::kNotEndsWith:
+            return buildStringPredicate(expr);
+        case Expression::Kind::kLogicalAnd:
+        case Expression::Kind::kLogicalOr:
+            return buildLogical(expr);
+        default:
+            return fallback(expr);
+    }
+}
+
+CompiledExpression::Step CompiledExpression::buildProperty(Expression* expr) {
+    auto kind = expr->kind();
+    auto* property = static_cast<PropertyExpression*>(expr);
+    // The variable of $var.prop is the input of plan node, read as $-.prop
+    auto* sym = &property->sym();
+    auto* prop = &property->prop();
+    auto* slot = &slots_.emplace_back();
+    return [kind, sym, prop, slot, expr](QueryExpressionContext& ctx) -> const Value& {
+        auto* iter = ctx.iter();
+        if (iter == nullptr) {
+            return expr->eval(ctx);
+        }
+        if (slot->iterId != iter->id() || slot->layout != iter->layout()) {
+            slot->iterId = iter->id();
+            slot->layout = iter->layout();
+            switch (kind) {
+                case Expression::Kind::kInputProperty:
+                case Expression::Kind::kVarProperty:
+                    slot->index = iter->columnSlot(*prop);
+                    break;
+                case Expression::Kind::kEdgeProperty:
+                    slot->index = iter->edgePropSlot(*sym, *prop);
+                    break;
+                default:
+                    slot->index = iter->tagPropSlot(*sym, *prop);
+                    break;
+            }
+        }
+        // The names not resolved are looked up by the iterator for the same sentinels
+        switch (kind) {
+            case Expression::Kind::kInputProperty:
+            case Expression::Kind::kVarProperty:
+                return slot->index == Iterator::kNoSlot ? iter->getColumn(*prop)
+                                                        : iter->getColumnBySlot(slot->index);
+            case Expression::Kind::kEdgeProperty:
+                return slot->index == Iterator::kNoSlot ? iter->getEdgeProp(*sym, *prop)
+                                                        : iter->getEdgePropBySlot(slot->index);
+            default:
+                return slot->index == Iterator::kNoSlot ? iter->getTagProp(*sym, *prop)
+                                                        : iter->getTagPropBySlot(slot->index);
+        }
+    };
+}
+
+// static
+CompiledExpression::Step CompiledExpression::fallback(Expression* expr) {
+    return [expr](QueryExpressionContext& ctx) -> const Value& { return expr->eval(ctx); };
+}
+
+CompiledExpression::Step CompiledExpression::buildRelational(Expression* expr) {
+    auto* binary = static_cast<BinaryExpression*>(expr);
+    auto kind = expr->kind();
+    bool isEquality = kind == Expression::Kind::kRelEQ || kind == Expression::Kind::kRelNE;
+    bool isStrict = kind == Expression::Kind::kRelLT || kind == Expression::Kind::kRelGT;
+    auto* result = newRegister();
+    return [kind, isEquality, isStrict, result, lhs = build(binary->left()),
+            rhs = build(binary->right())](QueryExpressionContext& ctx) -> const Value& {
+        auto& l = lhs(ctx);
+        auto& r = rhs(ctx);
+        if (l.isInt() && r.isInt()) {
+            return boolValue(compare(kind, l.getInt(), r.getInt()));
+        }
+        if (l.isStr() && r.isStr()) {
+            return boolValue(compare(kind, l.getStr(), r.getStr()));
+        }
+        // Equality of floats is checked with epsilon, leave it to the expression
+        if (l.isFloat() && r.isFloat() && isStrict) {
+            return boolValue(compare(kind, l.getFloat(), r.getFloat()));
+        }
+        if (l.isBool() && r.isBool() && isEquality) {
+            return boolValue(compare(kind, l.getBool(), r.getBool()));
+        }
+        // The same as RelationalExpression
+        switch (kind) {
+            case Expression::Kind::kRelEQ:
+                *result = l.equal(r);
+                break;
+            case Expression::Kind::kRelNE:
+                *result = !l.equal(r);
+                break;
+            case Expression::Kind::kRelLT:
+                *result = l.lessThan(r);
+                break;
+            case Expression::Kind::kRelLE:
+                *result = l.lessThan(r) || l.equal(r);
+                break;
+            case Expression::Kind::kRelGT:
+                *result = !(l.lessThan(r) || l.equal(r));
+                break;
+            default:
+                *result = !l.lessThan(r);
+                break;
+        }
+        return *result;
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildArithmetic(Expression* expr) {
+    auto* binary = static_cast<BinaryExpression*>(expr);
+    auto kind = expr->kind();
+    auto* result = newRegister();
+    return [kind, result, lhs = build(binary->left()), rhs = build(binary->right())](
+               QueryExpressionContext& ctx) -> const Value& {
+        auto& l = lhs(ctx);
+        auto& r = rhs(ctx);
+        if (l.isInt() && r.isInt()) {
+            int64_t value = 0;
+            if (arithmetic(kind, l.getInt(), r.getInt(), &value)) {
+                *result = Value(value);
+                return *result;
+            }
+        } else if (isNumeric(l) && isNumeric(r)) {
+            double value = 0.0;
+            if (arithmetic(kind, toDouble(l), toDouble(r), &value)) {
+                *result = Value(value);
+                return *result;
+            }
+        }
+        // The same as ArithmeticExpression, e.g. NULL for overflow or divided by zero
+        switch (kind) {
+            case Expression::Kind::kAdd:
+                *result = l + r;
+                break;
+            case Expression::Kind::kMinus:
+                *result = l - r;
+                break;
+            case Expression::Kind::kMultiply:
+                *result = l * r;
+                break;
+            case Expression::Kind::kDivision:
+                *result = l / r;
+                break;
+            default:
+                *result = l % r;
+                break;
+        }
+        return *result;
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildLogical(Expression* expr) {
+    std::vector<Step> operands;
+    for (auto* operand : static_cast<LogicalExpression*>(expr)->operands()) {
+        operands.emplace_back(build(operand));
+    }
+    bool isAnd = expr->kind() == Expression::Kind::kLogicalAnd;
+    return [isAnd, operands = std::move(operands)](QueryExpressionContext& ctx) -> const Value& {
+        bool hasNull = false;
+        for (auto& operand : operands) {
+            auto& value = operand(ctx);
+            if (value.isBool()) {
+                // Jump out once the result is decided: false for AND, true for OR
+                if (value.getBool() != isAnd) {
+                    return boolValue(!isAnd);
+                }
+            } else if (value.isNull() && !value.isBadNull()) {
+                // Three-valued logic, NULL unless decided by the others
+                hasNull = true;
+            } else {
+                return Value::kNullBadType;
+            }
+        }
+        return hasNull ? Value::kNullValue : boolValue(isAnd);
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildNot(Expression* expr) {
+    auto operand = build(static_cast<UnaryExpression*>(expr)->operand());
+    auto* result = newRegister();
+    return [result, operand = std::move(operand)](QueryExpressionContext& ctx) -> const Value& {
+        auto& value = operand(ctx);
+        if (value.isBool()) {
+            return boolValue(!value.getBool());
+        }
+        *result = !value;
+        return *result;
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildIn(Expression* expr) {
+    auto* binary = static_cast<BinaryExpression*>(expr);
+    if (binary->right()->kind() != Expression::Kind::kConstant) {
+        return fallback(expr);
+    }
+    auto& collection = static_cast<ConstantExpression*>(binary->right())->value();
+    if (!collection.isList() && !collection.isSet()) {
+        return fallback(expr);
+    }
+    auto members = std::make_shared<std::unordered_set<Value>>();
+    bool hasNull = false;
+    bool hasFloat = false;
+    auto add = [&](const Value& member) {
+        if (member.isNull()) {
+            hasNull = true;
+            return;
+        }
+        hasFloat = hasFloat || member.isFloat();
+        members->emplace(member);
+    };
+    if (collection.isList()) {
+        members->reserve(collection.getList().size());
+        for (auto& member : collection.getList().values) {
+            add(member);
+        }
+    } else {
+        members->reserve(collection.getSet().size());
+        for (auto& member : collection.getSet().values) {
+            add(member);
+        }
+    }
+    bool negated = expr->kind() == Expression::Kind::kRelNotIn;
+    auto* values = &collection;
+    return [values, negated, hasNull, hasFloat, members, lhs = build(binary->left())](
+               QueryExpressionContext& ctx) -> const Value& {
+        auto& value = lhs(ctx);
+        // An int equals to the float of the same number but is hashed differently, and a
+        // missing value is NULL rather than false if the collection contains NULL
+        if (value.isStr() || value.isBool() || (value.isInt() && !hasFloat)) {
+            bool found = members->find(value) != members->end();
+            if (found || !hasNull) {
+                return boolValue(found != negated);
+            }
+        }
+        // The same as RelationalExpression, compared one by one
+        bool found = values->isList() ? values->getList().contains(value)
+                                      : values->getSet().values.count(value) != 0;
+        if (!found && hasNull) {
+            return Value::kNullValue;
+        }
+        return boolValue(found != negated);
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildRegex(Expression* expr) {
+    auto* binary = static_cast<BinaryExpression*>(expr);
+    if (binary->right()->kind() != Expression::Kind::kConstant) {
+        return fallback(expr);
+    }
+    auto& pattern = static_cast<ConstantExpression*>(binary->right())->value();
+    if (!pattern.isStr()) {
+        return fallback(expr);
+    }
+    std::shared_ptr<const std::regex> regex;
+    try {
+        regex = std::make_shared<const std::regex>(pattern.getStr());
+    } catch (const std::regex_error&) {
+        // Report the invalid pattern the same way as the expression does
+        return fallback(expr);
+    }
+    auto* patternValue = &pattern;
+    return [regex, patternValue, lhs = build(binary->left())](
+               QueryExpressionContext& ctx) -> const Value& {
+        auto& value = lhs(ctx);
+        if (value.isStr()) {
+            return boolValue(std::regex_match(value.getStr(), *regex));
+        }
+        return nullOfStrings(value, *patternValue);
+    };
+}
+
+CompiledExpression::Step CompiledExpression::buildStringPredicate(Expression* expr) {
+    auto* binary = static_cast<BinaryExpression*>(expr);
+    auto kind = expr->kind();
+    bool negated = kind == Expression::Kind::kNotContains ||
+                   kind == Expression::Kind::kNotStartsWith ||
+                   kind == Expression::Kind::kNotEndsWith;
+    return [kind, negated, lhs = build(binary->left()), rhs = build(binary->right())](
+               QueryExpressionContext& ctx) -> const Value& {
+        auto& l = lhs(ctx);
+        auto& r = rhs(ctx);
+        if (!l.isStr() || !r.isStr()) {
+            return nullOfStrings(l, r);
+        }
+        folly::StringPiece str(l.getStr());
+        folly::StringPiece sub(r.getStr());
+        bool matched = false;
+        switch (kind) {
+            case Expression::Kind::kContains:
+            case Expression::Kind::kNotContains:
+                matched = str.find(sub) != folly::StringPiece::npos;
+                break;
+            case Expression::Kind::kStartsWith:
+            case Expression::Kind::kNotStartsWith:
+                matched = str.startsWith(sub);
+                break;
+            default:
+                matched = str.endsWith(sub);
+                break;
+        }
+        return boolValue(matched != negated);
+    };
+}
+
+}   // namespace graph
+}   // namespace nebula
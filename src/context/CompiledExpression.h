@@ -0,0 +1,105 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CONTEXT_COMPILEDEXPRESSION_H_
+#define CONTEXT_COMPILEDEXPRESSION_H_
+
+#include "common/base/Base.h"
+#include "common/base/ObjectPool.h"
+#include "common/expression/Expression.h"
+#include "context/QueryExpressionContext.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * CompiledExpression evaluates an expression row by row through a chain of closures bound
+ * once when compiling, instead of walking the tree with the virtual `eval' of each node.
+ *
+ * The constant sub-trees are folded in advance, AND/OR return as soon as the result is
+ * decided, the input properties are read by reference, and the comparisons, arithmetics and
+ * NOT take the fast paths for the bool, int, float and string values. The constant list of
+ * IN/NOT IN is turned into a hash set and the constant pattern of =~ is compiled into a regex,
+ * both once per program instead of once per row. The properties, e.g. $-.prop, tag.prop and
+ * edge.prop, are bound to the slots of the iterator evaluated on, which are resolved by names
+ * once and again only when the iterator or its layout changes, so the rows are read by index.
+ * The values the fast paths don't handle, e.g. NULL, take the same operations as the
+ * expression on the values of operands already evaluated, and any other kind of expression
+ * is evaluated by itself, so the results are always the same as `Expression::eval'.
+ *
+ * A program owns a copy of the expression and the registers keeping the intermediate
+ * results, so it's not shared between threads; each worker compiles its own.
+ */
+class CompiledExpression final {
+public:
+    // Never return nullptr, the expression is just copied if compiling is disabled
+    static std::unique_ptr<CompiledExpression> compile(ObjectPool* pool, const Expression* expr);
+
+    static std::vector<std::unique_ptr<CompiledExpression>> compile(
+        ObjectPool* pool,
+        const std::vector<Expression*>& exprs);
+
+    CompiledExpression(const CompiledExpression&) = delete;
+    CompiledExpression& operator=(const CompiledExpression&) = delete;
+
+    // The result is valid until the next evaluation
+    const Value& eval(QueryExpressionContext& ctx) {
+        return root_(ctx);
+    }
+
+    // The copy of expression evaluated by the program, constants folded
+    Expression* expr() const {
+        return expr_;
+    }
+
+private:
+    using Step = std::function<const Value&(QueryExpressionContext&)>;
+
+    explicit CompiledExpression(Expression* expr) : expr_(expr) {}
+
+    Step build(Expression* expr);
+
+    Step buildProperty(Expression* expr);
+
+    Step buildRelational(Expression* expr);
+
+    Step buildArithmetic(Expression* expr);
+
+    Step buildLogical(Expression* expr);
+
+    Step buildNot(Expression* expr);
+
+    Step buildIn(Expression* expr);
+
+    Step buildRegex(Expression* expr);
+
+    Step buildStringPredicate(Expression* expr);
+
+    // Evaluate by the expression itself, for the kinds not compiled
+    static Step fallback(Expression* expr);
+
+    // The registers never move once allocated, so the steps refer to them directly
+    Value* newRegister() {
+        return &registers_.emplace_back();
+    }
+
+    // The slot of a property bound to the iterator `iterId' in `layout'
+    struct Slot {
+        uint64_t            iterId{0};
+        int64_t             layout{0};
+        int64_t             index{Iterator::kNoSlot};
+    };
+
+    Expression*             expr_{nullptr};
+    Step                    root_;
+    std::deque<Value>       registers_;
+    std::deque<Slot>        slots_;
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // CONTEXT_COMPILEDEXPRESSION_H_
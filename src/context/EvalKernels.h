@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CONTEXT_EVALKERNELS_H_
+#define CONTEXT_EVALKERNELS_H_
+
+#include "common/base/Base.h"
+#include "common/datatypes/Value.h"
+#include "common/expression/Expression.h"
+
+namespace nebula {
+namespace graph {
+
+// The typed operations shared by BatchEvaluator and CompiledExpression
+namespace kernels {
+
+template <typename T>
+inline bool compare(Expression::Kind kind, const T& lhs, const T& rhs) {
+    switch (kind) {
+        case Expression::Kind::kRelEQ:
+            return lhs == rhs;
+        case Expression::Kind::kRelNE:
+            return lhs != rhs;
+        case Expression::Kind::kRelLT:
+            return lhs < rhs;
+        case Expression::Kind::kRelLE:
+            return lhs <= rhs;
+        case Expression::Kind::kRelGT:
+            return lhs > rhs;
+        case Expression::Kind::kRelGE:
+            return lhs >= rhs;
+        default:
+            LOG(FATAL) << "Unexpected kind: " << static_cast<int>(kind);
+    }
+    return false;
+}
+
+// Return false if overflow or divided by zero
+inline bool arithmetic(Expression::Kind kind, int64_t lhs, int64_t rhs, int64_t* result) {
+    switch (kind) {
+        case Expression::Kind::kAdd:
+            return !__builtin_add_overflow(lhs, rhs, result);
+        case Expression::Kind::kMinus:
+            return !__builtin_sub_overflow(lhs, rhs, result);
+        case Expression::Kind::kMultiply:
+            return !__builtin_mul_overflow(lhs, rhs, result);
+        case Expression::Kind::kDivision:
+        case Expression::Kind::kMod:
+            if (rhs == 0 || (lhs == std::numeric_limits<int64_t>::min() && rhs == -1)) {
+                return false;
+            }
+            *result = kind == Expression::Kind::kDivision ? lhs / rhs : lhs % rhs;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Return false if the operation is not handled for floats
+inline bool arithmetic(Expression::Kind kind, double lhs, double rhs, double* result) {
+    switch (kind) {
+        case Expression::Kind::kAdd:
+            *result = lhs + rhs;
+            return true;
+        case Expression::Kind::kMinus:
+            *result = lhs - rhs;
+            return true;
+        case Expression::Kind::kMultiply:
+            *result = lhs * rhs;
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline bool isNumeric(const Value& value) {
+    return value.isInt() || value.isFloat();
+}
+
+inline double toDouble(const Value& value) {
+    return value.isInt() ? static_cast<double>(value.getInt()) : value.getFloat();
+}
+
+}   // namespace kernels
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // CONTEXT_EVALKERNELS_H_
@@ -18,13 +18,58 @@ void ExecutionContext::setValue(const std::string& name, Value&& val) {
     setResult(name, builder.finish());
 }
 
-void ExecutionContext::setResult(const std::string& name, Result&& result) {
+ExecutionContext::~ExecutionContext() {
+    for (auto& footprint : footprints_) {
+        footprint.second.tracker->release(footprint.second.bytes);
+    }
+}
+
+Status ExecutionContext::setResult(const std::string& name,
+                                   Result&& result,
+                                   std::shared_ptr<MemoryTracker> tracker) {
+    auto status = account(result, tracker != nullptr ? std::move(tracker) : memTracker_);
     auto& hist = valueMap_[name];
     hist.emplace_back(std::move(result));
+    return status;
 }
 
 void ExecutionContext::dropResult(const std::string& name) {
-    valueMap_[name].clear();
+    auto& hist = valueMap_[name];
+    for (auto& result : hist) {
+        unaccount(result);
+    }
+    hist.clear();
+}
+
+Status ExecutionContext::account(const Result& result, std::shared_ptr<MemoryTracker> tracker) {
+    auto* value = result.valuePtr().get();
+    if (tracker == nullptr || value == nullptr) {
+        return Status::OK();
+    }
+    std::lock_guard<std::mutex> guard(footprintsLock_);
+    auto& footprint = footprints_[value];
+    if (footprint.refs++ > 0) {
+        // The value is accounted by the result sharing it
+        return Status::OK();
+    }
+    footprint.bytes = MemoryTracker::estimate(*value);
+    footprint.tracker = std::move(tracker);
+    footprint.tracker->consume(footprint.bytes);
+    return footprint.tracker->checkLimit();
+}
+
+void ExecutionContext::unaccount(const Result& result) {
+    auto* value = result.valuePtr().get();
+    if (value == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(footprintsLock_);
+    auto found = footprints_.find(value);
+    if (found == footprints_.end() || --found->second.refs > 0) {
+        return;
+    }
+    found->second.tracker->release(found->second.bytes);
+    footprints_.erase(found);
 }
 
 size_t ExecutionContext::numVersions(const std::string& name) const {
@@ -41,6 +86,10 @@ void ExecutionContext::truncHistory(const std::string& name, size_t numVersionsT
             return;
         }
         // Only keep the latest N values
+        for (auto iter = it->second.begin(); iter != it->second.end() - numVersionsToKeep;
+             ++iter) {
+            unaccount(*iter);
+        }
         it->second.erase(it->second.begin(), it->second.end() - numVersionsToKeep);
     }
 }
@@ -87,5 +136,19 @@ const std::vector<Result>& ExecutionContext::getHistory(const std::string& name)
     }
 }
 
+void ExecutionContext::deepCopyTo(ExecutionContext* other) const {
+    DCHECK(other != nullptr);
+    for (auto& var : valueMap_) {
+        if (var.second.empty()) {
+            other->initVar(var.first);
+            continue;
+        }
+        auto& result = var.second.back();
+        auto kind = result.core_.iter->kind();
+        other->setResult(var.first,
+                         ResultBuilder().value(Value(result.value())).iter(kind).finish());
+    }
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -9,6 +9,7 @@
 
 #include "common/datatypes/Value.h"
 #include "context/Result.h"
+#include "util/MemoryTracker.h"
 
 namespace nebula {
 namespace graph {
@@ -39,7 +40,12 @@ public:
 
     ExecutionContext() = default;
 
-    virtual ~ExecutionContext() = default;
+    virtual ~ExecutionContext();
+
+    // Account the memory of results set later by `tracker'
+    void setMemoryTracker(std::shared_ptr<MemoryTracker> tracker) {
+        memTracker_ = std::move(tracker);
+    }
 
     void initVar(const std::string& name) {
         valueMap_[name];
@@ -60,7 +66,11 @@ public:
 
     void setValue(const std::string& name, Value&& val);
 
-    void setResult(const std::string& name, Result&& result);
+    // The memory of result is accounted by `tracker', or by the tracker of context if null.
+    // The result is set anyway, and error is returned if the memory exceeds the quota.
+    Status setResult(const std::string& name,
+                   Result&& result,
+                   std::shared_ptr<MemoryTracker> tracker = nullptr);
 
     void dropResult(const std::string& name);
 
@@ -71,12 +81,31 @@ public:
         return valueMap_.find(name) != valueMap_.end();
     }
 
+    // Deep copy the latest version of all variables into `other'
+    void deepCopyTo(ExecutionContext* other) const;
+
 private:
     friend class QueryInstance;
     Value moveValue(const std::string& name);
 
+    // The memory held by a value which may be shared by several results
+    struct Footprint {
+        size_t                              refs{0};
+        int64_t                             bytes{0};
+        std::shared_ptr<MemoryTracker>      tracker;
+    };
+
+    Status account(const Result& result, std::shared_ptr<MemoryTracker> tracker);
+
+    void unaccount(const Result& result);
+
     // name -> Value with multiple versions
     std::unordered_map<std::string, std::vector<Result>>     valueMap_;
+
+    std::shared_ptr<MemoryTracker>                           memTracker_;
+    // Results are set by executors running in parallel
+    std::mutex                                               footprintsLock_;
+    std::unordered_map<const Value*, Footprint>              footprints_;
 };
 
 }  // namespace graph
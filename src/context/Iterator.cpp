@@ -12,9 +12,16 @@
 #include "util/SchemaUtil.h"
 namespace nebula {
 namespace graph {
+// static
+uint64_t Iterator::nextId() {
+    static std::atomic<uint64_t> id{0};
+    return ++id;
+}
+
 GetNeighborsIter::GetNeighborsIter(std::shared_ptr<Value> value)
     : Iterator(value, Kind::kGetNeighbors) {
     if (value == nullptr) {
+        clear();
         return;
     }
     auto status = processList(value);
@@ -29,7 +36,7 @@ GetNeighborsIter::GetNeighborsIter(std::shared_ptr<Value> value)
 
 void GetNeighborsIter::goToFirstEdge() {
     // Go to first edge
-    for (currentDs_ = dsIndices_.begin(); currentDs_ < dsIndices_.end(); ++currentDs_) {
+    for (currentDs_ = dsIndices_->begin(); currentDs_ < dsIndices_->end(); ++currentDs_) {
         if (noEdge_) {
             currentRow_ = currentDs_->ds->rows.begin();
             valid_ = true;
@@ -87,14 +94,16 @@ Status GetNeighborsIter::processList(std::shared_ptr<Value> value) {
         ss << "Value type is not list, type: " << value->type();
         return Status::Error(ss.str());
     }
+    auto dsIndices = std::make_shared<std::vector<DataSetIndex>>();
     for (auto& val : value->getList().values) {
         if (UNLIKELY(!val.isDataSet())) {
             return Status::Error("There is a value in list which is not a data set.");
         }
         auto status = makeDataSetIndex(val.getDataSet());
         NG_RETURN_IF_ERROR(status);
-        dsIndices_.emplace_back(std::move(status).value());
+        dsIndices->emplace_back(std::move(status).value());
     }
+    dsIndices_ = std::move(dsIndices);
     return Status::OK();
 }
 
@@ -178,7 +187,7 @@ Status GetNeighborsIter::buildPropIndex(const std::string& props,
 
 bool GetNeighborsIter::valid() const {
     return valid_
-            && currentDs_ < dsIndices_.end()
+            && currentDs_ < dsIndices_->end()
             && currentRow_ < rowsUpperBound_
             && colIdx_ < currentDs_->colUpperBound;
 }
@@ -194,7 +203,7 @@ void GetNeighborsIter::next() {
         }
 
         // go to next dataset
-        if (++currentDs_ < dsIndices_.end()) {
+        if (++currentDs_ < dsIndices_->end()) {
             currentRow_ = currentDs_->ds->begin();
             rowsUpperBound_ = currentDs_->ds->end();
         }
@@ -241,7 +250,7 @@ void GetNeighborsIter::next() {
             }
 
             // go to next dataset
-            if (++currentDs_ < dsIndices_.end()) {
+            if (++currentDs_ < dsIndices_->end()) {
                 colIdx_ = currentDs_->colLowerBound;
                 currentRow_ = currentDs_->ds->begin();
                 rowsUpperBound_ = currentDs_->ds->end();
@@ -249,7 +258,7 @@ void GetNeighborsIter::next() {
             }
             break;
         }
-        if (currentDs_ == dsIndices_.end()) {
+        if (currentDs_ == dsIndices_->end()) {
             break;
         }
     }
@@ -331,6 +340,81 @@ const Value& GetNeighborsIter::getEdgeProp(const std::string& edge,
     return currentEdge_->values[propIndex->second];
 }
 
+int64_t GetNeighborsIter::columnSlot(const std::string& col) const {
+    if (!valid()) {
+        return kNoSlot;
+    }
+    auto found = currentDs_->colIndices.find(col);
+    if (found == currentDs_->colIndices.end()) {
+        return kNoSlot;
+    }
+    return static_cast<int64_t>(found->second);
+}
+
+// The slot of tag prop is made up of the column index and the index in the props list
+int64_t GetNeighborsIter::tagPropSlot(const std::string& tag, const std::string& prop) const {
+    if (!valid()) {
+        return kNoSlot;
+    }
+    auto index = currentDs_->tagPropsMap.find(tag);
+    if (index == currentDs_->tagPropsMap.end()) {
+        return kNoSlot;
+    }
+    auto propIndex = index->second.propIndices.find(prop);
+    if (propIndex == index->second.propIndices.end()) {
+        return kNoSlot;
+    }
+    return static_cast<int64_t>(index->second.colIdx) << 32 |
+           static_cast<int64_t>(propIndex->second);
+}
+
+int64_t GetNeighborsIter::edgePropSlot(const std::string& edge, const std::string& prop) const {
+    if (!valid()) {
+        return kNoSlot;
+    }
+    auto& currentEdge = currentEdgeName();
+    if (edge != "*" && (currentEdge.compare(1, std::string::npos, edge) != 0)) {
+        return kNoSlot;
+    }
+    auto index = currentDs_->edgePropsMap.find(currentEdge);
+    if (index == currentDs_->edgePropsMap.end()) {
+        return kNoSlot;
+    }
+    auto propIndex = index->second.propIndices.find(prop);
+    if (propIndex == index->second.propIndices.end()) {
+        return kNoSlot;
+    }
+    return static_cast<int64_t>(propIndex->second);
+}
+
+const Value& GetNeighborsIter::getColumnBySlot(int64_t slot) const {
+    if (!valid()) {
+        return Value::kNullValue;
+    }
+    DCHECK_LT(static_cast<size_t>(slot), currentRow_->values.size());
+    return currentRow_->values[slot];
+}
+
+const Value& GetNeighborsIter::getTagPropBySlot(int64_t slot) const {
+    if (!valid()) {
+        return Value::kNullValue;
+    }
+    auto colId = static_cast<size_t>(slot >> 32);
+    auto& row = *currentRow_;
+    DCHECK_GT(row.size(), colId);
+    if (!row[colId].isList()) {
+        return Value::kNullBadType;
+    }
+    return row[colId].getList().values[slot & 0xFFFFFFFF];
+}
+
+const Value& GetNeighborsIter::getEdgePropBySlot(int64_t slot) const {
+    if (!valid()) {
+        return Value::kNullValue;
+    }
+    return currentEdge_->values[slot];
+}
+
 Value GetNeighborsIter::getVertex() const {
     if (!valid()) {
         return Value::kNullValue;
@@ -369,7 +453,7 @@ List GetNeighborsIter::getVertices() {
     vertices.values.reserve(size());
     valid_ = true;
     colIdx_ = -2;
-    for (currentDs_ = dsIndices_.begin(); currentDs_ < dsIndices_.end(); ++currentDs_) {
+    for (currentDs_ = dsIndices_->begin(); currentDs_ < dsIndices_->end(); ++currentDs_) {
         rowsUpperBound_ = currentDs_->ds->rows.end();
         for (currentRow_ = currentDs_->ds->rows.begin();
             currentRow_ < currentDs_->ds->rows.end(); ++currentRow_) {
@@ -452,9 +536,11 @@ SequentialIter::SequentialIter(std::shared_ptr<Value> value) : Iterator(value, K
     auto& ds = value->mutableDataSet();
     iter_ = ds.rows.begin();
     rows_ = &ds.rows;
+    auto colIndices = std::make_shared<std::unordered_map<std::string, size_t>>();
     for (size_t i = 0; i < ds.colNames.size(); ++i) {
-        colIndices_.emplace(ds.colNames[i], i);
+        colIndices->emplace(ds.colNames[i], i);
     }
+    colIndices_ = std::move(colIndices);
 }
 
 SequentialIter::SequentialIter(std::unique_ptr<Iterator> left, std::unique_ptr<Iterator> right)
@@ -474,7 +560,7 @@ void SequentialIter::init(std::vector<std::unique_ptr<Iterator>>&& iterators) {
     DCHECK(!iterators.empty());
     const auto& firstIter = iterators.front();
     DCHECK(firstIter->isSequentialIter());
-    colIndices_ = static_cast<const SequentialIter*>(firstIter.get())->getColIndices();
+    colIndices_ = static_cast<const SequentialIter*>(firstIter.get())->colIndices_;
     DataSet ds;
     for (auto& iter : iterators) {
         DCHECK(iter->isSequentialIter());
@@ -495,19 +581,59 @@ bool SequentialIter::valid() const {
 void SequentialIter::next() {
     if (valid()) {
         ++iter_;
+        auto& selection = *selection_;
+        while (selection.numErased > 0 && iter_ < rows_->end() &&
+               selection.erased.test(iter_ - rows_->begin())) {
+            ++iter_;
+        }
     }
 }
 
 void SequentialIter::erase() {
-    iter_ = rows_->erase(iter_);
+    DCHECK(valid());
+    auto& selection = *selection_;
+    if (selection.erased.size() != rows_->size()) {
+        selection.erased.resize(rows_->size());
+    }
+    selection.erased.set(iter_ - rows_->begin());
+    ++selection.numErased;
+    next();
 }
 
 void SequentialIter::unstableErase() {
-    std::swap(rows_->back(), *iter_);
-    rows_->pop_back();
+    erase();
+}
+
+void SequentialIter::compact() {
+    auto& selection = *selection_;
+    if (selection.numErased == 0) {
+        return;
+    }
+    auto& rows = *rows_;
+    size_t current = iter_ - rows.begin();
+    size_t newCurrent = rows.size() - selection.numErased;
+    size_t kept = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (i == current) {
+            newCurrent = kept;
+        }
+        if (selection.erased.test(i)) {
+            continue;
+        }
+        if (kept != i) {
+            rows[kept] = std::move(rows[i]);
+        }
+        ++kept;
+    }
+    rows.erase(rows.begin() + kept, rows.end());
+    selection.erased.clear();
+    selection.numErased = 0;
+    selection.live.clear();
+    iter_ = rows.begin() + newCurrent;
 }
 
 void SequentialIter::eraseRange(size_t first, size_t last) {
+    compact();
     if (first >= last || first >= size()) {
         return;
     }
@@ -521,7 +647,29 @@ void SequentialIter::eraseRange(size_t first, size_t last) {
 
 void SequentialIter::doReset(size_t pos) {
     DCHECK((pos == 0 && size() == 0) || (pos < size()));
-    iter_ = rows_->begin() + pos;
+    iter_ = rows_->begin();
+    if (selection_->numErased == 0) {
+        iter_ += pos;
+        return;
+    }
+    // Move to the pos-th row not erased
+    indexLiveRows();
+    auto& live = selection_->live;
+    iter_ = pos < live.size() ? iter_ + live[pos] : rows_->end();
+}
+
+void SequentialIter::indexLiveRows() const {
+    auto& selection = *selection_;
+    if (selection.numErased == 0 || selection.live.size() + selection.numErased == rows_->size()) {
+        return;
+    }
+    selection.live.clear();
+    selection.live.reserve(rows_->size() - selection.numErased);
+    for (size_t i = 0; i < rows_->size(); ++i) {
+        if (!selection.erased.test(i)) {
+            selection.live.emplace_back(i);
+        }
+    }
 }
 
 const Value& SequentialIter::getColumn(int32_t index) const {
@@ -541,26 +689,30 @@ PropIter::PropIter(std::shared_ptr<Value> value) : SequentialIter(value) {
 }
 
 Status PropIter::makeDataSetIndex(const DataSet& ds) {
-    dsIndex_.ds = &ds;
+    auto dsIndex = std::make_shared<DataSetIndex>();
+    dsIndex_ = dsIndex;
+    dsIndex->ds = &ds;
     auto& colNames = ds.colNames;
     for (size_t i = 0; i < colNames.size(); ++i) {
-        dsIndex_.colIndices.emplace(colNames[i], i);
+        dsIndex->colIndices.emplace(colNames[i], i);
         auto& colName = colNames[i];
         if (colName.find(".") != std::string::npos) {
-            NG_RETURN_IF_ERROR(buildPropIndex(colName, i));
+            NG_RETURN_IF_ERROR(buildPropIndex(colName, i, dsIndex.get()));
         }
     }
     return Status::OK();
 }
 
-Status PropIter::buildPropIndex(const std::string& props, size_t columnId) {
+Status PropIter::buildPropIndex(const std::string& props,
+                                size_t columnId,
+                                DataSetIndex* dsIndex) {
     std::vector<std::string> pieces;
     folly::split(".", props, pieces);
     if (UNLIKELY(pieces.size() != 2)) {
         return Status::Error("Bad column name format: %s", props.c_str());
     }
     std::string name = pieces[0];
-    auto& propsMap = dsIndex_.propsMap;
+    auto& propsMap = dsIndex->propsMap;
     if (propsMap.find(name) != propsMap.end()) {
         propsMap[name].emplace(pieces[1], columnId);
     } else {
@@ -576,8 +728,8 @@ const Value& PropIter::getColumn(const std::string& col) const {
         return Value::kNullValue;
     }
 
-    auto index = dsIndex_.colIndices.find(col);
-    if (index == dsIndex_.colIndices.end()) {
+    auto index = dsIndex_->colIndices.find(col);
+    if (index == dsIndex_->colIndices.end()) {
         return Value::kNullValue;
     }
     auto& row = *iter_;
@@ -585,11 +737,31 @@ const Value& PropIter::getColumn(const std::string& col) const {
     return row.values[index->second];
 }
 
+int64_t PropIter::columnSlot(const std::string& col) const {
+    auto index = dsIndex_->colIndices.find(col);
+    if (index == dsIndex_->colIndices.end()) {
+        return kNoSlot;
+    }
+    return static_cast<int64_t>(index->second);
+}
+
+int64_t PropIter::propSlot(const std::string& name, const std::string& prop) const {
+    auto index = dsIndex_->propsMap.find(name);
+    if (index == dsIndex_->propsMap.end()) {
+        return kNoSlot;
+    }
+    auto propIndex = index->second.find(prop);
+    if (propIndex == index->second.end()) {
+        return kNoSlot;
+    }
+    return static_cast<int64_t>(propIndex->second);
+}
+
 const Value& PropIter::getProp(const std::string& name, const std::string& prop) const {
     if (!valid()) {
         return Value::kNullValue;
     }
-    auto& propsMap = dsIndex_.propsMap;
+    auto& propsMap = dsIndex_->propsMap;
     auto index = propsMap.find(name);
     if (index == propsMap.end()) {
         return Value::kEmpty;
@@ -617,7 +789,7 @@ Value PropIter::getVertex() const {
     }
     Vertex vertex;
     vertex.vid = vidVal;
-    auto& tagPropsMap = dsIndex_.propsMap;
+    auto& tagPropsMap = dsIndex_->propsMap;
     bool isVertexProps = true;
     auto& row = *iter_;
     // tagPropsMap -> <std::string, std::unordered_map<std::string, size_t> >
@@ -653,7 +825,7 @@ Value PropIter::getEdge() const {
         return Value::kNullValue;
     }
     Edge edge;
-    auto& edgePropsMap = dsIndex_.propsMap;
+    auto& edgePropsMap = dsIndex_->propsMap;
     bool isEdgeProps = true;
     auto& row = *iter_;
     for (auto& edgeProp : edgePropsMap) {
@@ -42,8 +42,12 @@ public:
         kProp,
     };
 
+    // Returned when a column or property couldn't be bound to a slot, the caller
+    // should fall back to looking it up by names
+    static constexpr int64_t kNoSlot = -1;
+
     explicit Iterator(std::shared_ptr<Value> value, Kind kind)
-        : value_(value), kind_(kind) {}
+        : value_(value), kind_(kind), id_(nextId()) {}
 
     virtual ~Iterator() = default;
 
@@ -140,11 +144,52 @@ public:
         return Value();
     }
 
+    // The slots of columns and properties resolved by names, so the values of each row could
+    // be got without hashing the names. The copies of an iterator share the same `id()',
+    // and the slots bound for them stay valid as long as `layout()' is unchanged.
+    uint64_t id() const {
+        return id_;
+    }
+
+    virtual int64_t layout() const {
+        return 0;
+    }
+
+    virtual int64_t columnSlot(const std::string&) const {
+        return kNoSlot;
+    }
+
+    virtual int64_t tagPropSlot(const std::string&, const std::string&) const {
+        return kNoSlot;
+    }
+
+    virtual int64_t edgePropSlot(const std::string&, const std::string&) const {
+        return kNoSlot;
+    }
+
+    virtual const Value& getColumnBySlot(int64_t) const {
+        DLOG(FATAL) << "Shouldn't call the unimplemented method";
+        return Value::kEmpty;
+    }
+
+    virtual const Value& getTagPropBySlot(int64_t) const {
+        DLOG(FATAL) << "Shouldn't call the unimplemented method";
+        return Value::kEmpty;
+    }
+
+    virtual const Value& getEdgePropBySlot(int64_t) const {
+        DLOG(FATAL) << "Shouldn't call the unimplemented method";
+        return Value::kEmpty;
+    }
+
 protected:
     virtual void doReset(size_t pos) = 0;
 
+    static uint64_t nextId();
+
     std::shared_ptr<Value> value_;
     Kind                   kind_;
+    uint64_t               id_;
 };
 
 class DefaultIter final : public Iterator {
@@ -225,7 +270,7 @@ public:
 
     void clear() override {
         valid_ = false;
-        dsIndices_.clear();
+        dsIndices_ = std::make_shared<const std::vector<DataSetIndex>>();
     }
 
     void erase() override;
@@ -254,6 +299,26 @@ public:
     const Value& getEdgeProp(const std::string& edge,
                              const std::string& prop) const override;
 
+    // The columns of each dataset differ, and the edge props depend on the current edge
+    int64_t layout() const override {
+        if (!valid_) {
+            return 0;
+        }
+        return static_cast<int64_t>(currentDs_ - dsIndices_->begin() + 1) << 32 | (colIdx_ + 1);
+    }
+
+    int64_t columnSlot(const std::string& col) const override;
+
+    int64_t tagPropSlot(const std::string& tag, const std::string& prop) const override;
+
+    int64_t edgePropSlot(const std::string& edge, const std::string& prop) const override;
+
+    const Value& getColumnBySlot(int64_t slot) const override;
+
+    const Value& getTagPropBySlot(int64_t slot) const override;
+
+    const Value& getEdgePropBySlot(int64_t slot) const override;
+
     Value getVertex() const override;
 
     Value getEdge() const override;
@@ -323,9 +388,10 @@ private:
     FRIEND_TEST(IteratorTest, TestHead);
 
     bool                                 valid_{false};
-    std::vector<DataSetIndex>            dsIndices_;
+    // The indices are built once and shared read-only by the copies of iterator
+    std::shared_ptr<const std::vector<DataSetIndex>>    dsIndices_;
 
-    std::vector<DataSetIndex>::iterator  currentDs_;
+    std::vector<DataSetIndex>::const_iterator           currentDs_;
 
     std::vector<Row>::const_iterator     currentRow_;
     std::vector<Row>::const_iterator     rowsUpperBound_;
@@ -352,7 +418,11 @@ public:
     // Union two sequential iterators.
     SequentialIter(std::unique_ptr<Iterator> left, std::unique_ptr<Iterator> right);
 
+    // The copy shares the rows and the selection of them, so the rows erased by either one
+    // are skipped by both. The copies are usually read by positions in parallel, so the rank
+    // index of the selection is built here in advance.
     std::unique_ptr<Iterator> copy() const override {
+        indexLiveRows();
         auto copy = std::make_unique<SequentialIter>(*this);
         copy->reset();
         return copy;
@@ -362,31 +432,51 @@ public:
 
     void next() override;
 
+    // Mark the current row erased in O(1) and move to the next one, the erased rows are
+    // skipped by the iteration and removed all at once by compact()
     void erase() override;
 
+    // The same as erase(), which keeps the order of rows
     void unstableErase() override;
 
     void eraseRange(size_t first, size_t last) override;
 
     void clear() override {
         rows_->clear();
+        selection_->erased.clear();
+        selection_->numErased = 0;
+        selection_->live.clear();
         reset();
     }
 
+    // Remove the erased rows keeping the order of others, the current position is kept.
+    // It's done once the rows are materialized, i.e. accessed directly or kept in a result.
+    // The selection shared by the copies is cleared too, but their positions are not kept,
+    // so they have to be reset.
+    void compact();
+
     std::vector<Row>::iterator begin() {
+        compact();
         return rows_->begin();
     }
 
     std::vector<Row>::iterator end() {
+        compact();
         return rows_->end();
     }
 
     const std::unordered_map<std::string, size_t>& getColIndices() const {
-        return colIndices_;
+        return *colIndices_;
+    }
+
+    // Move out the current row, only if the rows are not read by others, e.g. when returning
+    // the results to client or passing the rows between the stages of a pipeline.
+    Row&& moveRow() {
+        return std::move(*iter_);
     }
 
     size_t size() const override {
-        return rows_->size();
+        return rows_->size() - selection_->numErased;
     }
 
     const Value& getColumn(const std::string& col) const override {
@@ -394,8 +484,8 @@ public:
             return Value::kNullValue;
         }
         auto& row = *iter_;
-        auto index = colIndices_.find(col);
-        if (index == colIndices_.end()) {
+        auto index = colIndices_->find(col);
+        if (index == colIndices_->end()) {
             return Value::kNullValue;
         }
 
@@ -405,26 +495,48 @@ public:
 
     const Value& getColumn(int32_t index) const override;
 
+    int64_t columnSlot(const std::string& col) const override {
+        auto index = colIndices_->find(col);
+        return index == colIndices_->end() ? kNoSlot : static_cast<int64_t>(index->second);
+    }
+
+    const Value& getColumnBySlot(int64_t slot) const override {
+        if (!valid()) {
+            return Value::kNullValue;
+        }
+        auto& row = *iter_;
+        DCHECK_LT(static_cast<size_t>(slot), row.values.size());
+        return row.values[slot];
+    }
+
 protected:
     const Row* row() const override {
         return &*iter_;
     }
 
-    // Notice: We only use this interface when return results to client.
-    friend class DataCollectExecutor;
-    Row&& moveRow() {
-        return std::move(*iter_);
-    }
-
     void doReset(size_t pos) override;
 
+    // The rows erased but not compacted yet, shared by the copies as the rows
+    struct Selection {
+        boost::dynamic_bitset<>     erased;
+        size_t                      numErased{0};
+        // The indices of the rows not erased, i.e. the rank index to reset to a position in
+        // O(1), which is built on demand and again once more rows are erased
+        std::vector<size_t>         live;
+    };
+
     std::vector<Row>::iterator                   iter_;
     std::vector<Row>*                            rows_{nullptr};
+    std::shared_ptr<Selection>                   selection_{std::make_shared<Selection>()};
 
 private:
     void init(std::vector<std::unique_ptr<Iterator>>&& iterators);
 
-    std::unordered_map<std::string, size_t>      colIndices_;
+    // Build the rank index of the rows not erased if it's stale
+    void indexLiveRows() const;
+
+    // Shared by the copies of iterator
+    std::shared_ptr<const std::unordered_map<std::string, size_t>>    colIndices_;
 };
 
 class PropIter final : public SequentialIter {
@@ -438,7 +550,7 @@ public:
     }
 
     const std::unordered_map<std::string, size_t>& getColIndices() const {
-        return dsIndex_.colIndices;
+        return dsIndex_->colIndices;
     }
 
     const Value& getColumn(const std::string& col) const override;
@@ -463,11 +575,26 @@ public:
         return getProp(edge, prop);
     }
 
-private:
-    Status makeDataSetIndex(const DataSet& ds);
+    int64_t columnSlot(const std::string& col) const override;
 
-    Status buildPropIndex(const std::string& props, size_t columnIdx);
+    int64_t tagPropSlot(const std::string& tag, const std::string& prop) const override {
+        return propSlot(tag, prop);
+    }
+
+    int64_t edgePropSlot(const std::string& edge, const std::string& prop) const override {
+        return propSlot(edge, prop);
+    }
 
+    // The props are columns of the dataset too
+    const Value& getTagPropBySlot(int64_t slot) const override {
+        return getColumnBySlot(slot);
+    }
+
+    const Value& getEdgePropBySlot(int64_t slot) const override {
+        return getColumnBySlot(slot);
+    }
+
+private:
     struct DataSetIndex {
         const DataSet* ds;
         // vertex | _vid | tag1.prop1 | tag1.prop2 | tag2,prop1 | tag2,prop2 | ...
@@ -480,8 +607,15 @@ private:
         std::unordered_map<std::string, std::unordered_map<std::string, size_t> > propsMap;
     };
 
+    Status makeDataSetIndex(const DataSet& ds);
+
+    Status buildPropIndex(const std::string& props, size_t columnIdx, DataSetIndex* dsIndex);
+
+    int64_t propSlot(const std::string& name, const std::string& prop) const;
+
 private:
-    DataSetIndex                                                   dsIndex_;
+    // Built once and shared read-only by the copies of iterator
+    std::shared_ptr<const DataSetIndex>                            dsIndex_;
 };
 
 
@@ -6,6 +6,8 @@
 
 #include "context/QueryContext.h"
 
+#include "service/GraphFlags.h"
+
 namespace nebula {
 namespace graph {
 
@@ -35,6 +37,17 @@ void QueryContext::init() {
     idGen_ = std::make_unique<IdGenerator>(0);
     symTable_ = std::make_unique<SymbolTable>(objPool_.get());
     vctx_ = std::make_unique<ValidateContext>(std::make_unique<AnonVarGenerator>(symTable_.get()));
+    initMemoryTracker();
+}
+
+void QueryContext::initMemoryTracker() {
+    auto parent = MemoryTracker::process();
+    if (rctx_ != nullptr && rctx_->session() != nullptr) {
+        parent = rctx_->session()->memoryTracker();
+    }
+    memTracker_ =
+        std::make_shared<MemoryTracker>(std::move(parent), FLAGS_query_memory_quota_bytes);
+    ectx_->setMemoryTracker(memTracker_);
 }
 
 }   // namespace graph
@@ -16,6 +16,8 @@
 #include "common/meta/IndexManager.h"
 #include "common/meta/SchemaManager.h"
 #include "context/ExecutionContext.h"
+#include "context/StorageCoalescer.h"
+#include "context/VertexCache.h"
 #include "context/Symbols.h"
 #include "context/ValidateContext.h"
 #include "parser/SequentialSentences.h"
@@ -54,6 +56,7 @@ public:
 
     void setRCtx(RequestContextPtr rctx) {
         rctx_ = std::move(rctx);
+        initMemoryTracker();
     }
 
     void setSchemaManager(meta::SchemaManager* sm) {
@@ -68,6 +71,18 @@ public:
         storageClient_ = storage;
     }
 
+    void setStorageCoalescer(StorageCoalescer* coalescer) {
+        storageCoalescer_ = coalescer;
+    }
+
+    void setVertexCache(VertexCache* cache) {
+        vertexCache_ = cache;
+    }
+
+    void setNeighborCache(VertexCache* cache) {
+        neighborCache_ = cache;
+    }
+
     void setMetaClient(meta::MetaClient* metaClient) {
         metaClient_ = metaClient;
     }
@@ -104,6 +119,21 @@ public:
         return storageClient_;
     }
 
+    // Null if the storage requests of queries are not coalesced
+    StorageCoalescer* getStorageCoalescer() const {
+        return storageCoalescer_;
+    }
+
+    // Null if no space caches the vertices
+    VertexCache* vertexCache() const {
+        return vertexCache_;
+    }
+
+    // Null if no space caches the neighbors
+    VertexCache* neighborCache() const {
+        return neighborCache_;
+    }
+
     meta::MetaClient* getMetaClient() const {
         return metaClient_;
     }
@@ -112,6 +142,11 @@ public:
         return charsetInfo_;
     }
 
+    // Account the memory of the results of query
+    const std::shared_ptr<MemoryTracker>& memoryTracker() const {
+        return memTracker_;
+    }
+
     ObjectPool* objPool() const {
         return objPool_.get();
     }
@@ -124,6 +159,26 @@ public:
         return symTable_.get();
     }
 
+    // The variables, i.e. `$name', referred by the expressions of statement, some of which
+    // are the parameters bound by the client
+    void addReferredVar(const std::string& name) {
+        referredVars_.emplace(name);
+    }
+
+    const std::unordered_set<std::string>& referredVars() const {
+        return referredVars_;
+    }
+
+    // The statement calls some functions returning different results in each call, e.g.
+    // rand(), so its plan must not be reused
+    void setNonDeterministic() {
+        nonDeterministic_ = true;
+    }
+
+    bool isNonDeterministic() const {
+        return nonDeterministic_;
+    }
+
     void setPartialSuccess() {
         DCHECK(rctx_ != nullptr);
         rctx_->resp().errorCode = ErrorCode::E_PARTIAL_SUCCEEDED;
@@ -137,9 +192,37 @@ public:
         return killed_.load();
     }
 
+    // Reserve at most `num' worker threads for the parallel executors of query,
+    // no more than `limit' ones are reserved at the same time.
+    // Return the number of threads reserved actually.
+    size_t reserveWorkers(size_t num, size_t limit) {
+        auto reserved = numWorkers_.load();
+        size_t n = 0;
+        do {
+            n = reserved >= limit ? 0 : std::min(num, limit - reserved);
+        } while (n > 0 && !numWorkers_.compare_exchange_weak(reserved, reserved + n));
+        return n;
+    }
+
+    void releaseWorkers(size_t num) {
+        DCHECK_GE(numWorkers_.load(), num);
+        numWorkers_ -= num;
+    }
+
+    // Drop the request and the execution results but keep the planning artifacts,
+    // i.e. the plan nodes, expressions and symbols, so that the plan could be cached.
+    void releaseRuntime() {
+        rctx_.reset();
+        ectx_ = std::make_unique<ExecutionContext>();
+        initMemoryTracker();
+    }
+
 private:
     void init();
 
+    // The tracker of query is the child of session's if any
+    void initMemoryTracker();
+
     RequestContextPtr                                       rctx_;
     std::unique_ptr<ValidateContext>                        vctx_;
     std::unique_ptr<ExecutionContext>                       ectx_;
@@ -147,6 +230,9 @@ private:
     meta::SchemaManager*                                    sm_{nullptr};
     meta::IndexManager*                                     im_{nullptr};
     storage::GraphStorageClient*                            storageClient_{nullptr};
+    StorageCoalescer*                                       storageCoalescer_{nullptr};
+    VertexCache*                                            vertexCache_{nullptr};
+    VertexCache*                                            neighborCache_{nullptr};
     meta::MetaClient*                                       metaClient_{nullptr};
     CharsetInfo*                                            charsetInfo_{nullptr};
 
@@ -155,8 +241,13 @@ private:
     std::unique_ptr<ObjectPool>                             objPool_;
     std::unique_ptr<IdGenerator>                            idGen_;
     std::unique_ptr<SymbolTable>                            symTable_;
+    std::unordered_set<std::string>                         referredVars_;
+    bool                                                    nonDeterministic_{false};
+    std::shared_ptr<MemoryTracker>                          memTracker_;
 
     std::atomic<bool>                                       killed_{false};
+    // Number of worker threads occupied by the parallel executors
+    std::atomic<size_t>                                     numWorkers_{0};
 };
 
 }   // namespace graph
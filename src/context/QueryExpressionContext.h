@@ -67,6 +67,11 @@ public:
         return *this;
     }
 
+    // The iterator of current row, which is read by the slots bound in compiled programs
+    Iterator* iter() const {
+        return iter_;
+    }
+
 private:
     // ExecutionContext and Iterator are used for getting runtime results,
     // and nullptr is acceptable for these two members if the expressions
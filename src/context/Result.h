@@ -103,6 +103,10 @@ public:
     Result finish() {
         if (!core_.iter) iter(Iterator::Kind::kSequential);
         if (!core_.value && core_.iter) value(core_.iter->valuePtr());
+        // The erased rows are removed once the result is materialized
+        if (core_.iter && (core_.iter->isSequentialIter() || core_.iter->isPropIter())) {
+            static_cast<SequentialIter*>(core_.iter.get())->compact();
+        }
         return Result(std::move(core_));
     }
 
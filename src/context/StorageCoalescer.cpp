@@ -0,0 +1,491 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "context/StorageCoalescer.h"
+
+#include "util/SchemaUtil.h"
+
+using nebula::storage::StorageRpcResponse;
+using nebula::storage::cpp2::EdgeDirection;
+using nebula::storage::cpp2::EdgeProp;
+using nebula::storage::cpp2::Expr;
+using nebula::storage::cpp2::GetNeighborsResponse;
+using nebula::storage::cpp2::GetPropResponse;
+using nebula::storage::cpp2::OrderBy;
+using nebula::storage::cpp2::StatProp;
+using nebula::storage::cpp2::VertexProp;
+
+namespace nebula {
+namespace graph {
+
+namespace {
+
+// A batch is sent before the window ends once it has so many vids
+constexpr size_t kMaxBatchVids = 4096;
+
+template <typename T>
+bool equals(const std::unique_ptr<T>& lhs, const std::unique_ptr<T>& rhs) {
+    if (lhs == nullptr || rhs == nullptr) {
+        return lhs == rhs;
+    }
+    return *lhs == *rhs;
+}
+
+template <typename T>
+std::unique_ptr<T> copyOf(const T* value) {
+    return value == nullptr ? nullptr : std::make_unique<T>(*value);
+}
+
+DataSet* datasetOf(GetNeighborsResponse& resp) {
+    return resp.vertices_ref().has_value() ? &*resp.vertices_ref() : nullptr;
+}
+
+DataSet* datasetOf(GetPropResponse& resp) {
+    return resp.props_ref().has_value() ? &*resp.props_ref() : nullptr;
+}
+
+void setDataset(GetNeighborsResponse& resp, DataSet ds) {
+    resp.vertices_ref() = std::move(ds);
+}
+
+void setDataset(GetPropResponse& resp, DataSet ds) {
+    resp.props_ref() = std::move(ds);
+}
+
+class ClientStorage final : public StorageCoalescer::Storage {
+public:
+    ClientStorage(storage::GraphStorageClient* client, meta::MetaClient* metaClient)
+        : client_(DCHECK_NOTNULL(client)), metaClient_(DCHECK_NOTNULL(metaClient)) {}
+
+    StorageCoalescer::RpcFuture<GetNeighborsResponse> getNeighbors(
+        GraphSpaceID space,
+        std::vector<std::string> colNames,
+        std::vector<Row> vertices,
+        const std::vector<EdgeType>& edgeTypes,
+        EdgeDirection edgeDirection,
+        const std::vector<StatProp>* statProps,
+        const std::vector<VertexProp>* vertexProps,
+        const std::vector<EdgeProp>* edgeProps,
+        const std::vector<Expr>* exprs,
+        bool dedup,
+        bool random,
+        const std::vector<OrderBy>& orderBy,
+        int64_t limit,
+        const std::string& filter) override {
+        return client_->getNeighbors(space,
+                                     std::move(colNames),
+                                     std::move(vertices),
+                                     edgeTypes,
+                                     edgeDirection,
+                                     statProps,
+                                     vertexProps,
+                                     edgeProps,
+                                     exprs,
+                                     dedup,
+                                     random,
+                                     orderBy,
+                                     limit,
+                                     filter);
+    }
+
+    StorageCoalescer::RpcFuture<GetPropResponse> getProps(
+        GraphSpaceID space,
+        DataSet input,
+        const std::vector<VertexProp>* vertexProps,
+        const std::vector<EdgeProp>* edgeProps,
+        const std::vector<Expr>* exprs,
+        bool dedup,
+        const std::vector<OrderBy>& orderBy,
+        int64_t limit,
+        const std::string& filter) override {
+        return client_->getProps(space,
+                                 std::move(input),
+                                 vertexProps,
+                                 edgeProps,
+                                 exprs,
+                                 dedup,
+                                 orderBy,
+                                 limit,
+                                 filter);
+    }
+
+    StatusOr<PartitionID> partId(GraphSpaceID space, const Value& vid) const override {
+        auto numParts = metaClient_->partsNum(space);
+        NG_RETURN_IF_ERROR(numParts);
+        return SchemaUtil::partId(metaClient_, numParts.value(), vid);
+    }
+
+private:
+    storage::GraphStorageClient*        client_{nullptr};
+    meta::MetaClient*                   metaClient_{nullptr};
+};
+
+}   // namespace
+
+struct StorageCoalescer::NeighborsKey {
+    GraphSpaceID                                space;
+    std::vector<std::string>                    colNames;
+    std::vector<EdgeType>                       edgeTypes;
+    EdgeDirection                               edgeDirection;
+    std::unique_ptr<std::vector<VertexProp>>    vertexProps;
+    std::unique_ptr<std::vector<EdgeProp>>      edgeProps;
+    std::unique_ptr<std::vector<Expr>>          exprs;
+    bool                                        dedup;
+    std::string                                 filter;
+
+    bool operator==(const NeighborsKey& rhs) const {
+        return space == rhs.space && edgeDirection == rhs.edgeDirection && dedup == rhs.dedup &&
+               colNames == rhs.colNames && edgeTypes == rhs.edgeTypes && filter == rhs.filter &&
+               equals(vertexProps, rhs.vertexProps) && equals(edgeProps, rhs.edgeProps) &&
+               equals(exprs, rhs.exprs);
+    }
+
+    RpcFuture<GetNeighborsResponse> send(Storage* storage, std::vector<Row> vertices) const {
+        return storage->getNeighbors(space,
+                                     colNames,
+                                     std::move(vertices),
+                                     edgeTypes,
+                                     edgeDirection,
+                                     nullptr,
+                                     vertexProps.get(),
+                                     edgeProps.get(),
+                                     exprs.get(),
+                                     dedup,
+                                     false,
+                                     {},
+                                     std::numeric_limits<int64_t>::max(),
+                                     filter);
+    }
+};
+
+struct StorageCoalescer::PropsKey {
+    GraphSpaceID                                space;
+    std::vector<std::string>                    colNames;
+    std::unique_ptr<std::vector<VertexProp>>    vertexProps;
+    std::unique_ptr<std::vector<Expr>>          exprs;
+    bool                                        dedup;
+    std::string                                 filter;
+
+    bool operator==(const PropsKey& rhs) const {
+        return space == rhs.space && dedup == rhs.dedup && colNames == rhs.colNames &&
+               filter == rhs.filter && equals(vertexProps, rhs.vertexProps) &&
+               equals(exprs, rhs.exprs);
+    }
+
+    RpcFuture<GetPropResponse> send(Storage* storage, std::vector<Row> vertices) const {
+        DataSet ds(colNames);
+        ds.rows = std::move(vertices);
+        return storage->getProps(space,
+                                 std::move(ds),
+                                 vertexProps.get(),
+                                 nullptr,
+                                 exprs.get(),
+                                 dedup,
+                                 {},
+                                 std::numeric_limits<int64_t>::max(),
+                                 filter);
+    }
+};
+
+template <typename Key, typename Resp>
+struct StorageCoalescer::Batch {
+    struct Waiter {
+        // The vids asked for, in the order of request
+        std::vector<Value>                              vids;
+        folly::Promise<StorageRpcResponse<Resp>>        promise;
+    };
+
+    std::unique_ptr<Key>                                key;
+    // The deduplicated vids of all waiters
+    std::vector<Row>                                    vertices;
+    std::unordered_set<Value>                           seen;
+    std::vector<Waiter>                                 waiters;
+
+    // Split the response of the batch to the waiters, each gets the rows of its vids
+    void deliver(StorageRpcResponse<Resp>&& resp, const Storage* storage) {
+        auto& responses = resp.responses();
+        // The response index and row index of the rows of each vid
+        std::unordered_map<Value, std::vector<std::pair<size_t, size_t>>> located;
+        for (size_t i = 0; i < responses.size(); ++i) {
+            auto* ds = datasetOf(responses[i]);
+            if (ds == nullptr) {
+                continue;
+            }
+            for (size_t j = 0; j < ds->rows.size(); ++j) {
+                located[ds->rows[j].values.front()].emplace_back(i, j);
+            }
+        }
+
+        // The partitions of the vids, only looked up when some parts failed
+        std::unordered_map<Value, PartitionID> partsOfVids;
+        auto partsOf = [&](const std::vector<Value>& vids) -> StatusOr<std::set<PartitionID>> {
+            std::set<PartitionID> parts;
+            for (auto& vid : vids) {
+                auto found = partsOfVids.find(vid);
+                if (found == partsOfVids.end()) {
+                    auto part = storage->partId(key->space, vid);
+                    NG_RETURN_IF_ERROR(part);
+                    found = partsOfVids.emplace(vid, part.value()).first;
+                }
+                parts.emplace(found->second);
+            }
+            return parts;
+        };
+
+        auto& failedParts = resp.failedParts();
+        for (auto& waiter : waiters) {
+            // Keep the completeness of the batch, which is in percentage, unless the parts of
+            // the vids are known
+            size_t numParts = 100;
+            size_t numFailed = 100 - resp.completeness();
+            auto ownFailedParts = failedParts;
+            StatusOr<std::set<PartitionID>> ownParts = std::set<PartitionID>();
+            if (!failedParts.empty()) {
+                ownParts = partsOf(waiter.vids);
+            }
+            if (ownParts.ok() && !ownParts.value().empty()) {
+                // Only the failed parts of its own vids count, as if it was sent alone
+                numParts = ownParts.value().size();
+                numFailed = 0;
+                ownFailedParts.clear();
+                for (auto part : ownParts.value()) {
+                    auto found = failedParts.find(part);
+                    if (found != failedParts.end()) {
+                        ownFailedParts.emplace(found->first, found->second);
+                        numFailed++;
+                    }
+                }
+            }
+            StorageRpcResponse<Resp> result(numParts);
+            for (size_t i = 0; i < numFailed; ++i) {
+                result.markFailure();
+            }
+            result.failedParts() = std::move(ownFailedParts);
+            for (auto& latency : resp.hostLatency()) {
+                result.setLatency(
+                    std::get<0>(latency), std::get<1>(latency), std::get<2>(latency));
+            }
+
+            std::vector<DataSet> parts(responses.size());
+            for (size_t i = 0; i < responses.size(); ++i) {
+                auto* ds = datasetOf(responses[i]);
+                if (ds != nullptr) {
+                    parts[i].colNames = ds->colNames;
+                }
+            }
+            for (auto& vid : waiter.vids) {
+                auto found = located.find(vid);
+                if (found == located.end()) {
+                    continue;
+                }
+                for (auto& loc : found->second) {
+                    parts[loc.first].rows.emplace_back(
+                        datasetOf(responses[loc.first])->rows[loc.second]);
+                }
+            }
+            for (size_t i = 0; i < responses.size(); ++i) {
+                Resp part;
+                if (datasetOf(responses[i]) != nullptr) {
+                    setDataset(part, std::move(parts[i]));
+                }
+                result.responses().emplace_back(std::move(part));
+            }
+            waiter.promise.setValue(std::move(result));
+        }
+    }
+};
+
+StorageCoalescer::StorageCoalescer(storage::GraphStorageClient* client,
+                                   meta::MetaClient* metaClient,
+                                   std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor,
+                                   uint32_t windowMs)
+    : StorageCoalescer(std::make_unique<ClientStorage>(client, metaClient),
+                       std::move(ioExecutor),
+                       windowMs) {}
+
+StorageCoalescer::StorageCoalescer(std::unique_ptr<Storage> storage,
+                                   std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor,
+                                   uint32_t windowMs)
+    : storage_(std::move(storage)), ioExecutor_(std::move(ioExecutor)), windowMs_(windowMs) {}
+
+StorageCoalescer::RpcFuture<GetNeighborsResponse> StorageCoalescer::getNeighbors(
+    GraphSpaceID space,
+    std::vector<std::string> colNames,
+    std::vector<Row> vertices,
+    const std::vector<EdgeType>& edgeTypes,
+    EdgeDirection edgeDirection,
+    const std::vector<StatProp>* statProps,
+    const std::vector<VertexProp>* vertexProps,
+    const std::vector<EdgeProp>* edgeProps,
+    const std::vector<Expr>* exprs,
+    bool dedup,
+    bool random,
+    const std::vector<OrderBy>& orderBy,
+    int64_t limit,
+    const std::string& filter) {
+    bool coalescable = colNames.size() == 1 && (statProps == nullptr || statProps->empty()) &&
+                       !random && orderBy.empty() &&
+                       limit == std::numeric_limits<int64_t>::max();
+    if (!coalescable) {
+        return storage_->getNeighbors(space,
+                                      std::move(colNames),
+                                      std::move(vertices),
+                                      edgeTypes,
+                                      edgeDirection,
+                                      statProps,
+                                      vertexProps,
+                                      edgeProps,
+                                      exprs,
+                                      dedup,
+                                      random,
+                                      orderBy,
+                                      limit,
+                                      filter);
+    }
+    auto key = std::make_unique<NeighborsKey>();
+    key->space = space;
+    key->colNames = std::move(colNames);
+    key->edgeTypes = edgeTypes;
+    key->edgeDirection = edgeDirection;
+    key->vertexProps = copyOf(vertexProps);
+    key->edgeProps = copyOf(edgeProps);
+    key->exprs = copyOf(exprs);
+    key->dedup = dedup;
+    key->filter = filter;
+    std::vector<Value> vids;
+    vids.reserve(vertices.size());
+    for (auto& row : vertices) {
+        vids.emplace_back(std::move(row.values.front()));
+    }
+    return enqueue(std::move(key), std::move(vids), &neighborsBatches_);
+}
+
+StorageCoalescer::RpcFuture<GetPropResponse> StorageCoalescer::getProps(
+    GraphSpaceID space,
+    DataSet input,
+    const std::vector<VertexProp>* vertexProps,
+    const std::vector<EdgeProp>* edgeProps,
+    const std::vector<Expr>* exprs,
+    bool dedup,
+    const std::vector<OrderBy>& orderBy,
+    int64_t limit,
+    const std::string& filter) {
+    bool coalescable = edgeProps == nullptr && input.colSize() == 1 && orderBy.empty() &&
+                       limit == std::numeric_limits<int64_t>::max();
+    if (!coalescable) {
+        return storage_->getProps(space,
+                                  std::move(input),
+                                  vertexProps,
+                                  edgeProps,
+                                  exprs,
+                                  dedup,
+                                  orderBy,
+                                  limit,
+                                  filter);
+    }
+    auto key = std::make_unique<PropsKey>();
+    key->space = space;
+    key->colNames = std::move(input.colNames);
+    key->vertexProps = copyOf(vertexProps);
+    key->exprs = copyOf(exprs);
+    key->dedup = dedup;
+    key->filter = filter;
+    std::vector<Value> vids;
+    vids.reserve(input.rows.size());
+    for (auto& row : input.rows) {
+        vids.emplace_back(std::move(row.values.front()));
+    }
+    return enqueue(std::move(key), std::move(vids), &propsBatches_);
+}
+
+template <typename Key, typename Resp>
+StorageCoalescer::RpcFuture<Resp> StorageCoalescer::enqueue(std::unique_ptr<Key> key,
+                                                            std::vector<Value> vids,
+                                                            BatchList<Key, Resp>* batches) {
+    std::shared_ptr<Batch<Key, Resp>> batch;
+    bool created = false;
+    bool full = false;
+    typename Batch<Key, Resp>::Waiter waiter;
+    auto future = waiter.promise.getSemiFuture();
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (auto& open : *batches) {
+            if (*open->key == *key) {
+                batch = open;
+                break;
+            }
+        }
+        if (batch == nullptr) {
+            batch = std::make_shared<Batch<Key, Resp>>();
+            batch->key = std::move(key);
+            batches->emplace_back(batch);
+            created = true;
+        }
+        for (auto& vid : vids) {
+            if (batch->seen.emplace(vid).second) {
+                batch->vertices.emplace_back(Row({vid}));
+            }
+        }
+        waiter.vids = std::move(vids);
+        batch->waiters.emplace_back(std::move(waiter));
+        if (batch->vertices.size() >= kMaxBatchVids) {
+            full = detach(batch, batches);
+        }
+    }
+
+    if (full) {
+        flush(std::move(batch));
+    } else if (created) {
+        auto* evb = ioExecutor_->getEventBase();
+        evb->runInEventBaseThread([this, evb, batch, batches]() {
+            evb->runAfterDelay(
+                [this, batch, batches]() {
+                    bool detached = false;
+                    {
+                        std::lock_guard<std::mutex> guard(lock_);
+                        detached = detach(batch, batches);
+                    }
+                    if (detached) {
+                        flush(batch);
+                    }
+                },
+                windowMs_);
+        });
+    }
+    return future;
+}
+
+template <typename Key, typename Resp>
+bool StorageCoalescer::detach(const std::shared_ptr<Batch<Key, Resp>>& batch,
+                              BatchList<Key, Resp>* batches) {
+    auto found = std::find(batches->begin(), batches->end(), batch);
+    if (found == batches->end()) {
+        return false;
+    }
+    batches->erase(found);
+    return true;
+}
+
+template <typename Key, typename Resp>
+void StorageCoalescer::flush(std::shared_ptr<Batch<Key, Resp>> batch) {
+    VLOG(2) << "Send " << batch->vertices.size() << " vertices of " << batch->waiters.size()
+            << " requests in one batch";
+    auto vertices = std::move(batch->vertices);
+    batch->key->send(storage_.get(), std::move(vertices))
+        .via(ioExecutor_.get())
+        .thenTry([this, batch](folly::Try<StorageRpcResponse<Resp>>&& resp) {
+            if (resp.hasException()) {
+                for (auto& waiter : batch->waiters) {
+                    waiter.promise.setException(resp.exception());
+                }
+                return;
+            }
+            batch->deliver(std::move(resp).value(), storage_.get());
+        });
+}
+
+}   // namespace graph
+}   // namespace nebula
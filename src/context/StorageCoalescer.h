@@ -0,0 +1,146 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CONTEXT_STORAGECOALESCER_H_
+#define CONTEXT_STORAGECOALESCER_H_
+
+#include <folly/executors/IOThreadPoolExecutor.h>
+
+#include "common/base/Base.h"
+#include "common/clients/storage/GraphStorageClient.h"
+#include "common/cpp/helpers.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * StorageCoalescer batches the getNeighbors and getProps requests of vertices sent by the
+ * concurrent queries. The compatible requests, i.e. the ones asking for the same things of
+ * different vertices, arrived within a short window are merged into one request of the
+ * deduplicated vids, which the storage client sends as one RPC per host as usual. The
+ * response is split back to each request by the vids it asked for, so it looks the same as
+ * the one of its own request, including the failed parts and the completeness which only
+ * count the parts of its vids.
+ *
+ * The requests with the options depending on the other vertices of the same request, e.g.
+ * limit, order by, random and stats, are never merged and sent alone.
+ */
+class StorageCoalescer final : private cpp::NonCopyable, private cpp::NonMovable {
+public:
+    template <typename Resp>
+    using RpcFuture = folly::SemiFuture<storage::StorageRpcResponse<Resp>>;
+
+    // Where the requests are sent to, which is the storage client except in tests
+    class Storage {
+    public:
+        virtual ~Storage() = default;
+
+        virtual RpcFuture<storage::cpp2::GetNeighborsResponse> getNeighbors(
+            GraphSpaceID space,
+            std::vector<std::string> colNames,
+            std::vector<Row> vertices,
+            const std::vector<EdgeType>& edgeTypes,
+            storage::cpp2::EdgeDirection edgeDirection,
+            const std::vector<storage::cpp2::StatProp>* statProps,
+            const std::vector<storage::cpp2::VertexProp>* vertexProps,
+            const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+            const std::vector<storage::cpp2::Expr>* exprs,
+            bool dedup,
+            bool random,
+            const std::vector<storage::cpp2::OrderBy>& orderBy,
+            int64_t limit,
+            const std::string& filter) = 0;
+
+        virtual RpcFuture<storage::cpp2::GetPropResponse> getProps(
+            GraphSpaceID space,
+            DataSet input,
+            const std::vector<storage::cpp2::VertexProp>* vertexProps,
+            const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+            const std::vector<storage::cpp2::Expr>* exprs,
+            bool dedup,
+            const std::vector<storage::cpp2::OrderBy>& orderBy,
+            int64_t limit,
+            const std::string& filter) = 0;
+
+        // The partition of the vid in the space
+        virtual StatusOr<PartitionID> partId(GraphSpaceID space, const Value& vid) const = 0;
+    };
+
+    StorageCoalescer(storage::GraphStorageClient* client,
+                     meta::MetaClient* metaClient,
+                     std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor,
+                     uint32_t windowMs);
+
+    StorageCoalescer(std::unique_ptr<Storage> storage,
+                     std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor,
+                     uint32_t windowMs);
+
+    // Same as GraphStorageClient::getNeighbors
+    RpcFuture<storage::cpp2::GetNeighborsResponse> getNeighbors(
+        GraphSpaceID space,
+        std::vector<std::string> colNames,
+        std::vector<Row> vertices,
+        const std::vector<EdgeType>& edgeTypes,
+        storage::cpp2::EdgeDirection edgeDirection,
+        const std::vector<storage::cpp2::StatProp>* statProps,
+        const std::vector<storage::cpp2::VertexProp>* vertexProps,
+        const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+        const std::vector<storage::cpp2::Expr>* exprs,
+        bool dedup,
+        bool random,
+        const std::vector<storage::cpp2::OrderBy>& orderBy,
+        int64_t limit,
+        const std::string& filter);
+
+    // Same as GraphStorageClient::getProps, only the ones of vertices are coalesced
+    RpcFuture<storage::cpp2::GetPropResponse> getProps(
+        GraphSpaceID space,
+        DataSet input,
+        const std::vector<storage::cpp2::VertexProp>* vertexProps,
+        const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+        const std::vector<storage::cpp2::Expr>* exprs,
+        bool dedup,
+        const std::vector<storage::cpp2::OrderBy>& orderBy,
+        int64_t limit,
+        const std::string& filter);
+
+private:
+    struct NeighborsKey;
+    struct PropsKey;
+
+    template <typename Key, typename Resp>
+    struct Batch;
+
+    template <typename Key, typename Resp>
+    using BatchList = std::vector<std::shared_ptr<Batch<Key, Resp>>>;
+
+    // Add the vids to the open batch of the same key, or a new one flushed after the window
+    template <typename Key, typename Resp>
+    RpcFuture<Resp> enqueue(std::unique_ptr<Key> key,
+                            std::vector<Value> vids,
+                            BatchList<Key, Resp>* batches);
+
+    // Return false if the batch has been taken away by others
+    template <typename Key, typename Resp>
+    bool detach(const std::shared_ptr<Batch<Key, Resp>>& batch, BatchList<Key, Resp>* batches);
+
+    template <typename Key, typename Resp>
+    void flush(std::shared_ptr<Batch<Key, Resp>> batch);
+
+    std::unique_ptr<Storage>                        storage_;
+    std::shared_ptr<folly::IOThreadPoolExecutor>    ioExecutor_;
+    uint32_t                                        windowMs_{0};
+
+    std::mutex                                      lock_;
+    // The batches waiting for the window to end
+    BatchList<NeighborsKey, storage::cpp2::GetNeighborsResponse>    neighborsBatches_;
+    BatchList<PropsKey, storage::cpp2::GetPropResponse>             propsBatches_;
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // CONTEXT_STORAGECOALESCER_H_
@@ -0,0 +1,215 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "context/VertexCache.h"
+
+#include <folly/hash/Hash.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include "common/time/WallClock.h"
+#include "util/SpillFile.h"
+
+namespace nebula {
+namespace graph {
+
+VertexCache::VertexCache(size_t capacity,
+                         int64_t maxBytes,
+                         int64_t ttlSecs,
+                         std::unordered_set<std::string> spaces,
+                         size_t numShards) {
+    numShards = std::max<size_t>(numShards, 1);
+    capacityPerShard_ = capacity == 0 ? 0 : std::max<size_t>(capacity / numShards, 1);
+    maxBytesPerShard_ = maxBytes <= 0 ? 0 : std::max<int64_t>(maxBytes / numShards, 1);
+    ttlSecs_ = ttlSecs;
+    spaces_ = std::move(spaces);
+    shards_.reserve(numShards);
+    for (size_t i = 0; i < numShards; ++i) {
+        shards_.emplace_back(std::make_unique<Shard>());
+    }
+}
+
+// static
+std::string VertexCache::shapeOf(const std::vector<storage::cpp2::VertexProp>* props,
+                                 const std::vector<storage::cpp2::Expr>* exprs) {
+    std::string shape;
+    // Tell the null from the empty
+    shape.append(props == nullptr ? "N" : "P");
+    if (props != nullptr) {
+        for (auto& prop : *props) {
+            apache::thrift::CompactSerializer::serialize(prop, &shape);
+        }
+    }
+    shape.append(exprs == nullptr ? "N" : "E");
+    if (exprs != nullptr) {
+        for (auto& expr : *exprs) {
+            apache::thrift::CompactSerializer::serialize(expr, &shape);
+        }
+    }
+    return shape;
+}
+
+// static
+std::string VertexCache::shapeOf(const std::vector<EdgeType>& edgeTypes,
+                                 storage::cpp2::EdgeDirection edgeDirection,
+                                 const std::vector<storage::cpp2::StatProp>* statProps,
+                                 const std::vector<storage::cpp2::VertexProp>* vertexProps,
+                                 const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+                                 const std::vector<storage::cpp2::Expr>* exprs,
+                                 bool dedup,
+                                 const std::string& filter) {
+    auto shape = shapeOf(vertexProps, exprs);
+    for (auto edgeType : edgeTypes) {
+        shape.append(reinterpret_cast<const char*>(&edgeType), sizeof(edgeType));
+    }
+    shape.append(1, static_cast<char>(edgeDirection));
+    shape.append(statProps == nullptr ? "N" : "S");
+    if (statProps != nullptr) {
+        for (auto& prop : *statProps) {
+            apache::thrift::CompactSerializer::serialize(prop, &shape);
+        }
+    }
+    shape.append(edgeProps == nullptr ? "N" : "E");
+    if (edgeProps != nullptr) {
+        for (auto& prop : *edgeProps) {
+            apache::thrift::CompactSerializer::serialize(prop, &shape);
+        }
+    }
+    shape.append(dedup ? "D" : "A");
+    shape.append(filter);
+    return shape;
+}
+
+size_t VertexCache::VertexKeyHash::operator()(const VertexKey& key) const {
+    return folly::hash::hash_combine(key.space, std::hash<Value>()(key.vid));
+}
+
+VertexCache::Shard& VertexCache::shardOf(const VertexKey& key) {
+    // The low bits are used by the buckets of index
+    return *shards_[(VertexKeyHash()(key) >> 16) % shards_.size()];
+}
+
+bool VertexCache::get(GraphSpaceID space,
+                      const Value& vid,
+                      const std::string& shape,
+                      Row* row,
+                      ColNames* colNames) {
+    VertexKey key{space, vid};
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        auto entry = found->second;
+        auto& shapes = entry->shapes;
+        for (auto it = shapes.begin(); it != shapes.end(); ++it) {
+            if (it->shape != shape) {
+                continue;
+            }
+            if (ttlSecs_ > 0 && time::WallClock::fastNowInSec() - it->fetchedInSec >= ttlSecs_) {
+                account(&shard, -it->bytes);
+                shapes.erase(it);
+                if (shapes.empty()) {
+                    erase(&shard, entry);
+                }
+                break;
+            }
+            *row = it->row;
+            *colNames = it->colNames;
+            shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void VertexCache::put(GraphSpaceID space,
+                      const Value& vid,
+                      const std::string& shape,
+                      const Row& row,
+                      ColNames colNames,
+                      uint64_t epoch) {
+    VertexKey key{space, vid};
+    ShapeEntry shapeEntry{shape,
+                          row,
+                          std::move(colNames),
+                          time::WallClock::fastNowInSec(),
+                          SpillFile::estimateSize(row) + static_cast<int64_t>(shape.size())};
+
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (epoch < shard.invalidated) {
+        // It may be fetched before the vertex was changed
+        return;
+    }
+    account(&shard, shapeEntry.bytes);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        auto entry = found->second;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+        bool replaced = false;
+        for (auto& cached : entry->shapes) {
+            if (cached.shape == shape) {
+                account(&shard, -cached.bytes);
+                cached = std::move(shapeEntry);
+                replaced = true;
+                break;
+            }
+        }
+        if (!replaced) {
+            entry->shapes.emplace_back(std::move(shapeEntry));
+        }
+    } else {
+        shard.lru.emplace_front(VertexEntry{std::move(key), {}});
+        shard.lru.front().shapes.emplace_back(std::move(shapeEntry));
+        shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    }
+    evict(&shard);
+}
+
+void VertexCache::invalidate(GraphSpaceID space, const Value& vid) {
+    VertexKey key{space, vid};
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    shard.invalidated = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        erase(&shard, found->second);
+    }
+}
+
+size_t VertexCache::size() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        size += shard->lru.size();
+    }
+    return size;
+}
+
+void VertexCache::erase(Shard* shard, std::list<VertexEntry>::iterator entry) {
+    for (auto& shape : entry->shapes) {
+        account(shard, -shape.bytes);
+    }
+    shard->index.erase(entry->key);
+    shard->lru.erase(entry);
+}
+
+void VertexCache::account(Shard* shard, int64_t bytes) {
+    shard->bytes += bytes;
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void VertexCache::evict(Shard* shard) {
+    while (shard->lru.size() > 1 &&
+           ((capacityPerShard_ > 0 && shard->lru.size() > capacityPerShard_) ||
+            (maxBytesPerShard_ > 0 && shard->bytes > maxBytesPerShard_))) {
+        erase(shard, std::prev(shard->lru.end()));
+    }
+}
+
+}   // namespace graph
+}   // namespace nebula
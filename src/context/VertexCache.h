@@ -0,0 +1,167 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CONTEXT_VERTEXCACHE_H_
+#define CONTEXT_VERTEXCACHE_H_
+
+#include <list>
+#include <mutex>
+
+#include "common/base/Base.h"
+#include "common/cpp/helpers.h"
+#include "common/datatypes/DataSet.h"
+#include "common/interface/gen-cpp2/storage_types.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * VertexCache keeps the rows of vertices fetched from storage, keyed by the space, the vid and
+ * the shape of request, i.e. the tags, props and expressions asked for. The hot vertices are
+ * served by graphd without the RPCs. One instance caches the vertex properties of GetVertices,
+ * another one caches the rows of GetNeighbors, i.e. the adjacency lists of the vertices.
+ *
+ * It's an LRU of vertices split into shards by the hash of vid, each shard has its own lock.
+ * A row expires after the TTL since fetched, and all rows of a vertex are invalidated once
+ * it's inserted, updated or deleted through this graphd. The changes made through the other
+ * graphds are only seen after the TTL, so it's only enabled for the listed spaces.
+ *
+ * The rows fetched before an invalidation may arrive after it, they're told by the epoch
+ * taken before fetching and never put, the same for the other vertices of the same shard.
+ */
+class VertexCache final : private cpp::NonCopyable, private cpp::NonMovable {
+public:
+    // `capacity' is the max number of vertices and `maxBytes' is the max rough bytes of rows,
+    // 0 for no limit. `ttlSecs' less than or equal to 0 means never expire.
+    VertexCache(size_t capacity,
+                int64_t maxBytes,
+                int64_t ttlSecs,
+                std::unordered_set<std::string> spaces,
+                size_t numShards = 16);
+
+    bool enabled(const std::string& spaceName) const {
+        return spaces_.find(spaceName) != spaces_.end();
+    }
+
+    // The shape of request, the rows of different shapes of a vertex are cached separately
+    static std::string shapeOf(const std::vector<storage::cpp2::VertexProp>* props,
+                               const std::vector<storage::cpp2::Expr>* exprs);
+
+    // The shape of GetNeighbors request
+    static std::string shapeOf(const std::vector<EdgeType>& edgeTypes,
+                               storage::cpp2::EdgeDirection edgeDirection,
+                               const std::vector<storage::cpp2::StatProp>* statProps,
+                               const std::vector<storage::cpp2::VertexProp>* vertexProps,
+                               const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+                               const std::vector<storage::cpp2::Expr>* exprs,
+                               bool dedup,
+                               const std::string& filter);
+
+    using ColNames = std::shared_ptr<const std::vector<std::string>>;
+
+    // Return false if missed, the row and the names of its columns are copied out if hit
+    bool get(GraphSpaceID space,
+             const Value& vid,
+             const std::string& shape,
+             Row* row,
+             ColNames* colNames);
+
+    // Take it before fetching the rows to put
+    uint64_t epoch() const {
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    // The names of columns are shared by the rows of one response. The row is dropped if
+    // the shard has been invalidated since `epoch'.
+    void put(GraphSpaceID space,
+             const Value& vid,
+             const std::string& shape,
+             const Row& row,
+             ColNames colNames,
+             uint64_t epoch);
+
+    void invalidate(GraphSpaceID space, const Value& vid);
+
+    int64_t hits() const {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    int64_t misses() const {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    // Rough bytes of the cached rows
+    int64_t bytes() const {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const;
+
+private:
+    struct VertexKey {
+        GraphSpaceID    space;
+        Value           vid;
+
+        bool operator==(const VertexKey& rhs) const {
+            return space == rhs.space && vid == rhs.vid;
+        }
+    };
+
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey& key) const;
+    };
+
+    struct ShapeEntry {
+        std::string                 shape;
+        Row                         row;
+        ColNames                    colNames;
+        int64_t                     fetchedInSec;
+        int64_t                     bytes;
+    };
+
+    struct VertexEntry {
+        VertexKey                   key;
+        std::vector<ShapeEntry>     shapes;
+    };
+
+    struct Shard {
+        std::mutex                  lock;
+        // The most recently used one is at the front
+        std::list<VertexEntry>      lru;
+        std::unordered_map<VertexKey, std::list<VertexEntry>::iterator, VertexKeyHash> index;
+        int64_t                     bytes{0};
+        // The epoch of the latest invalidation
+        uint64_t                    invalidated{0};
+    };
+
+    Shard& shardOf(const VertexKey& key);
+
+    // Remove the vertex from the shard, with the lock of shard held
+    void erase(Shard* shard, std::list<VertexEntry>::iterator entry);
+
+    // Account the bytes of a row of the shard
+    void account(Shard* shard, int64_t bytes);
+
+    // Evict the least recently used vertices until the shard is within the capacity,
+    // except the most recent one
+    void evict(Shard* shard);
+
+    size_t                                  capacityPerShard_;
+    int64_t                                 maxBytesPerShard_;
+    int64_t                                 ttlSecs_;
+    std::unordered_set<std::string>         spaces_;
+    std::vector<std::unique_ptr<Shard>>     shards_;
+
+    std::atomic<int64_t>                    hits_{0};
+    std::atomic<int64_t>                    misses_{0};
+    std::atomic<int64_t>                    bytes_{0};
+    std::atomic<uint64_t>                   epoch_{0};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // CONTEXT_VERTEXCACHE_H_
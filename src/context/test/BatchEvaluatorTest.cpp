@@ -0,0 +1,120 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "common/base/ObjectPool.h"
+#include "common/expression/ArithmeticExpression.h"
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/FunctionCallExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/RelationalExpression.h"
+#include "common/expression/UnaryExpression.h"
+#include "context/BatchEvaluator.h"
+
+namespace nebula {
+namespace graph {
+
+class BatchEvaluatorTest : public testing::Test {
+protected:
+    void SetUp() override {
+        DataSet ds({"a", "b", "c", "d"});
+        for (int64_t i = 0; i < 100; ++i) {
+            Row row;
+            // a: int with some NULLs
+            row.values.emplace_back(i % 7 == 0 ? Value(NullType::__NULL__) : Value(i));
+            // b: float
+            row.values.emplace_back(i * 0.5);
+            // c: string
+            row.values.emplace_back(folly::to<std::string>("name", i % 10));
+            // d: bool
+            row.values.emplace_back(i % 3 == 0);
+            ds.rows.emplace_back(std::move(row));
+        }
+        value_ = std::make_shared<Value>(std::move(ds));
+    }
+
+    // Check the results of batch evaluation are the same as the ones of row path
+    void check(Expression* expr, bool vectorized = true) {
+        SequentialIter iter(value_);
+        auto evaluator = BatchEvaluator::make(expr, &iter);
+        ASSERT_EQ(evaluator != nullptr, vectorized) << expr->toString();
+        if (!vectorized) {
+            return;
+        }
+
+        QueryExpressionContext ctx(nullptr);
+        std::vector<Value> expected;
+        for (; iter.valid(); iter.next()) {
+            expected.emplace_back(expr->eval(ctx(&iter)));
+        }
+        for (size_t batchSize : {1, 7, 64, 100}) {
+            std::vector<Value> result;
+            for (size_t begin = 0; begin < iter.size(); begin += batchSize) {
+                auto num = std::min(batchSize, iter.size() - begin);
+                evaluator->eval(&iter, begin, num, ctx, &result);
+            }
+            EXPECT_EQ(result, expected) << expr->toString() << ", batch size " << batchSize;
+        }
+    }
+
+    Expression* col(const std::string& name) {
+        return InputPropertyExpression::make(&pool_, name);
+    }
+
+    Expression* constant(Value value) {
+        return ConstantExpression::make(&pool_, std::move(value));
+    }
+
+    ObjectPool                  pool_;
+    std::shared_ptr<Value>      value_;
+};
+
+TEST_F(BatchEvaluatorTest, Relational) {
+    check(RelationalExpression::makeGT(&pool_, col("a"), constant(50)));
+    check(RelationalExpression::makeLE(&pool_, col("a"), col("a")));
+    check(RelationalExpression::makeEQ(&pool_, col("c"), constant("name3")));
+    check(RelationalExpression::makeNE(&pool_, col("d"), constant(true)));
+    check(RelationalExpression::makeLT(&pool_, col("b"), constant(10.0)));
+    check(RelationalExpression::makeEQ(&pool_, col("b"), constant(10.0)));
+    check(RelationalExpression::makeGE(&pool_, col("a"), col("b")));
+    // Not existed column
+    check(RelationalExpression::makeGT(&pool_, col("e"), constant(1)));
+}
+
+TEST_F(BatchEvaluatorTest, Arithmetic) {
+    check(ArithmeticExpression::makeAdd(&pool_, col("a"), constant(1)));
+    check(ArithmeticExpression::makeMinus(&pool_, col("a"), col("b")));
+    check(ArithmeticExpression::makeMultiply(&pool_, col("b"), constant(2)));
+    check(ArithmeticExpression::makeDivision(&pool_, col("a"), constant(0)));
+    check(ArithmeticExpression::makeMod(&pool_, col("a"), constant(3)));
+    check(ArithmeticExpression::makeAdd(&pool_, col("c"), constant("_suffix")));
+    check(ArithmeticExpression::makeAdd(
+        &pool_, col("a"), constant(std::numeric_limits<int64_t>::max())));
+}
+
+TEST_F(BatchEvaluatorTest, Logical) {
+    auto* gt = RelationalExpression::makeGT(&pool_, col("a"), constant(20));
+    auto* lt = RelationalExpression::makeLT(&pool_, col("b"), constant(40.0));
+    check(LogicalExpression::makeAnd(&pool_, gt, lt));
+    check(LogicalExpression::makeOr(&pool_, col("d"), gt));
+    check(UnaryExpression::makeNot(&pool_, col("d")));
+    check(UnaryExpression::makeNot(&pool_, gt));
+}
+
+TEST_F(BatchEvaluatorTest, Fallback) {
+    auto* args = ArgumentList::make(&pool_);
+    args->addArgument(col("c"));
+    auto* func = FunctionCallExpression::make(&pool_, "lower", args);
+    // Not supported at all
+    check(func, false);
+    // Partially supported
+    check(RelationalExpression::makeEQ(&pool_, func, constant("name1")));
+}
+
+}   // namespace graph
+}   // namespace nebula
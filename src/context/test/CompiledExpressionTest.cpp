@@ -0,0 +1,233 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "common/base/ObjectPool.h"
+#include "common/expression/ArithmeticExpression.h"
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/ContainerExpression.h"
+#include "common/expression/FunctionCallExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/RelationalExpression.h"
+#include "common/expression/UnaryExpression.h"
+#include "context/CompiledExpression.h"
+
+DECLARE_bool(enable_expr_compile);
+
+namespace nebula {
+namespace graph {
+
+class CompiledExpressionTest : public testing::Test {
+protected:
+    void SetUp() override {
+        DataSet ds({"a", "b", "c", "d"});
+        for (int64_t i = 0; i < 100; ++i) {
+            Row row;
+            // a: int with some NULLs
+            row.values.emplace_back(i % 7 == 0 ? Value(NullType::__NULL__) : Value(i));
+            // b: float
+            row.values.emplace_back(i * 0.5);
+            // c: string
+            row.values.emplace_back(folly::to<std::string>("name", i % 10));
+            // d: bool
+            row.values.emplace_back(i % 3 == 0);
+            ds.rows.emplace_back(std::move(row));
+        }
+        value_ = std::make_shared<Value>(std::move(ds));
+    }
+
+    // Check the results of compiled program are the same as the ones of expression
+    void check(Expression* expr) {
+        QueryExpressionContext ctx(nullptr);
+        std::vector<Value> expected;
+        for (SequentialIter iter(value_); iter.valid(); iter.next()) {
+            expected.emplace_back(expr->eval(ctx(&iter)));
+        }
+        for (bool enabled : {true, false}) {
+            FLAGS_enable_expr_compile = enabled;
+            auto program = CompiledExpression::compile(&pool_, expr);
+            std::vector<Value> result;
+            for (SequentialIter iter(value_); iter.valid(); iter.next()) {
+                result.emplace_back(program->eval(ctx(&iter)));
+            }
+            EXPECT_EQ(result, expected) << expr->toString() << ", compiled " << enabled;
+        }
+    }
+
+    Expression* col(const std::string& name) {
+        return InputPropertyExpression::make(&pool_, name);
+    }
+
+    Expression* constant(Value value) {
+        return ConstantExpression::make(&pool_, std::move(value));
+    }
+
+    // Restore the flags changed by each test
+    gflags::FlagSaver           flagSaver_;
+    ObjectPool                  pool_;
+    std::shared_ptr<Value>      value_;
+};
+
+TEST_F(CompiledExpressionTest, Relational) {
+    check(RelationalExpression::makeGT(&pool_, col("a"), constant(50)));
+    check(RelationalExpression::makeLE(&pool_, col("a"), col("a")));
+    check(RelationalExpression::makeEQ(&pool_, col("c"), constant("name3")));
+    check(RelationalExpression::makeNE(&pool_, col("d"), constant(true)));
+    check(RelationalExpression::makeLT(&pool_, col("b"), constant(10.0)));
+    check(RelationalExpression::makeEQ(&pool_, col("b"), constant(10.0)));
+    check(RelationalExpression::makeGE(&pool_, col("a"), col("b")));
+    // Not existed column
+    check(RelationalExpression::makeGT(&pool_, col("e"), constant(1)));
+}
+
+TEST_F(CompiledExpressionTest, Arithmetic) {
+    check(ArithmeticExpression::makeAdd(&pool_, col("a"), constant(1)));
+    check(ArithmeticExpression::makeMinus(&pool_, col("a"), col("b")));
+    check(ArithmeticExpression::makeMultiply(&pool_, col("b"), constant(2)));
+    check(ArithmeticExpression::makeDivision(&pool_, col("a"), constant(0)));
+    check(ArithmeticExpression::makeMod(&pool_, col("a"), constant(3)));
+    check(ArithmeticExpression::makeAdd(&pool_, col("c"), constant("_suffix")));
+    check(ArithmeticExpression::makeAdd(
+        &pool_, col("a"), constant(std::numeric_limits<int64_t>::max())));
+}
+
+TEST_F(CompiledExpressionTest, Logical) {
+    auto* gt = RelationalExpression::makeGT(&pool_, col("a"), constant(20));
+    auto* lt = RelationalExpression::makeLT(&pool_, col("b"), constant(40.0));
+    check(LogicalExpression::makeAnd(&pool_, gt, lt));
+    check(LogicalExpression::makeOr(&pool_, col("d"), gt));
+    check(LogicalExpression::makeAnd(&pool_, col("d"), col("a")));
+    check(UnaryExpression::makeNot(&pool_, col("d")));
+    check(UnaryExpression::makeNot(&pool_, gt));
+    // NULL of the operands unless decided by the others
+    check(LogicalExpression::makeOr(&pool_, gt, col("d")));
+    auto* all = LogicalExpression::makeAnd(&pool_);
+    all->addOperand(col("d"));
+    all->addOperand(gt);
+    all->addOperand(lt);
+    check(all);
+    check(UnaryExpression::makeNot(&pool_, col("a")));
+}
+
+TEST_F(CompiledExpressionTest, FoldConstant) {
+    // 1 + 2 * 3 is folded into 7 when compiling
+    auto* folded = ArithmeticExpression::makeAdd(
+        &pool_, constant(1), ArithmeticExpression::makeMultiply(&pool_, constant(2), constant(3)));
+    auto* expr = RelationalExpression::makeLT(&pool_, col("a"), folded);
+    check(expr);
+    auto program = CompiledExpression::compile(&pool_, expr);
+    auto* rhs = static_cast<RelationalExpression*>(program->expr())->right();
+    ASSERT_EQ(rhs->kind(), Expression::Kind::kConstant);
+    EXPECT_EQ(static_cast<ConstantExpression*>(rhs)->value(), Value(7));
+    // The original expression is untouched
+    EXPECT_EQ(folded->kind(), Expression::Kind::kAdd);
+}
+
+TEST_F(CompiledExpressionTest, In) {
+    auto* names = ExpressionList::make(&pool_);
+    for (int i = 0; i < 20; i += 2) {
+        names->add(constant(folly::to<std::string>("name", i)));
+    }
+    // The list of constants is folded into a constant list
+    check(RelationalExpression::makeIn(&pool_, col("c"), ListExpression::make(&pool_, names)));
+    check(RelationalExpression::makeNotIn(&pool_, col("c"), constant(List({"name1", "name5"}))));
+    check(RelationalExpression::makeIn(&pool_, col("a"), constant(List({1, 2, 30, 71}))));
+    check(RelationalExpression::makeIn(&pool_, col("a"), constant(Set({3, 4, 50}))));
+    check(RelationalExpression::makeNotIn(&pool_, col("d"), constant(List({true}))));
+    // Mixed with float and NULL
+    check(RelationalExpression::makeIn(&pool_, col("a"), constant(List({1, 2.0, 4.5}))));
+    check(RelationalExpression::makeIn(&pool_, col("b"), constant(List({1, 2.0, 4.5}))));
+    check(RelationalExpression::makeIn(
+        &pool_, col("a"), constant(List({Value(1), Value(NullType::__NULL__)}))));
+    check(RelationalExpression::makeNotIn(
+        &pool_, col("a"), constant(List({Value(1), Value(NullType::__NULL__)}))));
+    // Not a constant collection
+    auto* items = ExpressionList::make(&pool_);
+    items->add(col("a"));
+    items->add(constant(5));
+    check(RelationalExpression::makeIn(&pool_, col("a"), ListExpression::make(&pool_, items)));
+}
+
+TEST_F(CompiledExpressionTest, StringPredicate) {
+    check(RelationalExpression::makeREG(&pool_, col("c"), constant("name[1-3]")));
+    check(RelationalExpression::makeREG(&pool_, col("a"), constant("name[1-3]")));
+    check(RelationalExpression::makeREG(&pool_, col("c"), constant("name[")));
+    check(RelationalExpression::makeContains(&pool_, col("c"), constant("e1")));
+    check(RelationalExpression::makeNotContains(&pool_, col("c"), constant("e1")));
+    check(RelationalExpression::makeStartsWith(&pool_, col("c"), constant("nam")));
+    check(RelationalExpression::makeNotStartsWith(&pool_, col("c"), constant("ame")));
+    check(RelationalExpression::makeEndsWith(&pool_, col("c"), constant("7")));
+    check(RelationalExpression::makeNotEndsWith(&pool_, col("c"), constant("")));
+    check(RelationalExpression::makeContains(&pool_, col("a"), constant("1")));
+    check(RelationalExpression::makeEndsWith(&pool_, col("c"), col("a")));
+    check(RelationalExpression::makeStartsWith(&pool_, constant(Value::kNullValue), col("c")));
+}
+
+TEST_F(CompiledExpressionTest, Fallback) {
+    auto* args = ArgumentList::make(&pool_);
+    args->addArgument(col("c"));
+    auto* func = FunctionCallExpression::make(&pool_, "lower", args);
+    check(func);
+    check(RelationalExpression::makeEQ(&pool_, func, constant("name1")));
+    check(LogicalExpression::makeXor(&pool_, col("d"), constant(true)));
+}
+
+TEST_F(CompiledExpressionTest, BindSlots) {
+    // The props are in different orders in the datasets
+    DataSet ds1;
+    ds1.colNames = {kVid, "_stats", "_tag:tag1:prop1:prop2", "_edge:+edge1:prop1:prop2", "_expr"};
+    DataSet ds2;
+    ds2.colNames = {kVid, "_stats", "_edge:-edge1:prop2:prop1", "_tag:tag1:prop2:prop1", "_expr"};
+    for (auto i = 0; i < 4; ++i) {
+        List tag({i, i + 100});
+        List edges;
+        for (auto j = 0; j < 3; ++j) {
+            edges.values.emplace_back(List({j, j + 100}));
+        }
+        ds1.rows.emplace_back(Row({folly::to<std::string>(i), Value(), tag, edges, Value()}));
+        ds2.rows.emplace_back(Row({folly::to<std::string>(i), Value(), edges, tag, Value()}));
+    }
+    List datasets;
+    datasets.values.emplace_back(std::move(ds1));
+    datasets.values.emplace_back(std::move(ds2));
+    auto neighbors = std::make_shared<Value>(std::move(datasets));
+
+    std::vector<Expression*> exprs = {
+        col(kVid),
+        TagPropertyExpression::make(&pool_, "tag1", "prop1"),
+        SourcePropertyExpression::make(&pool_, "tag1", "prop2"),
+        DestPropertyExpression::make(&pool_, "tag1", "prop1"),
+        TagPropertyExpression::make(&pool_, "tag1", "prop3"),
+        EdgePropertyExpression::make(&pool_, "edge1", "prop1"),
+        EdgePropertyExpression::make(&pool_, "*", "prop2"),
+        EdgePropertyExpression::make(&pool_, "edge2", "prop1"),
+    };
+    auto programs = CompiledExpression::compile(&pool_, exprs);
+    QueryExpressionContext ctx(nullptr);
+    size_t count = 0;
+    for (GetNeighborsIter iter(neighbors); iter.valid(); iter.next(), ++count) {
+        for (size_t i = 0; i < exprs.size(); ++i) {
+            EXPECT_EQ(programs[i]->eval(ctx(&iter)), Value(exprs[i]->eval(ctx(&iter))))
+                << exprs[i]->toString();
+        }
+    }
+    EXPECT_EQ(count, 24);
+
+    // Bound again for another iterator with different columns
+    auto program = CompiledExpression::compile(&pool_, col("c"));
+    SequentialIter iter(value_);
+    EXPECT_EQ(program->eval(ctx(&iter)), Value("name0"));
+    DataSet ds({"a", "c"});
+    ds.rows.emplace_back(Row({1, 2}));
+    SequentialIter otherIter(std::make_shared<Value>(std::move(ds)));
+    EXPECT_EQ(program->eval(ctx(&otherIter)), Value(2));
+    EXPECT_EQ(program->eval(ctx(nullptr)), Value::kEmpty);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -60,5 +60,57 @@ TEST(ExecutionContextTest, TestResult) {
     EXPECT_TRUE(result.valuePtr()->isDataSet());
 }
 
+TEST(ExecutionContext, MemoryTracking) {
+    auto query = std::make_shared<MemoryTracker>(nullptr);
+    auto executor = std::make_shared<MemoryTracker>(query);
+    {
+        ExecutionContext ctx;
+        ctx.setMemoryTracker(query);
+        DataSet ds({"a"});
+        for (int64_t i = 0; i < 100; ++i) {
+            ds.emplace_back(Row({Value(i)}));
+        }
+        ctx.setResult("v1", ResultBuilder().value(Value(std::move(ds))).finish(), executor);
+        auto used = executor->used();
+        EXPECT_GT(used, 0);
+        EXPECT_EQ(query->used(), used);
+
+        // The result sharing the value is accounted once
+        auto valuePtr = ctx.getResult("v1").valuePtr();
+        ctx.setResult("v2", ResultBuilder().value(valuePtr).finish());
+        EXPECT_EQ(query->used(), used);
+        ctx.dropResult("v1");
+        EXPECT_EQ(query->used(), used);
+        ctx.dropResult("v2");
+        EXPECT_EQ(query->used(), 0);
+
+        ctx.setValue("v3", "Hello world");
+        EXPECT_GT(query->used(), 0);
+        EXPECT_EQ(executor->used(), 0);
+    }
+    // Released with the context
+    EXPECT_EQ(query->used(), 0);
+    EXPECT_GT(executor->peak(), 0);
+}
+
+TEST(ExecutionContext, MemoryQuota) {
+    auto query = std::make_shared<MemoryTracker>(nullptr, 1024);
+    auto executor = std::make_shared<MemoryTracker>(query);
+    ExecutionContext ctx;
+    ctx.setMemoryTracker(query);
+    EXPECT_TRUE(ctx.setResult("small", ResultBuilder().value(Value(1)).finish(), executor).ok());
+
+    DataSet ds({"a"});
+    for (int64_t i = 0; i < 1000; ++i) {
+        ds.emplace_back(Row({Value(i)}));
+    }
+    auto status = ctx.setResult("large", ResultBuilder().value(Value(std::move(ds))).finish());
+    EXPECT_FALSE(status.ok());
+    // Set anyway, and released once dropped
+    EXPECT_TRUE(ctx.getResult("large").value().isDataSet());
+    ctx.dropResult("large");
+    EXPECT_TRUE(query->checkLimit().ok());
+}
+
 }   // namespace graph
 }   // namespace nebula
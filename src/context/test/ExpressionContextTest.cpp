@@ -26,5 +26,73 @@ TEST(ExpressionContextTest, GetVar) {
     EXPECT_EQ(Value(3.14), qECtx(nullptr).getVersionedVar("v1", -1));
     EXPECT_EQ(Value(10), qECtx(nullptr).getVersionedVar("v1", 1));
 }
+
+TEST(ExpressionContextTest, GetColumns) {
+    DataSet ds;
+    ds.colNames = {"a", "b", "c"};
+    for (auto i = 0; i < 10; ++i) {
+        ds.rows.emplace_back(Row({i, folly::to<std::string>(i), i * 2}));
+    }
+    SequentialIter iter(std::make_shared<Value>(std::move(ds)));
+    QueryExpressionContext ctx;
+    for (auto i = 0; iter.valid(); iter.next(), ++i) {
+        EXPECT_EQ(Value(i), ctx(&iter).getInputProp("a"));
+        EXPECT_EQ(Value(i * 2), ctx(&iter).getInputProp("c"));
+        EXPECT_EQ(Value(folly::to<std::string>(i)), ctx(&iter).getVarProp("v", "b"));
+        EXPECT_EQ(Value::kNullValue, ctx(&iter).getInputProp("d"));
+    }
+    EXPECT_EQ(Value::kNullValue, ctx(&iter).getInputProp("a"));
+
+    // Another iterator with different columns
+    DataSet other;
+    other.colNames = {"c", "a"};
+    other.rows.emplace_back(Row({1, 2}));
+    SequentialIter otherIter(std::make_shared<Value>(std::move(other)));
+    EXPECT_EQ(Value(2), ctx(&otherIter).getInputProp("a"));
+    EXPECT_EQ(Value(1), ctx(&otherIter).getInputProp("c"));
+}
+
+TEST(ExpressionContextTest, GetProps) {
+    // The props are in different orders in the datasets
+    DataSet ds1;
+    ds1.colNames = {kVid, "_stats", "_tag:tag1:prop1:prop2", "_edge:+edge1:prop1:prop2", "_expr"};
+    DataSet ds2;
+    ds2.colNames = {kVid, "_stats", "_edge:-edge1:prop2:prop1", "_tag:tag1:prop2:prop1", "_expr"};
+    for (auto i = 0; i < 4; ++i) {
+        List tag({i, i + 100});
+        List edges;
+        for (auto j = 0; j < 3; ++j) {
+            edges.values.emplace_back(List({j, j + 100}));
+        }
+        ds1.rows.emplace_back(Row({folly::to<std::string>(i), Value(), tag, edges, Value()}));
+        ds2.rows.emplace_back(Row({folly::to<std::string>(i), Value(), edges, tag, Value()}));
+    }
+    List datasets;
+    datasets.values.emplace_back(std::move(ds1));
+    datasets.values.emplace_back(std::move(ds2));
+    GetNeighborsIter iter(std::make_shared<Value>(std::move(datasets)));
+
+    QueryExpressionContext ctx;
+    size_t count = 0;
+    for (; iter.valid(); iter.next(), ++count) {
+        EXPECT_EQ(iter.getColumn(kVid), ctx(&iter).getInputProp(kVid));
+        EXPECT_EQ(iter.getTagProp("tag1", "prop1"), ctx(&iter).getTagProp("tag1", "prop1"));
+        EXPECT_EQ(iter.getTagProp("tag1", "prop2"), ctx(&iter).getSrcProp("tag1", "prop2"));
+        EXPECT_EQ(iter.getTagProp("tag1", "prop3"), ctx(&iter).getTagProp("tag1", "prop3"));
+        EXPECT_EQ(iter.getEdgeProp("edge1", "prop1"), ctx(&iter).getEdgeProp("edge1", "prop1"));
+        EXPECT_EQ(iter.getEdgeProp("*", "prop2"), ctx(&iter).getEdgeProp("*", "prop2"));
+        EXPECT_EQ(iter.getEdgeProp("edge2", "prop1"), ctx(&iter).getEdgeProp("edge2", "prop1"));
+    }
+    EXPECT_EQ(count, 24);
+
+    DataSet ds;
+    ds.colNames = {kVid, "tag1.prop1", "tag1.prop2"};
+    ds.rows.emplace_back(Row({"0", 1, 2}));
+    PropIter propIter(std::make_shared<Value>(std::move(ds)));
+    EXPECT_EQ(Value("0"), ctx(&propIter).getInputProp(kVid));
+    EXPECT_EQ(Value(2), ctx(&propIter).getTagProp("tag1", "prop2"));
+    EXPECT_EQ(Value::kNullValue, ctx(&propIter).getTagProp("tag1", "prop3"));
+    EXPECT_EQ(Value::kEmpty, ctx(&propIter).getTagProp("tag2", "prop1"));
+}
 }  // namespace graph
 }  // namespace nebula
@@ -859,17 +859,18 @@ TEST(IteratorTest, EraseBySwap) {
     EXPECT_EQ(iter.size(), 2);
 
 
+    // The sequential iterator marks the row erased, so the order is kept
     std::vector<Row> expected;
     {
         Row row;
-        row.values.emplace_back(2);
-        row.values.emplace_back("2");
+        row.values.emplace_back(1);
+        row.values.emplace_back("1");
         expected.emplace_back(std::move(row));
     }
     {
         Row row;
-        row.values.emplace_back(1);
-        row.values.emplace_back("1");
+        row.values.emplace_back(2);
+        row.values.emplace_back("2");
         expected.emplace_back(std::move(row));
     }
     std::vector<Row> result;
@@ -881,6 +882,143 @@ TEST(IteratorTest, EraseBySwap) {
     }
     EXPECT_EQ(result, expected);
 }
+
+TEST(IteratorTest, EraseBySelection) {
+    DataSet ds({"col1"});
+    for (auto i = 0; i < 10; ++i) {
+        ds.rows.emplace_back(Row({i}));
+    }
+    auto val = std::make_shared<Value>(std::move(ds));
+    auto& rows = val->getDataSet().rows;
+    {
+        SequentialIter iter(val);
+        while (iter.valid()) {
+            if (iter.getColumn("col1").getInt() % 3 == 0) {
+                iter.erase();
+            } else {
+                iter.next();
+            }
+        }
+        // Only marked erased
+        EXPECT_EQ(iter.size(), 6);
+        EXPECT_EQ(rows.size(), 10);
+
+        // Compacted before the rows are accessed directly
+        std::vector<int64_t> live;
+        for (auto it = iter.begin(); it != iter.end(); ++it) {
+            live.emplace_back((*it)[0].getInt());
+        }
+        EXPECT_EQ(live, std::vector<int64_t>({1, 2, 4, 5, 7, 8}));
+        EXPECT_EQ(rows.size(), 6);
+    }
+    {
+        SequentialIter iter(val);
+        iter.next();
+        iter.erase();
+        iter.erase();
+        // The copy skips the rows erased by the original, which are not removed yet
+        auto copy = iter.copy();
+        EXPECT_EQ(copy->size(), 4);
+        EXPECT_EQ(copy->getColumn("col1"), 1);
+        EXPECT_EQ(rows.size(), 6);
+        // The original keeps its position
+        ASSERT_TRUE(iter.valid());
+        EXPECT_EQ(iter.getColumn("col1"), 5);
+        iter.erase();
+        // Reset to the rows not erased
+        iter.reset(1);
+        EXPECT_EQ(iter.getColumn("col1"), 7);
+        EXPECT_EQ(rows.size(), 6);
+
+        iter.compact();
+        EXPECT_EQ(iter.getColumn("col1"), 7);
+    }
+    // Removed only by the explicit compaction
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(rows[0][0], 1);
+    EXPECT_EQ(rows[1][0], 7);
+    EXPECT_EQ(rows[2][0], 8);
+}
+
+TEST(IteratorTest, CopySharesSelection) {
+    DataSet ds({"col1"});
+    for (auto i = 0; i < 10; ++i) {
+        ds.rows.emplace_back(Row({i}));
+    }
+    auto val = std::make_shared<Value>(std::move(ds));
+    SequentialIter iter(val);
+    while (iter.valid()) {
+        if (iter.getColumn("col1").getInt() % 3 == 0) {
+            iter.erase();
+        } else {
+            iter.next();
+        }
+    }
+    auto copy = iter.copy();
+    ASSERT_EQ(copy->size(), 6);
+    std::vector<int64_t> expected = {1, 2, 4, 5, 7, 8};
+    for (size_t pos = 0; pos < expected.size(); ++pos) {
+        copy->reset(pos);
+        EXPECT_EQ(copy->getColumn("col1"), expected[pos]);
+    }
+
+    // The rows erased by the original after copying are skipped by the copy
+    iter.reset(2);
+    iter.erase();
+    EXPECT_EQ(copy->size(), 5);
+    copy->reset(2);
+    EXPECT_EQ(copy->getColumn("col1"), 5);
+
+    // The selection of the copy is not stale after the original compacts the rows
+    iter.compact();
+    EXPECT_EQ(val->getDataSet().rows.size(), 5);
+    EXPECT_EQ(copy->size(), 5);
+    expected = {1, 2, 5, 7, 8};
+    for (size_t pos = 0; pos < expected.size(); ++pos) {
+        copy->reset(pos);
+        EXPECT_EQ(copy->getColumn("col1"), expected[pos]);
+    }
+}
+
+TEST(IteratorTest, CopySharesIndex) {
+    {
+        DataSet ds({kVid, "tag1.prop1"});
+        for (auto i = 0; i < 4; ++i) {
+            ds.rows.emplace_back(Row({folly::to<std::string>(i), i}));
+        }
+        PropIter iter(std::make_shared<Value>(std::move(ds)));
+        auto copy = iter.copy();
+        EXPECT_EQ(&iter.getColIndices(), &static_cast<PropIter*>(copy.get())->getColIndices());
+        copy->next();
+        EXPECT_EQ(Value(0), iter.getProp("tag1", "prop1"));
+        EXPECT_EQ(Value(1), copy->getTagProp("tag1", "prop1"));
+    }
+    {
+        DataSet ds;
+        ds.colNames = {kVid, "_stats", "_tag:tag1:prop1", "_edge:+edge1:prop1", "_expr"};
+        for (auto i = 0; i < 4; ++i) {
+            List edges;
+            edges.values.emplace_back(List({i}));
+            ds.rows.emplace_back(Row({folly::to<std::string>(i), Value(), List({i}), edges,
+                                      Value()}));
+        }
+        List datasets;
+        datasets.values.emplace_back(std::move(ds));
+        GetNeighborsIter iter(std::make_shared<Value>(std::move(datasets)));
+        auto copy = iter.copy();
+        // The selection is owned by each copy
+        copy->erase();
+        for (auto i = 0; iter.valid(); iter.next(), ++i) {
+            EXPECT_EQ(Value(i), iter.getEdgeProp("edge1", "prop1"));
+            EXPECT_EQ(Value(i), iter.getTagProp("tag1", "prop1"));
+        }
+        std::vector<Value> props;
+        for (; copy->valid(); copy->next()) {
+            props.emplace_back(copy->getEdgeProp("edge1", "prop1"));
+        }
+        EXPECT_EQ(props, std::vector<Value>({1, 2, 3}));
+    }
+}
 }  // namespace graph
 }  // namespace nebula
 
@@ -0,0 +1,258 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "context/StorageCoalescer.h"
+
+using nebula::storage::StorageRpcResponse;
+using nebula::storage::cpp2::EdgeDirection;
+using nebula::storage::cpp2::EdgeProp;
+using nebula::storage::cpp2::Expr;
+using nebula::storage::cpp2::GetNeighborsResponse;
+using nebula::storage::cpp2::GetPropResponse;
+using nebula::storage::cpp2::OrderBy;
+using nebula::storage::cpp2::StatProp;
+using nebula::storage::cpp2::VertexProp;
+
+namespace nebula {
+namespace graph {
+
+// The storage of two parts, the even vids are in part 1 and the odd ones in part 2. Each
+// vid has one row of its name.
+class FakeStorage final : public StorageCoalescer::Storage {
+public:
+    StorageCoalescer::RpcFuture<GetNeighborsResponse> getNeighbors(
+        GraphSpaceID,
+        std::vector<std::string>,
+        std::vector<Row> vertices,
+        const std::vector<EdgeType>&,
+        EdgeDirection,
+        const std::vector<StatProp>*,
+        const std::vector<VertexProp>*,
+        const std::vector<EdgeProp>*,
+        const std::vector<Expr>*,
+        bool,
+        bool,
+        const std::vector<OrderBy>&,
+        int64_t,
+        const std::string&) override {
+        return respond<GetNeighborsResponse>(std::move(vertices));
+    }
+
+    StorageCoalescer::RpcFuture<GetPropResponse> getProps(GraphSpaceID,
+                                                          DataSet input,
+                                                          const std::vector<VertexProp>*,
+                                                          const std::vector<EdgeProp>*,
+                                                          const std::vector<Expr>*,
+                                                          bool,
+                                                          const std::vector<OrderBy>&,
+                                                          int64_t,
+                                                          const std::string&) override {
+        return respond<GetPropResponse>(std::move(input.rows));
+    }
+
+    StatusOr<PartitionID> partId(GraphSpaceID, const Value& vid) const override {
+        return vid.getInt() % 2 + 1;
+    }
+
+    std::vector<std::vector<Row>> requests() {
+        std::lock_guard<std::mutex> guard(lock_);
+        return requests_;
+    }
+
+    void fail() {
+        fail_ = true;
+    }
+
+    void failPart(PartitionID part) {
+        failedParts_.emplace(part, nebula::cpp2::ErrorCode::E_RPC_FAILURE);
+    }
+
+private:
+    static void setDataset(GetNeighborsResponse& resp, DataSet ds) {
+        resp.vertices_ref() = std::move(ds);
+    }
+
+    static void setDataset(GetPropResponse& resp, DataSet ds) {
+        resp.props_ref() = std::move(ds);
+    }
+
+    template <typename Resp>
+    StorageCoalescer::RpcFuture<Resp> respond(std::vector<Row> vertices) {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            requests_.emplace_back(vertices);
+        }
+        if (fail_) {
+            return folly::makeSemiFuture<StorageRpcResponse<Resp>>(
+                std::runtime_error("Storage is down"));
+        }
+        // One response of each part
+        StorageRpcResponse<Resp> resp(2);
+        for (PartitionID part = 1; part <= 2; ++part) {
+            if (failedParts_.count(part) != 0) {
+                resp.markFailure();
+                resp.failedParts().emplace(part, failedParts_.at(part));
+                continue;
+            }
+            DataSet ds({"_vid", "name"});
+            for (auto& row : vertices) {
+                auto& vid = row.values.front();
+                if (partId(0, vid).value() == part) {
+                    ds.rows.emplace_back(Row({vid, folly::to<std::string>("v", vid.getInt())}));
+                }
+            }
+            Resp r;
+            setDataset(r, std::move(ds));
+            resp.responses().emplace_back(std::move(r));
+        }
+        return folly::makeSemiFuture(std::move(resp));
+    }
+
+    std::mutex                                                  lock_;
+    std::vector<std::vector<Row>>                               requests_;
+    bool                                                        fail_{false};
+    std::unordered_map<PartitionID, nebula::cpp2::ErrorCode>    failedParts_;
+};
+
+class StorageCoalescerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ioExecutor_ = std::make_shared<folly::IOThreadPoolExecutor>(1);
+        auto storage = std::make_unique<FakeStorage>();
+        storage_ = storage.get();
+        coalescer_ = std::make_unique<StorageCoalescer>(std::move(storage), ioExecutor_, 100);
+    }
+
+    StorageCoalescer::RpcFuture<GetPropResponse> getProps(std::vector<int64_t> vids,
+                                                         const std::string& filter = "") {
+        DataSet input({"_vid"});
+        for (auto vid : vids) {
+            input.rows.emplace_back(Row({vid}));
+        }
+        return coalescer_->getProps(1,
+                                    std::move(input),
+                                    nullptr,
+                                    nullptr,
+                                    nullptr,
+                                    false,
+                                    {},
+                                    std::numeric_limits<int64_t>::max(),
+                                    filter);
+    }
+
+    // The vids of rows in all responses, in order
+    static std::vector<Value> vidsOf(StorageRpcResponse<GetPropResponse>& resp) {
+        std::vector<Value> vids;
+        for (auto& r : resp.responses()) {
+            for (auto& row : r.props_ref()->rows) {
+                vids.emplace_back(row.values.front());
+            }
+        }
+        return vids;
+    }
+
+    std::shared_ptr<folly::IOThreadPoolExecutor>    ioExecutor_;
+    FakeStorage*                                    storage_{nullptr};
+    std::unique_ptr<StorageCoalescer>               coalescer_;
+};
+
+TEST_F(StorageCoalescerTest, MergeAndSplit) {
+    auto f1 = getProps({3, 1});
+    auto f2 = getProps({1, 2});
+    auto r1 = std::move(f1).get();
+    auto r2 = std::move(f2).get();
+
+    // Sent once, the vid asked by both is deduplicated
+    auto requests = storage_->requests();
+    ASSERT_EQ(requests.size(), 1);
+    std::vector<Row> expected = {Row({3}), Row({1}), Row({2})};
+    EXPECT_EQ(requests.front(), expected);
+
+    // Each one gets the rows of its own vids, in the order of its request in each part
+    EXPECT_EQ(vidsOf(r1), std::vector<Value>({3, 1}));
+    EXPECT_EQ(vidsOf(r2), std::vector<Value>({2, 1}));
+    EXPECT_EQ(r2.responses().front().props_ref()->rows.front(), Row({2, "v2"}));
+    EXPECT_EQ(r1.completeness(), 100);
+    EXPECT_EQ(r2.completeness(), 100);
+}
+
+TEST_F(StorageCoalescerTest, NotMergeIncompatible) {
+    auto f1 = getProps({1});
+    auto f2 = getProps({1}, "filter");
+    auto r1 = std::move(f1).get();
+    auto r2 = std::move(f2).get();
+    EXPECT_EQ(vidsOf(r1), std::vector<Value>({1}));
+    EXPECT_EQ(vidsOf(r2), std::vector<Value>({1}));
+    EXPECT_EQ(storage_->requests().size(), 2);
+
+    // Sent alone at once
+    std::vector<Row> vertices = {Row({1}), Row({2})};
+    auto resp = coalescer_->getNeighbors(1,
+                                         {"_vid"},
+                                         vertices,
+                                         {1},
+                                         EdgeDirection::OUT_EDGE,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr,
+                                         false,
+                                         false,
+                                         {},
+                                         10,
+                                         "")
+                    .get();
+    EXPECT_EQ(resp.responses().size(), 2);
+    EXPECT_EQ(storage_->requests().size(), 3);
+}
+
+TEST_F(StorageCoalescerTest, FlushFullBatch) {
+    coalescer_ = std::make_unique<StorageCoalescer>(
+        std::make_unique<FakeStorage>(), ioExecutor_, 3600 * 1000);
+    std::vector<int64_t> vids(4096);
+    std::iota(vids.begin(), vids.end(), 0);
+    // Sent before the window of an hour ends
+    auto future = getProps(std::move(vids));
+    future.wait(std::chrono::seconds(10));
+    ASSERT_TRUE(future.isReady());
+    auto resp = std::move(future).value();
+    EXPECT_EQ(vidsOf(resp).size(), 4096);
+}
+
+TEST_F(StorageCoalescerTest, ExceptionFanOut) {
+    storage_->fail();
+    auto f1 = getProps({1});
+    auto f2 = getProps({2});
+    EXPECT_THROW(std::move(f1).get(), std::runtime_error);
+    EXPECT_THROW(std::move(f2).get(), std::runtime_error);
+    EXPECT_EQ(storage_->requests().size(), 1);
+}
+
+TEST_F(StorageCoalescerTest, FailedParts) {
+    storage_->failPart(1);
+    auto f1 = getProps({1, 3});
+    auto f2 = getProps({1, 2});
+    auto r1 = std::move(f1).get();
+    auto r2 = std::move(f2).get();
+    EXPECT_EQ(storage_->requests().size(), 1);
+
+    // None of its vids is in the failed part
+    EXPECT_EQ(vidsOf(r1), std::vector<Value>({1, 3}));
+    EXPECT_EQ(r1.completeness(), 100);
+    EXPECT_TRUE(r1.failedParts().empty());
+
+    EXPECT_EQ(vidsOf(r2), std::vector<Value>({1}));
+    EXPECT_EQ(r2.completeness(), 50);
+    ASSERT_EQ(r2.failedParts().size(), 1);
+    EXPECT_EQ(r2.failedParts().begin()->first, 1);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,152 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "context/VertexCache.h"
+
+namespace nebula {
+namespace graph {
+
+static VertexCache::ColNames colNames() {
+    return std::make_shared<const std::vector<std::string>>(
+        std::vector<std::string>{"_vid", "player.name"});
+}
+
+TEST(VertexCacheTest, GetAndPut) {
+    VertexCache cache(100, 0, 0, {"nba"});
+    EXPECT_TRUE(cache.enabled("nba"));
+    EXPECT_FALSE(cache.enabled("test"));
+
+    Row row;
+    VertexCache::ColNames names;
+    EXPECT_FALSE(cache.get(1, "Tim", "shape", &row, &names));
+    cache.put(1, "Tim", "shape", Row({"Tim", "Tim Duncan"}), colNames(), cache.epoch());
+    ASSERT_TRUE(cache.get(1, "Tim", "shape", &row, &names));
+    EXPECT_EQ(row, Row({"Tim", "Tim Duncan"}));
+    EXPECT_EQ(*names, *colNames());
+    // Different space or shape
+    EXPECT_FALSE(cache.get(2, "Tim", "shape", &row, &names));
+    EXPECT_FALSE(cache.get(1, "Tim", "other", &row, &names));
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 3);
+    EXPECT_GT(cache.bytes(), 0);
+
+    // Overwrite
+    cache.put(1, "Tim", "shape", Row({"Tim", "Duncan"}), colNames(), cache.epoch());
+    ASSERT_TRUE(cache.get(1, "Tim", "shape", &row, &names));
+    EXPECT_EQ(row, Row({"Tim", "Duncan"}));
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(VertexCacheTest, Invalidate) {
+    VertexCache cache(100, 0, 0, {"nba"});
+    cache.put(1, "Tim", "shape", Row({"Tim", "Tim Duncan"}), colNames(), cache.epoch());
+    cache.put(1, "Tim", "other", Row({"Tim"}), colNames(), cache.epoch());
+    cache.put(1, "Tony", "shape", Row({"Tony", "Tony Parker"}), colNames(), cache.epoch());
+    cache.invalidate(1, "Tim");
+
+    Row row;
+    VertexCache::ColNames names;
+    EXPECT_FALSE(cache.get(1, "Tim", "shape", &row, &names));
+    EXPECT_FALSE(cache.get(1, "Tim", "other", &row, &names));
+    EXPECT_TRUE(cache.get(1, "Tony", "shape", &row, &names));
+    cache.invalidate(1, "Tony");
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.bytes(), 0);
+}
+
+TEST(VertexCacheTest, StalePut) {
+    VertexCache cache(100, 0, 0, {"nba"}, 1);
+    // Fetched before the vertex is changed and arrived after the invalidation
+    auto epoch = cache.epoch();
+    cache.invalidate(1, "Tim");
+    cache.put(1, "Tim", "shape", Row({"Tim", "Tim Duncan"}), colNames(), epoch);
+    Row row;
+    VertexCache::ColNames names;
+    EXPECT_FALSE(cache.get(1, "Tim", "shape", &row, &names));
+    EXPECT_EQ(cache.size(), 0u);
+
+    // Fetched after the invalidation
+    cache.put(1, "Tim", "shape", Row({"Tim", "Tim Duncan"}), colNames(), cache.epoch());
+    EXPECT_TRUE(cache.get(1, "Tim", "shape", &row, &names));
+}
+
+TEST(VertexCacheTest, Evict) {
+    // One shard of two vertices
+    VertexCache cache(2, 0, 0, {"nba"}, 1);
+    cache.put(1, 1, "shape", Row({1}), colNames(), cache.epoch());
+    cache.put(1, 2, "shape", Row({2}), colNames(), cache.epoch());
+
+    Row row;
+    VertexCache::ColNames names;
+    // 1 is more recently used than 2
+    EXPECT_TRUE(cache.get(1, 1, "shape", &row, &names));
+    cache.put(1, 3, "shape", Row({3}), colNames(), cache.epoch());
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.get(1, 1, "shape", &row, &names));
+    EXPECT_FALSE(cache.get(1, 2, "shape", &row, &names));
+    EXPECT_TRUE(cache.get(1, 3, "shape", &row, &names));
+}
+
+TEST(VertexCacheTest, EvictByBytes) {
+    // One shard without the limit of number
+    VertexCache cache(0, 1, 0, {"nba"}, 1);
+    cache.put(1, 1, "shape", Row({1}), colNames(), cache.epoch());
+    cache.put(1, 2, "shape", Row({2}), colNames(), cache.epoch());
+
+    Row row;
+    VertexCache::ColNames names;
+    // The most recent one is kept even exceeding the bytes
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_FALSE(cache.get(1, 1, "shape", &row, &names));
+    EXPECT_TRUE(cache.get(1, 2, "shape", &row, &names));
+
+    VertexCache unlimited(0, 0, 0, {"nba"}, 1);
+    for (int64_t i = 0; i < 100; ++i) {
+        unlimited.put(1, i, "shape", Row({i}), colNames(), unlimited.epoch());
+    }
+    EXPECT_EQ(unlimited.size(), 100u);
+}
+
+TEST(VertexCacheTest, Shape) {
+    std::vector<storage::cpp2::VertexProp> props(1);
+    props[0].set_tag(1);
+    props[0].set_props({"name"});
+    auto shape = VertexCache::shapeOf(&props, nullptr);
+    EXPECT_EQ(shape, VertexCache::shapeOf(&props, nullptr));
+    EXPECT_NE(shape, VertexCache::shapeOf(nullptr, nullptr));
+
+    props[0].set_props({"name", "age"});
+    EXPECT_NE(shape, VertexCache::shapeOf(&props, nullptr));
+}
+
+TEST(VertexCacheTest, NeighborShape) {
+    auto shapeOf = [](const std::vector<EdgeType>& edgeTypes,
+                      storage::cpp2::EdgeDirection direction,
+                      const std::vector<storage::cpp2::EdgeProp>* edgeProps,
+                      bool dedup) {
+        return VertexCache::shapeOf(
+            edgeTypes, direction, nullptr, nullptr, edgeProps, nullptr, dedup, "");
+    };
+    auto out = storage::cpp2::EdgeDirection::OUT_EDGE;
+    auto shape = shapeOf({1, 2}, out, nullptr, false);
+    EXPECT_EQ(shape, shapeOf({1, 2}, out, nullptr, false));
+    EXPECT_NE(shape, shapeOf({1}, out, nullptr, false));
+    EXPECT_NE(shape, shapeOf({1, 2}, storage::cpp2::EdgeDirection::BOTH, nullptr, false));
+    EXPECT_NE(shape, shapeOf({1, 2}, out, nullptr, true));
+
+    std::vector<storage::cpp2::EdgeProp> edgeProps(1);
+    edgeProps[0].set_type(1);
+    edgeProps[0].set_props({"start_year"});
+    EXPECT_NE(shape, shapeOf({1, 2}, out, &edgeProps, false));
+    // The neighbors and the properties of vertices are never mixed up
+    EXPECT_NE(VertexCache::shapeOf({}, out, nullptr, nullptr, nullptr, nullptr, false, ""),
+              VertexCache::shapeOf(nullptr, nullptr));
+}
+
+}   // namespace graph
+}   // namespace nebula
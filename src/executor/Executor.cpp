@@ -9,7 +9,6 @@
 #include <folly/String.h>
 #include <folly/executors/InlineExecutor.h>
 
-#include "common/base/Memory.h"
 #include "common/base/ObjectPool.h"
 #include "common/interface/gen-cpp2/graph_types.h"
 #include "context/ExecutionContext.h"
@@ -81,6 +80,7 @@
 #include "executor/query/LeftJoinExecutor.h"
 #include "executor/query/LimitExecutor.h"
 #include "executor/query/MinusExecutor.h"
+#include "executor/query/PipelineExecutor.h"
 #include "executor/query/ProjectExecutor.h"
 #include "executor/query/SortExecutor.h"
 #include "executor/query/TopNExecutor.h"
@@ -120,6 +120,16 @@ Executor *Executor::makeExecutor(const PlanNode *node,
         return iter->second;
     }
 
+    auto chain = PipelineExecutor::collectChain(node);
+    if (!chain.empty()) {
+        auto pipeline = qctx->objPool()->add(new PipelineExecutor(chain, qctx));
+        pipeline->dependsOn(makeExecutor(chain.front()->dep(), qctx, visited));
+        for (auto *fused : chain) {
+            visited->insert({fused->id(), pipeline});
+        }
+        return pipeline;
+    }
+
     Executor *exec = makeExecutor(qctx, node);
 
     if (node->kind() == PlanNode::Kind::kSelect) {
@@ -524,7 +534,8 @@ Executor::Executor(const std::string &name, const PlanNode *node, QueryContext *
       name_(name),
       node_(DCHECK_NOTNULL(node)),
       qctx_(DCHECK_NOTNULL(qctx)),
-      ectx_(DCHECK_NOTNULL(qctx->ectx())) {
+      ectx_(DCHECK_NOTNULL(qctx->ectx())),
+      memTracker_(std::make_shared<MemoryTracker>(qctx->memoryTracker())) {
     // Initialize the position in ExecutionContext for each executor before execution plan
     // starting to run. This will avoid lock something for thread safety in real execution
     if (!ectx_->exist(node->outputVar())) {
@@ -541,15 +552,11 @@ Status Executor::open() {
             << "query: " << qctx()->rctx()->query();
         return Status::Error("Execution had been killed");
     }
-    auto status = MemInfo::make();
-    NG_RETURN_IF_ERROR(status);
-    auto mem = std::move(status).value();
-    if (node_->isQueryNode() && mem->hitsHighWatermark(FLAGS_system_memory_high_watermark_ratio)) {
-        return Status::Error(
-            "Used memory(%ldKB) hits the high watermark(%lf) of total system memory(%ldKB).",
-            mem->usedInKB(),
-            FLAGS_system_memory_high_watermark_ratio,
-            mem->totalInKB());
+    if (node_->isQueryNode()) {
+        // The system memory is sampled in background
+        NG_RETURN_IF_ERROR(
+            MemoryTracker::checkSystemMemory(FLAGS_system_memory_high_watermark_ratio));
+        NG_RETURN_IF_ERROR(memTracker_->checkLimit());
     }
     numRows_ = 0;
     execTime_ = 0;
@@ -562,6 +569,13 @@ Status Executor::close() {
     stats.totalDurationInUs = totalDuration_.elapsedInUSec();
     stats.rows = numRows_;
     stats.execDurationInUs = execTime_;
+    if (memTracker_->peak() > 0) {
+        // The query peak reported by the last executor, i.e. the root, is the peak of query
+        otherStats_.emplace("peak memory",
+                            folly::stringPrintf("%ld bytes, query: %ld bytes",
+                                                memTracker_->peak(),
+                                                memTracker_->parent()->peak()));
+    }
     if (!otherStats_.empty()) {
         stats.otherStats =
             std::make_unique<std::unordered_map<std::string, std::string>>(std::move(otherStats_));
@@ -579,9 +593,13 @@ folly::Future<Status> Executor::error(Status status) const {
 }
 
 void Executor::drop() {
-    for (const auto &inputVar : node()->inputVars()) {
+    drop(node());
+}
+
+void Executor::drop(const PlanNode *node) {
+    for (const auto &inputVar : node->inputVars()) {
         if (inputVar != nullptr) {
-            if (inputVar->lastUser.value() == node()->id()) {
+            if (inputVar->lastUser.value() == node->id()) {
                     ectx_->dropResult(inputVar->name);
             }
         }
@@ -589,20 +607,53 @@ void Executor::drop() {
 }
 
 Status Executor::finish(Result &&result) {
-    if (!FLAGS_enable_lifetime_optimize || node()->outputVarPtr()->lastUser.hasValue()) {
-        numRows_ = result.size();
-        ectx_->setResult(node()->outputVar(), std::move(result));
-    }
+    // Fail the query as soon as a result exceeds the quota, instead of when the next
+    // executor opens
+    NG_RETURN_IF_ERROR(setOutput(std::move(result)));
     if (FLAGS_enable_lifetime_optimize) {
         drop();
     }
     return Status::OK();
 }
 
+Status Executor::setOutput(Result &&result) {
+    if (!FLAGS_enable_lifetime_optimize || node()->outputVarPtr()->lastUser.hasValue()) {
+        numRows_ = result.size();
+        return ectx_->setResult(node()->outputVar(), std::move(result), memTracker_);
+    }
+    return Status::OK();
+}
+
 Status Executor::finish(Value &&value) {
     return finish(ResultBuilder().value(std::move(value)).iter(Iterator::Kind::kDefault).finish());
 }
 
+bool Executor::shouldRunInParallel(size_t size) const {
+    return maxNumWorkers() > 1 && size > morselSize();
+}
+
+size_t Executor::maxNumWorkers() const {
+    return std::max(FLAGS_max_query_parallelism, 1U);
+}
+
+size_t Executor::morselSize() const {
+    return std::max(FLAGS_morsel_size, 1U);
+}
+
+size_t Executor::reserveWorkers(size_t numMorsels) const {
+    if (numMorsels <= 1) {
+        return 0;
+    }
+    auto limit = maxNumWorkers() - 1;
+    return qctx_->reserveWorkers(std::min(numMorsels - 1, limit), limit);
+}
+
+void Executor::releaseWorkers(size_t num) const {
+    if (num > 0) {
+        qctx_->releaseWorkers(num);
+    }
+}
+
 folly::Executor *Executor::runner() const {
     if (!qctx() || !qctx()->rctx() || !qctx()->rctx()->runner()) {
         // This is just for test
@@ -7,6 +7,7 @@
 #ifndef EXECUTOR_EXECUTOR_H_
 #define EXECUTOR_EXECUTOR_H_
 
+#include <atomic>
 #include <set>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@
 #include "common/datatypes/Value.h"
 #include "common/time/Duration.h"
 #include "context/ExecutionContext.h"
+#include "util/MemoryTracker.h"
 #include "util/ScopedTimer.h"
 
 namespace nebula {
@@ -97,10 +99,32 @@ protected:
 
     folly::Executor *runner() const;
 
+    // Whether the input of `size' rows is large enough to be split into morsels
+    bool shouldRunInParallel(size_t size) const;
+
+    // Max number of workers processing the morsels of one executor
+    size_t maxNumWorkers() const;
+
+    // Split the rows in [0, size) into morsels of `morsel' rows, or `morsel_size' rows
+    // if it's 0, and process them by `func' on the runner.
+    // `func(worker, begin, end)' returns the result of the morsel [begin, end), `worker' is
+    // in [0, maxNumWorkers()) and never used by two calls at the same time, so it could
+    // index the per-worker states, e.g. the copies of the expressions and the iterator.
+    // Besides the worker of executor itself, the extra ones are reserved within the
+    // parallelism limit of the query. The results are ordered by the morsels.
+    template <typename Func>
+    auto runMorsels(size_t size, Func &&func, size_t morsel = 0)
+        -> folly::Future<std::vector<decltype(func(size_t(0), size_t(0), size_t(0)))>>;
+
     void drop();
 
+    // Drop the inputs whose last user is `node'
+    void drop(const PlanNode *node);
+
     // Store the result of this executor to execution context
     Status finish(Result &&result);
+    // Store the result only, for the executors which have dropped their inputs early
+    Status setOutput(Result &&result);
     // Store the default result which not used for later executor
     Status finish(Value &&value);
 
@@ -125,8 +149,56 @@ protected:
     uint64_t execTime_{0};
     time::Duration totalDuration_;
     std::unordered_map<std::string, std::string> otherStats_;
+
+    // Account the memory of results produced by this executor
+    std::shared_ptr<MemoryTracker> memTracker_;
+
+private:
+    size_t morselSize() const;
+
+    // Reserve the extra workers for `numMorsels' morsels
+    size_t reserveWorkers(size_t numMorsels) const;
+
+    void releaseWorkers(size_t num) const;
 };
 
+template <typename Func>
+auto Executor::runMorsels(size_t size, Func &&func, size_t morsel)
+    -> folly::Future<std::vector<decltype(func(size_t(0), size_t(0), size_t(0)))>> {
+    using Result = decltype(func(size_t(0), size_t(0), size_t(0)));
+    struct State {
+        State(Func &&f, size_t numMorsels) : func(std::forward<Func>(f)), results(numMorsels) {}
+
+        std::decay_t<Func>          func;
+        std::atomic<size_t>         next{0};
+        std::vector<Result>         results;
+    };
+
+    if (morsel == 0) {
+        morsel = morselSize();
+    }
+    const size_t numMorsels = (size + morsel - 1) / morsel;
+    auto state = std::make_shared<State>(std::forward<Func>(func), numMorsels);
+    auto work = [state, size, morsel, numMorsels](size_t worker) {
+        // Each worker takes the next morsel once finishing the current one
+        for (auto i = state->next++; i < numMorsels; i = state->next++) {
+            auto begin = i * morsel;
+            state->results[i] = state->func(worker, begin, std::min(begin + morsel, size));
+        }
+    };
+
+    auto extra = reserveWorkers(numMorsels);
+    std::vector<folly::Future<folly::Unit>> futures;
+    futures.reserve(extra + 1);
+    for (size_t worker = 0; worker <= extra; ++worker) {
+        futures.emplace_back(folly::via(runner(), [work, worker]() { work(worker); }));
+    }
+    return folly::collect(futures)
+        .via(runner())
+        .ensure([this, extra]() { releaseWorkers(extra); })
+        .thenValue([state](auto &&) { return std::move(state->results); });
+}
+
 }   // namespace graph
 }   // namespace nebula
 
@@ -65,6 +65,29 @@ DataSet buildRequestDataSet(const SpaceInfo &space,
 
 }   // namespace internal
 
+void StorageAccessExecutor::addMovedBytes(int64_t bytes) {
+    movedBytes_ += bytes;
+    otherStats_["moved response bytes"] = folly::stringPrintf("%ld", movedBytes_);
+}
+
+void StorageAccessExecutor::addHostStats(const HostAddr &host,
+                                         int32_t execUs,
+                                         int32_t totalUs,
+                                         size_t rows) {
+    auto &stats = hostStats_[host];
+    stats.execUs += execUs;
+    stats.totalUs += totalUs;
+    stats.rows += rows;
+    stats.numResps += 1;
+    auto value =
+        folly::stringPrintf("%ld(us)/%ld(us)/%lu", stats.execUs, stats.totalUs, stats.rows);
+    if (stats.numResps > 1) {
+        value += folly::stringPrintf(" in %lu responses", stats.numResps);
+    }
+    otherStats_[folly::stringPrintf("%s exec/total/rows", host.toString().c_str())] =
+        std::move(value);
+}
+
 bool StorageAccessExecutor::isIntVidType(const SpaceInfo &space) const {
     return (*space.spaceDesc.vid_type_ref()).type == meta::cpp2::PropertyType::INT64;
 }
@@ -81,5 +104,46 @@ DataSet StorageAccessExecutor::buildRequestDataSetByVidType(Iterator *iter,
     return internal::buildRequestDataSet<std::string>(space, exprCtx, iter, expr, dedup);
 }
 
+std::vector<DataSet> StorageAccessExecutor::splitByParts(GraphSpaceID space,
+                                                         DataSet &&vertices,
+                                                         size_t chunkSize) const {
+    auto numParts = qctx()->getMetaClient()->partsNum(space);
+    if (!numParts.ok() || numParts.value() <= 1) {
+        return splitRows(std::move(vertices), chunkSize, nullptr);
+    }
+    auto *metaClient = qctx()->getMetaClient();
+    auto n = numParts.value();
+    return splitRows(std::move(vertices), chunkSize, [metaClient, n](const Value &vid) {
+        return SchemaUtil::partId(metaClient, n, vid);
+    });
+}
+
+// static
+std::vector<DataSet> StorageAccessExecutor::splitRows(
+    DataSet &&rows,
+    size_t chunkSize,
+    std::function<PartitionID(const Value &)> partOf) {
+    std::vector<DataSet> requests;
+    if (partOf == nullptr && (chunkSize == 0 || rows.rows.size() <= chunkSize)) {
+        requests.emplace_back(std::move(rows));
+        return requests;
+    }
+    // The index of the request being filled of each partition
+    std::unordered_map<PartitionID, size_t> indexes;
+    for (auto &row : rows.rows) {
+        PartitionID part = partOf == nullptr ? 0 : partOf(row.values.front());
+        auto found = indexes.emplace(part, requests.size());
+        if (!found.second && chunkSize > 0 &&
+            requests[found.first->second].rows.size() >= chunkSize) {
+            found.first->second = requests.size();
+        }
+        if (found.first->second == requests.size()) {
+            requests.emplace_back(rows.colNames);
+        }
+        requests[found.first->second].rows.emplace_back(std::move(row));
+    }
+    return requests;
+}
+
 }   // namespace graph
 }   // namespace nebula
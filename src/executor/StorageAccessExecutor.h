@@ -7,10 +7,13 @@
 #ifndef EXECUTOR_STORAGEACCESSEXECUTOR_H_
 #define EXECUTOR_STORAGEACCESSEXECUTOR_H_
 
+#include <folly/futures/Future.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include "common/clients/storage/StorageClientBase.h"
+#include "common/interface/gen-cpp2/storage_types.h"
 #include "context/QueryContext.h"
 #include "executor/Executor.h"
+#include "util/MemoryTracker.h"
 
 namespace nebula {
 
@@ -125,20 +128,125 @@ protected:
         return Status::OK();
     }
 
+    // Add the latencies and the rows of each host, summed up over the calls since a host
+    // answers several requests when they are split by partitions
     template<typename RESP>
-    void addStats(RESP& resp, std::unordered_map<std::string, std::string>& stats) const {
+    void addStats(RESP& resp) {
         auto& hostLatency = resp.hostLatency();
         for (size_t i = 0; i < hostLatency.size(); ++i) {
             auto& info = hostLatency[i];
-            stats.emplace(
-                folly::stringPrintf("%s exec/total", std::get<0>(info).toString().c_str()),
-                folly::stringPrintf("%d(us)/%d(us)", std::get<1>(info), std::get<2>(info)));
+            addHostStats(std::get<0>(info),
+                         std::get<1>(info),
+                         std::get<2>(info),
+                         numRows(resp.responses()[i]));
         }
     }
 
+    // Record the rough bytes of the datasets taken over from the storage responses,
+    // which used to be copied, accumulated over the calls
+    void addMovedBytes(int64_t bytes);
+
     bool isIntVidType(const SpaceInfo &space) const;
 
     DataSet buildRequestDataSetByVidType(Iterator *iter, Expression *expr, bool dedup);
+
+    // Split the vids of request by the partitions they belong to, the same way as the storage
+    // client does, so each part is sent to one host. The vids of a partition are further split
+    // into chunks of at most `chunkSize' vids unless it's 0. Not split by partitions if the
+    // number of partitions is unknown.
+    std::vector<DataSet> splitByParts(GraphSpaceID space,
+                                      DataSet &&vertices,
+                                      size_t chunkSize) const;
+
+    // Split the rows by the partitions `partOf' takes their first columns to, then into chunks
+    // of at most `chunkSize' rows unless it's 0. Only split into chunks if `partOf' is null.
+    static std::vector<DataSet> splitRows(DataSet &&rows,
+                                          size_t chunkSize,
+                                          std::function<PartitionID(const Value &)> partOf);
+
+    // Send each of the requests by `send', at most `concurrency' of them in flight unless it's 0,
+    // and hand every response to `onResp' as soon as it arrives, one at a time, so the work on
+    // the responses of fast hosts overlaps with waiting for the slow ones. The returned response
+    // only keeps the completeness, the failed parts and the latencies of all requests, the
+    // datasets have been taken by `onResp'.
+    template <typename Resp, typename SendFunc, typename OnRespFunc>
+    folly::Future<storage::StorageRpcResponse<Resp>> streamRequests(std::vector<DataSet> requests,
+                                                                    size_t concurrency,
+                                                                    SendFunc send,
+                                                                    OnRespFunc onResp) {
+        struct State {
+            State(std::vector<DataSet> reqs, OnRespFunc func)
+                : requests(std::move(reqs)), merged(requests.size()), onResp(std::move(func)) {}
+
+            std::vector<DataSet>                requests;
+            std::mutex                          lock;
+            storage::StorageRpcResponse<Resp>   merged;
+            OnRespFunc                          onResp;
+        };
+        auto numRequests = requests.size();
+        auto state = std::make_shared<State>(std::move(requests), std::move(onResp));
+        auto handle = [state](storage::StorageRpcResponse<Resp> &&resp) {
+            std::lock_guard<std::mutex> guard(state->lock);
+            // A request is sent to one host, so it's either done or failed
+            if (resp.completeness() != 100) {
+                state->merged.markFailure();
+            }
+            for (auto &part : resp.failedParts()) {
+                state->merged.failedParts().emplace(part);
+            }
+            for (auto &latency : resp.hostLatency()) {
+                state->merged.setLatency(
+                    std::get<0>(latency), std::get<1>(latency), std::get<2>(latency));
+            }
+            state->onResp(resp);
+        };
+
+        // Each lane sends its requests one after another
+        auto numLanes = concurrency == 0 ? numRequests : std::min(concurrency, numRequests);
+        std::vector<folly::Future<folly::Unit>> lanes;
+        lanes.reserve(numLanes);
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            auto future = folly::makeFuture();
+            for (auto i = lane; i < numRequests; i += numLanes) {
+                future = std::move(future).thenValue([this, state, send, handle, i](auto &&) {
+                    return send(std::move(state->requests[i])).via(runner()).thenValue(handle);
+                });
+            }
+            lanes.emplace_back(std::move(future));
+        }
+        otherStats_.emplace("streamed requests",
+                            folly::stringPrintf("%lu in %lu lanes", numRequests, numLanes));
+        // Wait for all lanes even if one failed, since the others still touch the executor
+        return folly::collectAll(lanes).via(runner()).thenValue(
+            [state](std::vector<folly::Try<folly::Unit>> &&results) {
+                for (auto &result : results) {
+                    result.throwIfFailed();
+                }
+                std::lock_guard<std::mutex> guard(state->lock);
+                return std::move(state->merged);
+            });
+    }
+
+private:
+    struct HostStats {
+        int64_t     execUs{0};
+        int64_t     totalUs{0};
+        size_t      rows{0};
+        size_t      numResps{0};
+    };
+
+    static size_t numRows(const storage::cpp2::GetNeighborsResponse &resp) {
+        return resp.vertices_ref().has_value() ? resp.vertices_ref()->size() : 0u;
+    }
+
+    static size_t numRows(const storage::cpp2::GetPropResponse &resp) {
+        return resp.props_ref().has_value() ? resp.props_ref()->size() : 0u;
+    }
+
+    void addHostStats(const HostAddr &host, int32_t execUs, int32_t totalUs, size_t rows);
+
+    int64_t                                     movedBytes_{0};
+    std::unordered_map<HostAddr, HostStats>     hostStats_;
 };
 
 }   // namespace graph
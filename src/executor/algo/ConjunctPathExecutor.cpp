@@ -302,6 +302,10 @@ void ConjunctPathExecutor::delPathFromConditionalVar(const Value& start, const V
             iter->next();
         }
     }
+    // Remove the rows from the result of variable shared by the copy of iterator
+    if (iter->isSequentialIter()) {
+        static_cast<SequentialIter*>(iter.get())->compact();
+    }
 }
 
 folly::Future<Status> ConjunctPathExecutor::allPaths() {
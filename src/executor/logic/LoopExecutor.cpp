@@ -35,5 +35,12 @@ folly::Future<Status> LoopExecutor::execute() {
     return finish(ResultBuilder().value(std::move(value)).iter(Iterator::Kind::kDefault).finish());
 }
 
+Status LoopExecutor::close() {
+    if (scheduleTime_ > 0) {
+        otherStats_.emplace("schedule body", stringPrintf("%lu(us)", scheduleTime_));
+    }
+    return Executor::close();
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -18,6 +18,8 @@ public:
 
     folly::Future<Status> execute() override;
 
+    Status close() override;
+
     void setLoopBody(Executor *body) {
         body_ = DCHECK_NOTNULL(body);
     }
@@ -26,9 +28,17 @@ public:
         return body_;
     }
 
+    // Account the time of scheduling the body, which is reported by the next iteration
+    void addScheduleTime(uint64_t us) {
+        scheduleTime_ += us;
+    }
+
 private:
     // Hold the last executor node of loop body executors chain
     Executor *body_{nullptr};
+
+    // Total time of scheduling the body so far
+    uint64_t scheduleTime_{0};
 };
 
 }   // namespace graph
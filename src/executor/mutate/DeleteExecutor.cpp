@@ -59,11 +59,24 @@ folly::Future<Status> DeleteVerticesExecutor::deleteVertices() {
         return Status::OK();
     }
     auto spaceId = spaceInfo.id;
+    // Invalidate the cached vertices once deleted
+    std::vector<Value> cachedVertices;
+    if (qctx()->vertexCache() != nullptr || qctx()->neighborCache() != nullptr) {
+        cachedVertices = vertices;
+    }
     time::Duration deleteVertTime;
     return qctx()->getStorageClient()->deleteVertices(spaceId, std::move(vertices))
         .via(runner())
-        .ensure([deleteVertTime]() {
+        .ensure([this, spaceId, cachedVertices = std::move(cachedVertices), deleteVertTime]() {
             VLOG(1) << "Delete vertices time: " << deleteVertTime.elapsedInUSec() << "us";
+            for (auto *cache : {qctx()->vertexCache(), qctx()->neighborCache()}) {
+                if (cache == nullptr) {
+                    continue;
+                }
+                for (auto &vid : cachedVertices) {
+                    cache->invalidate(spaceId, vid);
+                }
+            }
         })
         .thenValue([this](storage::StorageRpcResponse<storage::cpp2::ExecResponse> resp) {
             SCOPED_TIMER(&execTime_);
@@ -149,11 +162,23 @@ folly::Future<Status> DeleteEdgesExecutor::deleteEdges() {
     }
 
     auto spaceId = spaceInfo.id;
+    // Invalidate the cached neighbors of both ends once deleted, the keys of in edges are
+    // in the list too
+    std::vector<Value> cachedVertices;
+    if (qctx()->neighborCache() != nullptr) {
+        cachedVertices.reserve(edgeKeys.size());
+        for (auto &edgeKey : edgeKeys) {
+            cachedVertices.emplace_back(*edgeKey.src_ref());
+        }
+    }
     time::Duration deleteEdgeTime;
     return qctx()->getStorageClient()->deleteEdges(spaceId, std::move(edgeKeys))
             .via(runner())
-            .ensure([deleteEdgeTime]() {
+            .ensure([this, spaceId, cachedVertices = std::move(cachedVertices), deleteEdgeTime]() {
                 VLOG(1) << "Delete edge time: " << deleteEdgeTime.elapsedInUSec() << "us";
+                for (auto &vid : cachedVertices) {
+                    qctx()->neighborCache()->invalidate(spaceId, vid);
+                }
             })
             .thenValue([this](storage::StorageRpcResponse<storage::cpp2::ExecResponse> resp) {
                 SCOPED_TIMER(&execTime_);
@@ -27,8 +27,17 @@ folly::Future<Status> InsertVerticesExecutor::insertVertices() {
                                                    ivNode->getPropNames(),
                                                    ivNode->getIfNotExists())
         .via(runner())
-        .ensure([addVertTime]() {
+        .ensure([this, ivNode, addVertTime]() {
             VLOG(1) << "Add vertices time: " << addVertTime.elapsedInUSec() << "us";
+            // The cached ones are stale whether the insertion succeeded or not
+            for (auto *cache : {qctx()->vertexCache(), qctx()->neighborCache()}) {
+                if (cache == nullptr) {
+                    continue;
+                }
+                for (auto &vertex : ivNode->getVertices()) {
+                    cache->invalidate(ivNode->getSpace(), *vertex.id_ref());
+                }
+            }
         })
         .thenValue([this](storage::StorageRpcResponse<storage::cpp2::ExecResponse> resp) {
             SCOPED_TIMER(&execTime_);
@@ -53,8 +62,16 @@ folly::Future<Status> InsertEdgesExecutor::insertEdges() {
                                                 nullptr,
                                                 ieNode->useChainInsert())
             .via(runner())
-            .ensure([addEdgeTime]() {
+            .ensure([this, ieNode, addEdgeTime]() {
                 VLOG(1) << "Add edge time: " << addEdgeTime.elapsedInUSec() << "us";
+                // Both ends see the edge in their neighbors
+                auto *cache = qctx()->neighborCache();
+                if (cache != nullptr) {
+                    for (auto &edge : ieNode->getEdges()) {
+                        cache->invalidate(ieNode->getSpace(), *edge.key_ref()->src_ref());
+                        cache->invalidate(ieNode->getSpace(), *edge.key_ref()->dst_ref());
+                    }
+                }
             })
             .thenValue([this](storage::StorageRpcResponse<storage::cpp2::ExecResponse> resp) {
                 SCOPED_TIMER(&execTime_);
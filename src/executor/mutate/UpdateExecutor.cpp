@@ -53,8 +53,13 @@ folly::Future<Status> UpdateVertexExecutor::execute() {
                                                     uvNode->getReturnProps(),
                                                     uvNode->getCondition())
         .via(runner())
-        .ensure([updateVertTime]() {
+        .ensure([this, uvNode, updateVertTime]() {
             VLOG(1) << "Update vertice time: " << updateVertTime.elapsedInUSec() << "us";
+            for (auto *cache : {qctx()->vertexCache(), qctx()->neighborCache()}) {
+                if (cache != nullptr) {
+                    cache->invalidate(uvNode->getSpaceId(), uvNode->getVId());
+                }
+            }
         })
         .thenValue([this](StatusOr<storage::cpp2::UpdateResponse> resp) {
             SCOPED_TIMER(&execTime_);
@@ -98,8 +103,13 @@ folly::Future<Status> UpdateEdgeExecutor::execute() {
                                                   ueNode->getReturnProps(),
                                                   ueNode->getCondition())
             .via(runner())
-            .ensure([updateEdgeTime]() {
+            .ensure([this, ueNode, updateEdgeTime]() {
                 VLOG(1) << "Update edge time: " << updateEdgeTime.elapsedInUSec() << "us";
+                auto *cache = qctx()->neighborCache();
+                if (cache != nullptr) {
+                    cache->invalidate(ueNode->getSpaceId(), ueNode->getSrcId());
+                    cache->invalidate(ueNode->getSpaceId(), ueNode->getDstId());
+                }
             })
             .thenValue([this](StatusOr<storage::cpp2::UpdateResponse> resp) {
                 SCOPED_TIMER(&execTime_);
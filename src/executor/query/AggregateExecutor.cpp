@@ -8,6 +8,7 @@
 
 #include "common/datatypes/List.h"
 #include "common/expression/AggregateExpression.h"
+#include "context/CompiledExpression.h"
 #include "context/QueryExpressionContext.h"
 #include "context/Result.h"
 #include "planner/plan/PlanNode.h"
@@ -17,6 +18,174 @@
 namespace nebula {
 namespace graph {
 
+namespace {
+
+// The functions whose partial states could be merged, STD keeps the deviation only
+bool isMergeable(AggregateExpression* item) {
+    if (item->distinct()) {
+        return true;
+    }
+    auto func = item->name();
+    std::transform(func.begin(), func.end(), func.begin(), ::toupper);
+    return func != "STD";
+}
+
+// Merge the state `from' of a later part of rows into `to'
+void mergeState(AggregateExpression* item, AggData* from, AggData* to) {
+    auto func = item->name();
+    std::transform(func.begin(), func.end(), func.begin(), ::toupper);
+    if (item->distinct()) {
+        // Apply the values unseen by `to' in the order they appear for COLLECT
+        auto* uniques = to->uniques();
+        if (func == "COLLECT") {
+            if (from->result().isList()) {
+                for (auto& val : from->result().getList().values) {
+                    if (uniques->emplace(val).second) {
+                        item->apply(to, val);
+                    }
+                }
+            }
+            return;
+        }
+        for (auto& val : *from->uniques()) {
+            if (uniques->emplace(val).second) {
+                item->apply(to, val);
+            }
+        }
+        return;
+    }
+    auto& res = to->result();
+    auto& other = from->result();
+    if (res.isBadNull() || other.isNull() || other.empty()) {
+        if (other.isBadNull()) {
+            res = other;
+        }
+        return;
+    }
+    if (res.isNull() || res.empty()) {
+        res = std::move(other);
+        if (func == "AVG") {
+            to->setSum(Value(from->sum()));
+            to->setCnt(Value(from->cnt()));
+        }
+        return;
+    }
+    if (func == "COUNT") {
+        res = res + other;
+    } else if (func == "AVG") {
+        to->setSum(to->sum() + from->sum());
+        to->setCnt(to->cnt() + from->cnt());
+        res = to->sum() / to->cnt();
+    } else if (func == "COLLECT") {
+        auto& values = other.mutableList().values;
+        std::move(values.begin(), values.end(), std::back_inserter(res.mutableList().values));
+    } else if (func == "COLLECT_SET") {
+        auto& values = other.mutableSet().values;
+        res.mutableSet().values.insert(values.begin(), values.end());
+    } else {
+        // SUM, MAX, MIN and the bit functions, which are associative
+        item->apply(to, other);
+    }
+}
+
+}   // namespace
+
+AggregateExecutor::AggGroups::AggGroups(size_t numItems, bool keepKeys)
+    : numItems_(numItems), keepKeys_(keepKeys) {}
+
+size_t AggregateExecutor::AggGroups::global() {
+    if (numGroups_ == 0) {
+        newGroup();
+        if (keepKeys_) {
+            keys_.emplace_back();
+        }
+    }
+    return 0;
+}
+
+size_t AggregateExecutor::AggGroups::groupOf(const Value& key) {
+    if (key.isInt()) {
+        auto res = intGroups_.emplace(key.getInt(), numGroups_);
+        if (res.second) {
+            newGroup();
+            keepKey(key);
+        }
+        return res.first->second;
+    }
+    if (key.isStr()) {
+        auto res = strGroups_.try_emplace(key.getStr(), numGroups_);
+        if (res.second) {
+            newGroup();
+            keepKey(key);
+        }
+        return res.first->second;
+    }
+    List list;
+    list.values.emplace_back(key);
+    return groupOf(std::move(list));
+}
+
+size_t AggregateExecutor::AggGroups::groupOf(List&& key) {
+    if (key.values.size() == 1 && (key.values[0].isInt() || key.values[0].isStr())) {
+        return groupOf(key.values[0]);
+    }
+    auto res = groups_.try_emplace(std::move(key), numGroups_);
+    if (res.second) {
+        newGroup();
+        if (keepKeys_) {
+            keys_.emplace_back(res.first->first);
+        }
+    }
+    return res.first->second;
+}
+
+void AggregateExecutor::AggGroups::keepKey(const Value& key) {
+    if (keepKeys_) {
+        List list;
+        list.values.emplace_back(key);
+        keys_.emplace_back(std::move(list));
+    }
+}
+
+void AggregateExecutor::AggGroups::merge(const std::vector<Expression*>& groupItems,
+                                         AggGroups&& other) {
+    DCHECK(other.keepKeys_);
+    DCHECK_EQ(numItems_, other.numItems_);
+    for (size_t group = 0; group < other.numGroups_; ++group) {
+        auto& key = other.keys_[group];
+        auto to = key.values.empty() ? global() : groupOf(std::move(key));
+        for (size_t i = 0; i < numItems_; ++i) {
+            auto* item = groupItems[i];
+            auto* from = other.state(group, i);
+            if (item->kind() == Expression::Kind::kAggregate) {
+                mergeState(static_cast<AggregateExpression*>(item), from, state(to, i));
+            } else {
+                // The later rows win as the serial aggregation
+                state(to, i)->setResult(std::move(from->result()));
+            }
+        }
+    }
+}
+
+void AggregateExecutor::AggGroups::newGroup() {
+    for (size_t i = 0; i < numItems_; ++i) {
+        states_.emplace_back();
+    }
+    ++numGroups_;
+}
+
+void AggregateExecutor::AggGroups::appendRows(std::vector<Row>* rows) const {
+    rows->reserve(rows->size() + numGroups_);
+    for (size_t group = 0; group < numGroups_; ++group) {
+        Row row;
+        row.values.reserve(numItems_);
+        for (size_t i = 0; i < numItems_; ++i) {
+            row.values.emplace_back(states_[group * numItems_ + i].result());
+        }
+        rows->emplace_back(std::move(row));
+    }
+}
+
 folly::Future<Status> AggregateExecutor::execute() {
     SCOPED_TIMER(&execTime_);
     auto* agg = asNode<Aggregate>(node());
@@ -24,74 +193,156 @@ folly::Future<Status> AggregateExecutor::execute() {
     auto groupItems = agg->groupItems();
     auto iter = ectx_->getResult(agg->inputVar()).iter();
     DCHECK(!!iter);
-    QueryExpressionContext ctx(ectx_);
-
-    std::unordered_map<List, std::vector<std::unique_ptr<AggData>>, std::hash<nebula::List>> result;
 
+    DataSet ds;
+    ds.colNames = agg->colNames();
     // generate default result when input dataset is empty
     if (UNLIKELY(!iter->valid())) {
-        List defaultValues;
-        bool allAggItems = true;
+        Row defaultValues;
         for (size_t i = 0; i < groupItems.size(); ++i) {
             auto* item = groupItems[i];
             if (UNLIKELY(item->kind() != Expression::Kind::kAggregate)) {
-                allAggItems = false;
-                break;
+                return finish(ResultBuilder().value(Value(std::move(ds))).finish());
             }
             AggData aggData;
             static_cast<AggregateExpression*>(item)->apply(&aggData, Value::kNullValue);
-            defaultValues.emplace_back(aggData.result());
-        }
-        if (allAggItems) {
-            List dummyKey;
-            std::vector<std::unique_ptr<AggData>> cols;
-            for (size_t i = 0; i < groupItems.size(); ++i) {
-                cols.emplace_back(new AggData());
-                cols[i]->setResult(defaultValues[i]);
-            }
-            result.emplace(std::make_pair(dummyKey, std::move(cols)));
+            defaultValues.values.emplace_back(aggData.result());
         }
+        ds.rows.emplace_back(std::move(defaultValues));
+        return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+    }
+
+    auto mergeable = std::all_of(groupItems.begin(), groupItems.end(), [](auto* item) {
+        return item->kind() != Expression::Kind::kAggregate ||
+               isMergeable(static_cast<AggregateExpression*>(item));
+    });
+    if (mergeable && iter->isSequentialIter() && shouldRunInParallel(iter->size())) {
+        return aggregateInParallel(std::move(iter));
     }
 
+    QueryExpressionContext ctx(ectx_);
+    auto keys = CompiledExpression::compile(qctx()->objPool(), groupKeys);
+    AggGroups groups(groupItems.size());
     for (; iter->valid(); iter->next()) {
-        List list;
-        for (auto* key : groupKeys) {
-            list.values.emplace_back(key->eval(ctx(iter.get())));
+        size_t group = 0;
+        if (keys.empty()) {
+            group = groups.global();
+        } else if (keys.size() == 1) {
+            group = groups.groupOf(keys.front()->eval(ctx(iter.get())));
+        } else {
+            List list;
+            list.values.reserve(keys.size());
+            for (auto& key : keys) {
+                list.values.emplace_back(key->eval(ctx(iter.get())));
+            }
+            group = groups.groupOf(std::move(list));
         }
+        aggregate(groupItems, ctx(iter.get()), group, &groups);
+    }
+    groups.appendRows(&ds.rows);
+    return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+}
 
-        auto it = result.find(list);
-        if (it == result.end()) {
-           std::vector<std::unique_ptr<AggData>> cols;
-           for (size_t i = 0; i < groupItems.size(); ++i) {
-               cols.emplace_back(new AggData());
-           }
-           result.emplace(std::make_pair(list, std::move(cols)));
+void AggregateExecutor::aggregate(const std::vector<Expression*>& groupItems,
+                                  QueryExpressionContext& ctx,
+                                  size_t group,
+                                  AggGroups* groups) const {
+    for (size_t i = 0; i < groupItems.size(); ++i) {
+        auto* item = groupItems[i];
+        auto* state = groups->state(group, i);
+        if (item->kind() == Expression::Kind::kAggregate) {
+            static_cast<AggregateExpression*>(item)->setAggData(state);
+            item->eval(ctx);
         } else {
-            DCHECK_EQ(it->second.size(), groupItems.size());
+            state->setResult(item->eval(ctx));
         }
+    }
+}
 
-        for (size_t i = 0; i < groupItems.size(); ++i) {
-            auto* item = groupItems[i];
-            if (item->kind() == Expression::Kind::kAggregate) {
-                static_cast<AggregateExpression*>(item)->setAggData(result[list][i].get());
-                item->eval(ctx(iter.get()));
-            } else {
-                result[list][i]->setResult(item->eval(ctx(iter.get())));
-            }
+folly::Future<Status> AggregateExecutor::aggregateInParallel(std::unique_ptr<Iterator> iter) {
+    auto* agg = asNode<Aggregate>(node());
+    const size_t numWorkers = maxNumWorkers();
+    // Each morsel is aggregated into the partial groups partitioned by the hash of keys, then
+    // the partial groups of each partition are merged by one worker
+    const size_t numPartitions = agg->groupKeys().empty() ? 1 : numWorkers;
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    struct WorkerState {
+        std::vector<std::unique_ptr<CompiledExpression>>    keys;
+        std::vector<Expression*>                            items;
+        std::unique_ptr<Iterator>                           iter;
+    };
+    auto workers = std::make_shared<std::vector<WorkerState>>(numWorkers);
+    for (auto& worker : *workers) {
+        worker.keys = CompiledExpression::compile(qctx()->objPool(), agg->groupKeys());
+        for (auto* item : agg->groupItems()) {
+            worker.items.emplace_back(item->clone());
         }
+        worker.iter = iter->copy();
     }
 
-    DataSet ds;
-    ds.colNames = agg->colNames();
-    ds.rows.reserve(result.size());
-    for (auto& kv : result) {
-        Row row;
-        for (auto& v : kv.second) {
-            row.values.emplace_back(v->result());
+    auto aggregateMorsel = [this, workers, numPartitions](
+                               size_t worker, size_t begin, size_t end) -> std::vector<AggGroups> {
+        auto& state = (*workers)[worker];
+        auto* morselIter = state.iter.get();
+        QueryExpressionContext ctx(ectx_);
+        std::vector<AggGroups> partitions;
+        partitions.reserve(numPartitions);
+        for (size_t p = 0; p < numPartitions; ++p) {
+            partitions.emplace_back(state.items.size(), true);
         }
-        ds.rows.emplace_back(std::move(row));
-    }
-    return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+        morselIter->reset(begin);
+        for (size_t pos = begin; pos < end; ++pos, morselIter->next()) {
+            size_t group = 0;
+            AggGroups* groups = &partitions.front();
+            if (state.keys.empty()) {
+                group = groups->global();
+            } else if (state.keys.size() == 1) {
+                auto key = state.keys.front()->eval(ctx(morselIter));
+                groups = &partitions[std::hash<Value>()(key) % numPartitions];
+                group = groups->groupOf(key);
+            } else {
+                List key;
+                key.values.reserve(state.keys.size());
+                for (auto& expr : state.keys) {
+                    key.values.emplace_back(expr->eval(ctx(morselIter)));
+                }
+                groups = &partitions[std::hash<List>()(key) % numPartitions];
+                group = groups->groupOf(std::move(key));
+            }
+            aggregate(state.items, ctx(morselIter), group, groups);
+        }
+        return partitions;
+    };
+
+    auto size = iter->size();
+    return runMorsels(size, std::move(aggregateMorsel))
+        .thenValue([this, workers, numPartitions](std::vector<std::vector<AggGroups>> morsels) {
+            auto shared = std::make_shared<std::vector<std::vector<AggGroups>>>(std::move(morsels));
+            auto mergePartitions = [workers, shared](size_t worker, size_t begin, size_t end) {
+                auto& state = (*workers)[worker];
+                std::vector<Row> rows;
+                for (size_t p = begin; p < end; ++p) {
+                    // Merge in the order of morsels to keep the order of rows in each group
+                    AggGroups groups(state.items.size());
+                    for (auto& morsel : *shared) {
+                        groups.merge(state.items, std::move(morsel[p]));
+                    }
+                    groups.appendRows(&rows);
+                }
+                return rows;
+            };
+            return runMorsels(numPartitions, std::move(mergePartitions), 1);
+        })
+        .thenValue([this](std::vector<std::vector<Row>> partitions) {
+            SCOPED_TIMER(&execTime_);
+            DataSet ds;
+            ds.colNames = node()->colNames();
+            for (auto& rows : partitions) {
+                std::move(rows.begin(), rows.end(), std::back_inserter(ds.rows));
+            }
+            return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+        });
 }
 
 }   // namespace graph
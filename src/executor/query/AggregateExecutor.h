@@ -7,6 +7,9 @@
 #ifndef EXECUTOR_QUERY_AGGREGATEEXECUTOR_H_
 #define EXECUTOR_QUERY_AGGREGATEEXECUTOR_H_
 
+#include "common/datatypes/List.h"
+#include "common/expression/AggregateExpression.h"
+#include "context/QueryExpressionContext.h"
 #include "executor/Executor.h"
 
 namespace nebula {
@@ -18,6 +21,57 @@ public:
         : Executor("AggregateExecutor", node, qctx) {}
 
     folly::Future<Status> execute() override;
+
+private:
+    // The aggregation states of the groups. The states of one group are laid out
+    // contiguously in chunks instead of being allocated one by one, and the single int
+    // or string keys, and the global aggregation without keys, skip building the List.
+    class AggGroups final {
+    public:
+        // `keepKeys' keeps the key of each group for merging into others
+        explicit AggGroups(size_t numItems, bool keepKeys = false);
+
+        // The only group of the aggregation without keys
+        size_t global();
+
+        size_t groupOf(const Value &key);
+
+        size_t groupOf(List &&key);
+
+        AggData *state(size_t group, size_t item) {
+            return &states_[group * numItems_ + item];
+        }
+
+        // Merge the partial states of `other', which keeps its keys and aggregated the rows
+        // after those of this one
+        void merge(const std::vector<Expression *> &groupItems, AggGroups &&other);
+
+        // Append the results of groups in the order of their first rows
+        void appendRows(std::vector<Row> *rows) const;
+
+    private:
+        void newGroup();
+
+        void keepKey(const Value &key);
+
+        size_t                                          numItems_{0};
+        bool                                            keepKeys_{false};
+        size_t                                          numGroups_{0};
+        std::vector<List>                               keys_;
+        std::unordered_map<int64_t, size_t>             intGroups_;
+        std::unordered_map<std::string, size_t>         strGroups_;
+        std::unordered_map<List, size_t>                groups_;
+        std::deque<AggData>                             states_;
+    };
+
+    void aggregate(const std::vector<Expression *> &groupItems,
+                   QueryExpressionContext &ctx,
+                   size_t group,
+                   AggGroups *groups) const;
+
+    // Aggregate each morsel into the partial groups partitioned by the hash of group keys,
+    // then merge the partial groups of each partition by one worker
+    folly::Future<Status> aggregateInParallel(std::unique_ptr<Iterator> iter);
 };
 
 }   // namespace graph
@@ -37,6 +37,10 @@ folly::Future<Status> DedupExecutor::execute() {
             iter->next();
         }
     }
+    // The result is kept as is, so remove the erased rows here
+    if (iter->isSequentialIter() || iter->isPropIter()) {
+        static_cast<SequentialIter*>(iter)->compact();
+    }
     iter->reset();
     return finish(std::move(result));
 }
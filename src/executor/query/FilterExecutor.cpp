@@ -8,7 +8,10 @@
 
 #include "planner/plan/Query.h"
 
+#include "context/BatchEvaluator.h"
+#include "context/CompiledExpression.h"
 #include "context/QueryExpressionContext.h"
+#include "service/GraphFlags.h"
 #include "util/ScopedTimer.h"
 
 namespace nebula {
@@ -28,10 +31,27 @@ folly::Future<Status> FilterExecutor::execute() {
             << ", iterator type: " << static_cast<int16_t>(iter->kind())
             << ", input data size: " << iter->size();
 
+    if (iter->isSequentialIter() && shouldRunInParallel(iter->size())) {
+        return filterInParallel(std::move(result));
+    }
+
     ResultBuilder builder;
     builder.value(result.valuePtr());
+    auto condition = CompiledExpression::compile(qctx()->objPool(), filter->condition());
+    if (FLAGS_enable_batch_eval && iter->isSequentialIter()) {
+        auto* seqIter = static_cast<SequentialIter*>(iter);
+        auto evaluator = BatchEvaluator::make(condition->expr(), seqIter);
+        if (evaluator != nullptr) {
+            std::vector<uint8_t> keep(seqIter->size(), 0);
+            NG_RETURN_IF_ERROR(checkRows(
+                condition.get(), evaluator.get(), seqIter, 0, seqIter->size(), keep.data()));
+            compact(seqIter, keep);
+            builder.iter(std::move(result).iter());
+            return finish(builder.finish());
+        }
+    }
+
     QueryExpressionContext ctx(ectx_);
-    auto condition = filter->condition();
     while (iter->valid()) {
         auto val = condition->eval(ctx(iter));
         if (val.isBadNull() || (!val.empty() && !val.isBool() && !val.isNull())) {
@@ -54,5 +74,103 @@ folly::Future<Status> FilterExecutor::execute() {
     return finish(builder.finish());
 }
 
+folly::Future<Status> FilterExecutor::filterInParallel(Result result) {
+    auto* condition = asNode<Filter>(node())->condition();
+    auto* iter = static_cast<SequentialIter*>(result.iterRef());
+    auto size = iter->size();
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    struct WorkerState {
+        std::unique_ptr<CompiledExpression> condition;
+        std::unique_ptr<Iterator>           iter;
+        std::unique_ptr<BatchEvaluator>     evaluator;
+    };
+    std::vector<WorkerState> workers(maxNumWorkers());
+    for (auto& worker : workers) {
+        worker.condition = CompiledExpression::compile(qctx()->objPool(), condition);
+        worker.iter = iter->copy();
+        if (FLAGS_enable_batch_eval) {
+            worker.evaluator = BatchEvaluator::make(
+                worker.condition->expr(), static_cast<SequentialIter*>(worker.iter.get()));
+        }
+    }
+
+    auto keep = std::make_shared<std::vector<uint8_t>>(size, 0);
+    auto scatter = [this, keep, workers = std::move(workers)](
+                       size_t worker, size_t begin, size_t end) -> Status {
+        auto& state = workers[worker];
+        return checkRows(state.condition.get(),
+                         state.evaluator.get(),
+                         static_cast<SequentialIter*>(state.iter.get()),
+                         begin,
+                         end,
+                         keep->data());
+    };
+    return runMorsels(size, std::move(scatter))
+        .thenValue([this, keep, result = std::move(result)](
+                       std::vector<Status> statuses) mutable -> Status {
+            SCOPED_TIMER(&execTime_);
+            for (auto& status : statuses) {
+                NG_RETURN_IF_ERROR(status);
+            }
+            auto* resultIter = static_cast<SequentialIter*>(result.iterRef());
+            compact(resultIter, *keep);
+            ResultBuilder builder;
+            builder.value(result.valuePtr()).iter(std::move(result).iter());
+            return finish(builder.finish());
+        });
+}
+
+Status FilterExecutor::checkRows(CompiledExpression* condition,
+                                 BatchEvaluator* evaluator,
+                                 SequentialIter* iter,
+                                 size_t begin,
+                                 size_t end,
+                                 uint8_t* keep) const {
+    auto check = [](const Value& val, uint8_t* satisfied) -> Status {
+        if (val.isBadNull() || (!val.empty() && !val.isBool() && !val.isNull())) {
+            return Status::Error("Internal Error: Wrong type result, "
+                                 "the type should be NULL,EMPTY or BOOL");
+        }
+        *satisfied = !(val.empty() || val.isNull() || !val.getBool());
+        return Status::OK();
+    };
+
+    QueryExpressionContext ctx(ectx_);
+    if (evaluator == nullptr) {
+        iter->reset(begin);
+        for (size_t pos = begin; pos < end; ++pos, iter->next()) {
+            NG_RETURN_IF_ERROR(check(condition->eval(ctx(iter)), keep + pos));
+        }
+        return Status::OK();
+    }
+
+    const size_t batchSize = std::max(FLAGS_batch_eval_size, 1U);
+    std::vector<Value> vals;
+    for (size_t pos = begin; pos < end; pos += batchSize) {
+        auto num = std::min(batchSize, end - pos);
+        vals.clear();
+        evaluator->eval(iter, pos, num, ctx, &vals);
+        for (size_t i = 0; i < num; ++i) {
+            NG_RETURN_IF_ERROR(check(vals[i], keep + pos + i));
+        }
+    }
+    return Status::OK();
+}
+
+void FilterExecutor::compact(SequentialIter* iter, const std::vector<uint8_t>& keep) const {
+    DCHECK_EQ(iter->size(), keep.size());
+    iter->reset();
+    for (auto satisfied : keep) {
+        if (satisfied) {
+            iter->next();
+        } else {
+            iter->erase();
+        }
+    }
+    iter->compact();
+    iter->reset();
+}
+
 }   // namespace graph
 }   // namespace nebula
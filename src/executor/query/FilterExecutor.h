@@ -12,12 +12,32 @@
 namespace nebula {
 namespace graph {
 
+class BatchEvaluator;
+class CompiledExpression;
+class SequentialIter;
+
 class FilterExecutor final : public Executor {
 public:
     FilterExecutor(const PlanNode *node, QueryContext *qctx)
         : Executor("FilterExecutor", node, qctx) {}
 
     folly::Future<Status> execute() override;
+
+private:
+    // Split the rows into morsels and check them in parallel
+    folly::Future<Status> filterInParallel(Result result);
+
+    // Check the rows in [begin, end) of `iter' and mark the satisfied ones in `keep',
+    // the condition is evaluated in batch if `evaluator' is given.
+    Status checkRows(CompiledExpression *condition,
+                     BatchEvaluator *evaluator,
+                     SequentialIter *iter,
+                     size_t begin,
+                     size_t end,
+                     uint8_t *keep) const;
+
+    // Erase the rows not kept, the origin order is kept
+    void compact(SequentialIter *iter, const std::vector<uint8_t> &keep) const;
 };
 
 }   // namespace graph
@@ -88,7 +88,7 @@ folly::Future<Status> GetEdgesExecutor::getEdges() {
         })
         .thenValue([this, ge](StorageRpcResponse<GetPropResponse> &&rpcResp) {
             SCOPED_TIMER(&execTime_);
-            addStats(rpcResp, otherStats_);
+            addStats(rpcResp);
             return handleResp(std::move(rpcResp), ge->colNames());
         });
 }
@@ -12,8 +12,9 @@
 #include "common/datatypes/List.h"
 #include "common/datatypes/Vertex.h"
 #include "context/QueryContext.h"
-#include "util/ScopedTimer.h"
 #include "service/GraphFlags.h"
+#include "stats/StatsDef.h"
+#include "util/ScopedTimer.h"
 
 using nebula::storage::StorageRpcResponse;
 using nebula::storage::cpp2::GetNeighborsResponse;
@@ -40,70 +41,195 @@ folly::Future<Status> GetNeighborsExecutor::execute() {
                           .finish());
     }
 
+    std::string shape;
+    List cached;
+    bool cacheable = isCacheable();
+    if (cacheable) {
+        shape = VertexCache::shapeOf(gn_->edgeTypes(),
+                                     gn_->edgeDirection(),
+                                     gn_->statProps(),
+                                     gn_->vertexProps(),
+                                     gn_->edgeProps(),
+                                     gn_->exprs(),
+                                     gn_->dedup(),
+                                     gn_->filter());
+        cached = getCachedNeighbors(shape, &reqDs);
+        if (reqDs.rows.empty()) {
+            return finish(ResultBuilder()
+                              .value(Value(std::move(cached)))
+                              .iter(Iterator::Kind::kGetNeighbors)
+                              .finish());
+        }
+    }
+
+    // The huge frontier is split into chunks to bound the latency and memory of each request
+    bool chunked = FLAGS_storage_request_chunk_size > 0 &&
+                   reqDs.rows.size() > FLAGS_storage_request_chunk_size;
+    if ((FLAGS_stream_storage_responses || chunked) && !dependsOnOtherVertices()) {
+        auto requests =
+            splitByParts(gn_->space(), std::move(reqDs), FLAGS_storage_request_chunk_size);
+        if (requests.size() > 1) {
+            return streamNeighbors(std::move(requests), cacheable, shape, std::move(cached));
+        }
+        reqDs = std::move(requests.front());
+    }
+
     time::Duration getNbrTime;
-    GraphStorageClient* storageClient = qctx_->getStorageClient();
-    return storageClient
-        ->getNeighbors(gn_->space(),
-                       std::move(reqDs.colNames),
-                       std::move(reqDs.rows),
-                       gn_->edgeTypes(),
-                       gn_->edgeDirection(),
-                       gn_->statProps(),
-                       gn_->vertexProps(),
-                       gn_->edgeProps(),
-                       gn_->exprs(),
-                       gn_->dedup(),
-                       gn_->random(),
-                       gn_->orderBy(),
-                       gn_->limit(),
-                       gn_->filter())
+    auto* coalescer = qctx_->getStorageCoalescer();
+    auto rpc = coalescer != nullptr ? sendRequest(coalescer, std::move(reqDs))
+                                    : StorageCoalescer::RpcFuture<GetNeighborsResponse>(
+                                          sendRequest(qctx_->getStorageClient(), std::move(reqDs)));
+    return std::move(rpc)
         .via(runner())
         .ensure([this, getNbrTime]() {
             SCOPED_TIMER(&execTime_);
             otherStats_.emplace("total_rpc_time",
                                 folly::stringPrintf("%lu(us)", getNbrTime.elapsedInUSec()));
         })
-        .thenValue([this](StorageRpcResponse<GetNeighborsResponse>&& resp) {
+        .thenValue([this, cacheable, shape = std::move(shape), cached = std::move(cached)](
+                       StorageRpcResponse<GetNeighborsResponse>&& resp) mutable {
             SCOPED_TIMER(&execTime_);
-            auto& hostLatency = resp.hostLatency();
-            for (size_t i = 0; i < hostLatency.size(); ++i) {
-                size_t size = 0u;
-                auto& result = resp.responses()[i];
-                if (result.vertices_ref().has_value()) {
-                    size = (*result.vertices_ref()).size();
-                }
-                auto& info = hostLatency[i];
-                otherStats_.emplace(
-                    folly::stringPrintf("%s exec/total/vertices",
-                                        std::get<0>(info).toString().c_str()),
-                    folly::stringPrintf(
-                        "%d(us)/%d(us)/%lu,", std::get<1>(info), std::get<2>(info), size));
+            addStats(resp);
+            if (cacheable) {
+                cacheNeighbors(shape, resp);
             }
-            return handleResponse(resp);
+            return handleResponse(resp, std::move(cached));
+        });
+}
+
+folly::Future<Status> GetNeighborsExecutor::streamNeighbors(std::vector<DataSet> requests,
+                                                            bool cacheable,
+                                                            const std::string& shape,
+                                                            List cached) {
+    time::Duration getNbrTime;
+    // The requests are sent to storage directly since the coalescer would merge them back
+    auto send = [this](DataSet reqDs) {
+        return StorageCoalescer::RpcFuture<GetNeighborsResponse>(
+            sendRequest(qctx_->getStorageClient(), std::move(reqDs)));
+    };
+    auto list = std::make_shared<List>(std::move(cached));
+    auto onResp = [this, list, cacheable, shape](RpcResponse& resp) {
+        SCOPED_TIMER(&execTime_);
+        addStats(resp);
+        if (cacheable) {
+            cacheNeighbors(shape, resp);
+        }
+        collectDatasets(resp, list.get());
+    };
+    return streamRequests<GetNeighborsResponse>(std::move(requests),
+                                                FLAGS_storage_request_concurrency,
+                                                send,
+                                                std::move(onResp))
+        .ensure([this, getNbrTime]() {
+            SCOPED_TIMER(&execTime_);
+            otherStats_.emplace("total_rpc_time",
+                                folly::stringPrintf("%lu(us)", getNbrTime.elapsedInUSec()));
+        })
+        .thenValue([this, list](RpcResponse&& resp) {
+            SCOPED_TIMER(&execTime_);
+            return handleResponse(resp, std::move(*list));
         });
 }
 
-Status GetNeighborsExecutor::handleResponse(RpcResponse& resps) {
+bool GetNeighborsExecutor::dependsOnOtherVertices() const {
+    return gn_->random() || !gn_->orderBy().empty() ||
+           gn_->limit() != std::numeric_limits<int64_t>::max() ||
+           (gn_->statProps() != nullptr && !gn_->statProps()->empty());
+}
+
+bool GetNeighborsExecutor::isCacheable() const {
+    auto* cache = qctx()->neighborCache();
+    // The results depending on the other vertices are not cached
+    if (cache == nullptr || dependsOnOtherVertices()) {
+        return false;
+    }
+    auto* session = qctx()->rctx()->session();
+    return session != nullptr && session->space().id == gn_->space() &&
+           cache->enabled(session->space().name);
+}
+
+List GetNeighborsExecutor::getCachedNeighbors(const std::string& shape, DataSet* reqDs) {
+    auto* cache = qctx()->neighborCache();
+    cacheEpoch_ = cache->epoch();
+    // The cached rows of one response share the names of columns
+    std::unordered_map<const std::vector<std::string>*, DataSet> datasets;
+    std::vector<Row> missed;
+    int64_t hits = 0;
+    for (auto& vertex : reqDs->rows) {
+        Row row;
+        VertexCache::ColNames colNames;
+        if (!cache->get(gn_->space(), vertex.values.front(), shape, &row, &colNames)) {
+            missed.emplace_back(std::move(vertex));
+            continue;
+        }
+        auto& ds = datasets[colNames.get()];
+        if (ds.colNames.empty()) {
+            ds.colNames = *colNames;
+        }
+        ds.rows.emplace_back(std::move(row));
+        ++hits;
+    }
+    auto misses = static_cast<int64_t>(missed.size());
+    reqDs->rows = std::move(missed);
+
+    List cached;
+    cached.values.reserve(datasets.size());
+    for (auto& ds : datasets) {
+        cached.values.emplace_back(std::move(ds.second));
+    }
+    stats::StatsManager::addValue(kNumNeighborCacheHits, hits);
+    stats::StatsManager::addValue(kNumNeighborCacheMisses, misses);
+    stats::StatsManager::addValue(kNeighborCacheBytes, cache->bytes());
+    otherStats_.emplace("neighbor cache",
+                        folly::stringPrintf("%ld hits, %ld misses", hits, misses));
+    return cached;
+}
+
+void GetNeighborsExecutor::cacheNeighbors(const std::string& shape, RpcResponse& resps) {
+    auto* cache = qctx()->neighborCache();
+    for (auto& resp : resps.responses()) {
+        if (!resp.vertices_ref().has_value()) {
+            continue;
+        }
+        auto& ds = *resp.vertices_ref();
+        auto colNames = std::make_shared<const std::vector<std::string>>(ds.colNames);
+        // The first column is the vid
+        for (auto& row : ds.rows) {
+            cache->put(gn_->space(), row.values.front(), shape, row, colNames, cacheEpoch_);
+        }
+    }
+}
+
+Status GetNeighborsExecutor::handleResponse(RpcResponse& resps, List cached) {
     auto result = handleCompleteness(resps, FLAGS_accept_partial_success);
     NG_RETURN_IF_ERROR(result);
     ResultBuilder builder;
     builder.state(result.value());
 
+    VLOG(2) << node_->toString() << ", Resp size: " << resps.responses().size();
+    List list = std::move(cached);
+    collectDatasets(resps, &list);
+    builder.value(Value(std::move(list)));
+    return finish(builder.iter(Iterator::Kind::kGetNeighbors).finish());
+}
+
+void GetNeighborsExecutor::collectDatasets(RpcResponse& resps, List* list) {
     auto& responses = resps.responses();
-    VLOG(2) << node_->toString() << ", Resp size: " << responses.size();
-    List list;
+    list->values.reserve(list->values.size() + responses.size());
+    int64_t movedBytes = 0;
     for (auto& resp : responses) {
-        auto dataset = resp.get_vertices();
-        if (dataset == nullptr) {
+        // Take over the dataset of response instead of copying it
+        auto dataset = resp.vertices_ref();
+        if (!dataset.has_value()) {
             LOG(INFO) << "Empty dataset in response";
             continue;
         }
 
         VLOG(2) << "Resp row size: " << dataset->rows.size() << ", Resp: " << *dataset;
-        list.values.emplace_back(std::move(*dataset));
+        movedBytes += MemoryTracker::estimate(*dataset);
+        list->values.emplace_back(std::move(*dataset));
     }
-    builder.value(Value(std::move(list)));
-    return finish(builder.iter(Iterator::Kind::kGetNeighbors).finish());
+    addMovedBytes(movedBytes);
 }
 
 }   // namespace graph
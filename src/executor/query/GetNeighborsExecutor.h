@@ -28,10 +28,53 @@ public:
 
 private:
     using RpcResponse = storage::StorageRpcResponse<storage::cpp2::GetNeighborsResponse>;
-    Status handleResponse(RpcResponse& resps);
+
+    // The coalescer has the same interface as the storage client
+    template <typename Client>
+    auto sendRequest(Client* client, DataSet reqDs) {
+        return client->getNeighbors(gn_->space(),
+                                    std::move(reqDs.colNames),
+                                    std::move(reqDs.rows),
+                                    gn_->edgeTypes(),
+                                    gn_->edgeDirection(),
+                                    gn_->statProps(),
+                                    gn_->vertexProps(),
+                                    gn_->edgeProps(),
+                                    gn_->exprs(),
+                                    gn_->dedup(),
+                                    gn_->random(),
+                                    gn_->orderBy(),
+                                    gn_->limit(),
+                                    gn_->filter());
+    }
+
+    // Send the request of each partition alone and collect the responses as they arrive
+    folly::Future<Status> streamNeighbors(std::vector<DataSet> requests,
+                                          bool cacheable,
+                                          const std::string& shape,
+                                          List cached);
+
+    // `cached' are the datasets served by the neighbor cache instead of storage
+    Status handleResponse(RpcResponse& resps, List cached = List());
+
+    // Take over the datasets of responses
+    void collectDatasets(RpcResponse& resps, List* list);
+
+    // Whether the result of a vertex depends on the other vertices of request, e.g. limit
+    bool dependsOnOtherVertices() const;
+
+    // Whether the neighbors could be served by the neighbor cache
+    bool isCacheable() const;
+
+    // Take the cached neighbors of `reqDs' out of the cache, the hit ones are removed from
+    // it. The epoch of cache is taken before fetching the missed ones.
+    List getCachedNeighbors(const std::string& shape, DataSet* reqDs);
+
+    void cacheNeighbors(const std::string& shape, RpcResponse& resps);
 
 private:
     const GetNeighbors*     gn_;
+    uint64_t                cacheEpoch_{0};
 };
 
 }   // namespace graph
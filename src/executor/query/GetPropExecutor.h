@@ -19,15 +19,19 @@ protected:
     GetPropExecutor(const std::string &name, const PlanNode *node, QueryContext *qctx)
         : StorageAccessExecutor(name, node, qctx) {}
 
+    // `cached' are the rows served by the vertex cache or taken from the streamed responses
     Status handleResp(storage::StorageRpcResponse<storage::cpp2::GetPropResponse> &&rpcResp,
-                      const std::vector<std::string> &colNames) {
+                      const std::vector<std::string> &colNames,
+                      DataSet cached = DataSet()) {
         auto result = handleCompleteness(rpcResp, FLAGS_accept_partial_success);
         NG_RETURN_IF_ERROR(result);
         auto state = std::move(result).value();
         // Ok, merge DataSets to one
         nebula::DataSet v;
+        int64_t movedBytes = 0;
         for (auto &resp : rpcResp.responses()) {
             if (resp.props_ref().has_value()) {
+                movedBytes += MemoryTracker::estimate(*resp.props_ref());
                 if (UNLIKELY(!v.append(std::move(*resp.props_ref())))) {
                     // it's impossible according to the interface
                     LOG(WARNING) << "Heterogeneous props dataset";
@@ -37,6 +41,16 @@ protected:
                 state = Result::State::kPartialSuccess;
             }
         }
+        addMovedBytes(movedBytes);
+        if (v.colNames.empty()) {
+            v.colNames = std::move(cached.colNames);
+        }
+        if (!cached.rows.empty()) {
+            DCHECK_EQ(v.colSize(), cached.colSize());
+            v.rows.insert(v.rows.end(),
+                          std::make_move_iterator(cached.rows.begin()),
+                          std::make_move_iterator(cached.rows.end()));
+        }
         if (!colNames.empty()) {
             DCHECK_EQ(colNames.size(), v.colSize());
             v.colNames = colNames;
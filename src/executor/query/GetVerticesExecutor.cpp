@@ -6,10 +6,10 @@
 
 #include "executor/query/GetVerticesExecutor.h"
 #include "context/QueryContext.h"
+#include "stats/StatsDef.h"
 #include "util/SchemaUtil.h"
 #include "util/ScopedTimer.h"
 
-using nebula::storage::GraphStorageClient;
 using nebula::storage::StorageRpcResponse;
 using nebula::storage::cpp2::GetPropResponse;
 
@@ -24,7 +24,6 @@ folly::Future<Status> GetVerticesExecutor::getVertices() {
     SCOPED_TIMER(&execTime_);
 
     auto *gv = asNode<GetVertices>(node());
-    GraphStorageClient *storageClient = qctx()->getStorageClient();
 
     DataSet vertices = buildRequestDataSet(gv);
     VLOG(1) << "vertices: " << vertices;
@@ -36,30 +35,172 @@ folly::Future<Status> GetVerticesExecutor::getVertices() {
                           .finish());
     }
 
+    std::string shape;
+    DataSet cached;
+    bool cacheable = isCacheable(gv);
+    if (cacheable) {
+        shape = VertexCache::shapeOf(gv->props(), gv->exprs());
+        cached = getCachedVertices(gv, shape, &vertices);
+        if (vertices.rows.empty()) {
+            if (!gv->colNames().empty()) {
+                cached.colNames = gv->colNames();
+            }
+            return finish(ResultBuilder()
+                              .value(Value(std::move(cached)))
+                              .iter(Iterator::Kind::kProp)
+                              .finish());
+        }
+    }
+
+    // The huge set of vertices is split into chunks to bound the latency and memory of each
+    // request, the order and the limit depend on the rows of all partitions
+    bool chunked = FLAGS_storage_request_chunk_size > 0 &&
+                   vertices.rows.size() > FLAGS_storage_request_chunk_size;
+    if ((FLAGS_stream_storage_responses || chunked) && gv->orderBy().empty() &&
+        gv->limit() == std::numeric_limits<int64_t>::max()) {
+        auto requests =
+            splitByParts(gv->space(), std::move(vertices), FLAGS_storage_request_chunk_size);
+        if (requests.size() > 1) {
+            return streamVertices(gv, std::move(requests), cacheable, shape, std::move(cached));
+        }
+        vertices = std::move(requests.front());
+    }
+
     time::Duration getPropsTime;
-    return DCHECK_NOTNULL(storageClient)
-        ->getProps(gv->space(),
-                   std::move(vertices),
-                   gv->props(),
-                   nullptr,
-                   gv->exprs(),
-                   gv->dedup(),
-                   gv->orderBy(),
-                   gv->limit(),
-                   gv->filter())
+    auto *coalescer = qctx()->getStorageCoalescer();
+    auto rpc = coalescer != nullptr
+                   ? sendRequest(gv, coalescer, std::move(vertices))
+                   : StorageCoalescer::RpcFuture<GetPropResponse>(
+                         sendRequest(gv, qctx()->getStorageClient(), std::move(vertices)));
+    return std::move(rpc)
         .via(runner())
         .ensure([this, getPropsTime]() {
             SCOPED_TIMER(&execTime_);
             otherStats_.emplace("total_rpc",
                                  folly::stringPrintf("%lu(us)", getPropsTime.elapsedInUSec()));
         })
-        .thenValue([this, gv](StorageRpcResponse<GetPropResponse> &&rpcResp) {
+        .thenValue([this, gv, cacheable, shape = std::move(shape), cached = std::move(cached)](
+                       StorageRpcResponse<GetPropResponse> &&rpcResp) mutable {
             SCOPED_TIMER(&execTime_);
-            addStats(rpcResp, otherStats_);
-            return handleResp(std::move(rpcResp), gv->colNames());
+            addStats(rpcResp);
+            if (cacheable) {
+                cacheVertices(gv, shape, rpcResp);
+            }
+            return handleResp(std::move(rpcResp), gv->colNames(), std::move(cached));
         });
 }
 
+folly::Future<Status> GetVerticesExecutor::streamVertices(const GetVertices *gv,
+                                                          std::vector<DataSet> requests,
+                                                          bool cacheable,
+                                                          const std::string &shape,
+                                                          DataSet cached) {
+    time::Duration getPropsTime;
+    // The requests are sent to storage directly since the coalescer would merge them back
+    auto send = [this, gv](DataSet vertices) {
+        return StorageCoalescer::RpcFuture<GetPropResponse>(
+            sendRequest(gv, qctx()->getStorageClient(), std::move(vertices)));
+    };
+    auto props = std::make_shared<DataSet>(std::move(cached));
+    auto onResp = [this, gv, props, cacheable, shape](
+                      StorageRpcResponse<GetPropResponse> &rpcResp) {
+        SCOPED_TIMER(&execTime_);
+        addStats(rpcResp);
+        if (cacheable) {
+            cacheVertices(gv, shape, rpcResp);
+        }
+        int64_t movedBytes = 0;
+        for (auto &resp : rpcResp.responses()) {
+            if (!resp.props_ref().has_value()) {
+                continue;
+            }
+            auto &ds = *resp.props_ref();
+            movedBytes += MemoryTracker::estimate(ds);
+            if (props->colNames.empty()) {
+                props->colNames = std::move(ds.colNames);
+            }
+            props->rows.insert(props->rows.end(),
+                               std::make_move_iterator(ds.rows.begin()),
+                               std::make_move_iterator(ds.rows.end()));
+        }
+        addMovedBytes(movedBytes);
+    };
+    return streamRequests<GetPropResponse>(std::move(requests),
+                                           FLAGS_storage_request_concurrency,
+                                           send,
+                                           std::move(onResp))
+        .ensure([this, getPropsTime]() {
+            SCOPED_TIMER(&execTime_);
+            otherStats_.emplace("total_rpc",
+                                 folly::stringPrintf("%lu(us)", getPropsTime.elapsedInUSec()));
+        })
+        .thenValue([this, gv, props](StorageRpcResponse<GetPropResponse> &&rpcResp) {
+            SCOPED_TIMER(&execTime_);
+            return handleResp(std::move(rpcResp), gv->colNames(), std::move(*props));
+        });
+}
+
+bool GetVerticesExecutor::isCacheable(const GetVertices *gv) const {
+    auto *cache = qctx()->vertexCache();
+    if (cache == nullptr) {
+        return false;
+    }
+    // The results depending on the other vertices are not cached
+    if (!gv->filter().empty() || !gv->orderBy().empty() ||
+        gv->limit() != std::numeric_limits<int64_t>::max()) {
+        return false;
+    }
+    auto *session = qctx()->rctx()->session();
+    return session != nullptr && session->space().id == gv->space() &&
+           cache->enabled(session->space().name);
+}
+
+DataSet GetVerticesExecutor::getCachedVertices(const GetVertices *gv,
+                                               const std::string &shape,
+                                               DataSet *vertices) {
+    auto *cache = qctx()->vertexCache();
+    cacheEpoch_ = cache->epoch();
+    DataSet cached;
+    std::vector<Row> missed;
+    for (auto &vertex : vertices->rows) {
+        Row row;
+        VertexCache::ColNames colNames;
+        if (!cache->get(gv->space(), vertex.values.front(), shape, &row, &colNames)) {
+            missed.emplace_back(std::move(vertex));
+            continue;
+        }
+        if (cached.colNames.empty()) {
+            cached.colNames = *colNames;
+        }
+        cached.rows.emplace_back(std::move(row));
+    }
+    auto hits = static_cast<int64_t>(cached.rows.size());
+    auto misses = static_cast<int64_t>(missed.size());
+    vertices->rows = std::move(missed);
+
+    stats::StatsManager::addValue(kNumVertexCacheHits, hits);
+    stats::StatsManager::addValue(kNumVertexCacheMisses, misses);
+    stats::StatsManager::addValue(kVertexCacheBytes, cache->bytes());
+    otherStats_.emplace("vertex cache", folly::stringPrintf("%ld hits, %ld misses", hits, misses));
+    return cached;
+}
+
+void GetVerticesExecutor::cacheVertices(const GetVertices *gv,
+                                        const std::string &shape,
+                                        StorageRpcResponse<GetPropResponse> &rpcResp) {
+    auto *cache = qctx()->vertexCache();
+    for (auto &resp : rpcResp.responses()) {
+        if (!resp.props_ref().has_value()) {
+            continue;
+        }
+        auto &ds = *resp.props_ref();
+        auto colNames = std::make_shared<const std::vector<std::string>>(ds.colNames);
+        for (auto &row : ds.rows) {
+            cache->put(gv->space(), row.values.front(), shape, row, colNames, cacheEpoch_);
+        }
+    }
+}
+
 DataSet GetVerticesExecutor::buildRequestDataSet(const GetVertices* gv) {
     if (gv == nullptr) {
         return nebula::DataSet({kVid});
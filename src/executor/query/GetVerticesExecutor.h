@@ -24,6 +24,41 @@ private:
     DataSet buildRequestDataSet(const GetVertices* gv);
 
     folly::Future<Status> getVertices();
+
+    // The coalescer has the same interface as the storage client
+    template <typename Client>
+    auto sendRequest(const GetVertices* gv, Client* client, DataSet vertices) {
+        return client->getProps(gv->space(),
+                                std::move(vertices),
+                                gv->props(),
+                                nullptr,
+                                gv->exprs(),
+                                gv->dedup(),
+                                gv->orderBy(),
+                                gv->limit(),
+                                gv->filter());
+    }
+
+    // Send the request of each partition alone and collect the responses as they arrive
+    folly::Future<Status> streamVertices(const GetVertices* gv,
+                                         std::vector<DataSet> requests,
+                                         bool cacheable,
+                                         const std::string& shape,
+                                         DataSet cached);
+
+    // Whether the vertices could be served by the vertex cache
+    bool isCacheable(const GetVertices* gv) const;
+
+    // Take the cached rows of `vertices' out of the cache, the hit ones are removed from it.
+    // The epoch of cache is taken before fetching the missed ones.
+    DataSet getCachedVertices(const GetVertices* gv, const std::string& shape, DataSet* vertices);
+
+    void cacheVertices(const GetVertices* gv,
+                       const std::string& shape,
+                       storage::StorageRpcResponse<storage::cpp2::GetPropResponse>& rpcResp);
+
+private:
+    uint64_t            cacheEpoch_{0};
 };
 
 }   // namespace graph
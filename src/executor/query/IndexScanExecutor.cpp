@@ -48,18 +48,30 @@ Status IndexScanExecutor::handleResp(storage::StorageRpcResponse<Resp> &&rpcResp
     }
     auto state = std::move(completeness).value();
     nebula::DataSet v;
+    size_t numRows = 0;
+    for (auto &resp : rpcResp.responses()) {
+        if (resp.data_ref().has_value()) {
+            numRows += resp.data_ref()->rows.size();
+        }
+    }
+    v.rows.reserve(numRows);
+    int64_t movedBytes = 0;
     for (auto &resp : rpcResp.responses()) {
         if (resp.data_ref().has_value()) {
             nebula::DataSet& data = *resp.data_ref();
             // TODO : convert the column name to alias.
             if (v.colNames.empty()) {
-                v.colNames = data.colNames;
+                v.colNames = std::move(data.colNames);
             }
-            v.rows.insert(v.rows.end(), data.rows.begin(), data.rows.end());
+            movedBytes += MemoryTracker::estimate(data);
+            v.rows.insert(v.rows.end(),
+                          std::make_move_iterator(data.rows.begin()),
+                          std::make_move_iterator(data.rows.end()));
         } else {
             state = Result::State::kPartialSuccess;
         }
     }
+    addMovedBytes(movedBytes);
     if (!node()->colNames().empty()) {
         DCHECK_EQ(node()->colNames().size(), v.colNames.size());
         v.colNames = node()->colNames();
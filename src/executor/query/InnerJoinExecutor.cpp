@@ -6,6 +6,7 @@
 
 #include "executor/query/InnerJoinExecutor.h"
 
+#include "context/CompiledExpression.h"
 #include "context/Iterator.h"
 #include "context/QueryExpressionContext.h"
 #include "planner/plan/Query.h"
@@ -21,7 +22,7 @@ folly::Future<Status> InnerJoinExecutor::execute() {
 
 Status InnerJoinExecutor::close() {
     exchange_ = false;
-    return Executor::close();
+    return JoinExecutor::close();
 }
 
 folly::Future<Status> InnerJoinExecutor::join() {
@@ -38,67 +39,128 @@ folly::Future<Status> InnerJoinExecutor::join() {
         return finish(ResultBuilder().value(Value(std::move(result))).finish());
     }
 
-    if (hashKeys.size() == 1 && probeKeys.size() == 1) {
-        std::unordered_map<Value, std::vector<const Row*>> hashTable;
-        hashTable.reserve(bucketSize);
+    size_t buildSize = 0;
+    if (lhsIter_->size() < rhsIter_->size()) {
+        if (shouldSpill(lhsIter_.get(), &buildSize)) {
+            return joinBySpilling(hashKeys, lhsIter_.get(), probeKeys, rhsIter_.get(), buildSize);
+        }
+    } else if (shouldSpill(rhsIter_.get(), &buildSize)) {
+        exchange_ = true;
+        return joinBySpilling(probeKeys, rhsIter_.get(), hashKeys, lhsIter_.get(), buildSize);
+    }
+
+    if (shouldJoinInParallel(lhsIter_.get(), rhsIter_.get())) {
         if (lhsIter_->size() < rhsIter_->size()) {
-            buildSingleKeyHashTable(hashKeys.front(), lhsIter_.get(), hashTable);
-            result = singleKeyProbe(probeKeys.front(), rhsIter_.get(), hashTable);
-        } else {
-            exchange_ = true;
-            buildSingleKeyHashTable(probeKeys.front(), rhsIter_.get(), hashTable);
-            result = singleKeyProbe(hashKeys.front(), lhsIter_.get(), hashTable);
+            return joinInParallel(hashKeys, lhsIter_.get(), probeKeys, rhsIter_.get());
         }
-    } else {
-        std::unordered_map<List, std::vector<const Row*>> hashTable;
-        hashTable.reserve(bucketSize);
+        exchange_ = true;
+        return joinInParallel(probeKeys, rhsIter_.get(), hashKeys, lhsIter_.get());
+    }
+
+    // The radix join needs both sides sequential, otherwise e.g. for the inputs of
+    // GetNeighbors or GetVertices, only the probe side is processed in morsels.
+    if (hashKeys.size() == 1 && probeKeys.size() == 1) {
+        auto hashTable = newHashTable<Value>(bucketSize);
         if (lhsIter_->size() < rhsIter_->size()) {
-            buildHashTable(join->hashKeys(), lhsIter_.get(), hashTable);
-            result = probe(join->probeKeys(), rhsIter_.get(), hashTable);
-        } else {
-            exchange_ = true;
-            buildHashTable(join->probeKeys(), rhsIter_.get(), hashTable);
-            result = probe(join->hashKeys(), lhsIter_.get(), hashTable);
+            buildSingleKeyHashTable(hashKeys.front(), lhsIter_.get(), hashTable);
+            return probe(probeKeys, rhsIter_.get(), std::move(hashTable));
         }
+        exchange_ = true;
+        buildSingleKeyHashTable(probeKeys.front(), rhsIter_.get(), hashTable);
+        return probe(hashKeys, lhsIter_.get(), std::move(hashTable));
     }
-    result.colNames = join->colNames();
-    return finish(ResultBuilder().value(Value(std::move(result))).finish());
+    auto hashTable = newHashTable<List>(bucketSize);
+    if (lhsIter_->size() < rhsIter_->size()) {
+        buildHashTable(hashKeys, lhsIter_.get(), hashTable);
+        return probe(probeKeys, rhsIter_.get(), std::move(hashTable));
+    }
+    exchange_ = true;
+    buildHashTable(probeKeys, rhsIter_.get(), hashTable);
+    return probe(hashKeys, lhsIter_.get(), std::move(hashTable));
+}
+
+template <class T>
+folly::Future<Status> InnerJoinExecutor::probe(const std::vector<Expression*>& probeKeys,
+                                               Iterator* probeIter,
+                                               HashTable<T>&& hashTable) {
+    // The rows of GetNeighbors could not be located by position
+    bool parallel = (probeIter->isSequentialIter() || probeIter->isPropIter()) &&
+                    shouldRunInParallel(probeIter->size());
+    if (!parallel) {
+        auto keys = CompiledExpression::compile(qctx()->objPool(), probeKeys);
+        auto result = probeRows(keys, probeIter, hashTable, probeIter->size());
+        result.colNames = node()->colNames();
+        return finish(ResultBuilder().value(Value(std::move(result))).finish());
+    }
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    struct WorkerState {
+        std::vector<std::unique_ptr<CompiledExpression>>    probeKeys;
+        std::unique_ptr<Iterator>                           probeIter;
+    };
+    std::vector<WorkerState> workers(maxNumWorkers());
+    for (auto& worker : workers) {
+        worker.probeKeys = CompiledExpression::compile(qctx()->objPool(), probeKeys);
+        worker.probeIter = probeIter->copy();
+    }
+    // The hash table is only read by workers, its memory is kept in the arena until the
+    // executor is closed
+    auto table = std::make_shared<HashTable<T>>(std::move(hashTable));
+    auto scatter = [this, table, workers = std::move(workers)](
+                       size_t worker, size_t begin, size_t end) -> DataSet {
+        auto& state = workers[worker];
+        state.probeIter->reset(begin);
+        return probeRows(state.probeKeys, state.probeIter.get(), *table, end - begin);
+    };
+    return runMorsels(probeIter->size(), std::move(scatter))
+        .thenValue([this](std::vector<DataSet> morsels) {
+            SCOPED_TIMER(&execTime_);
+            DataSet result;
+            result.colNames = node()->colNames();
+            for (auto& ds : morsels) {
+                std::move(ds.rows.begin(), ds.rows.end(), std::back_inserter(result.rows));
+            }
+            return finish(ResultBuilder().value(Value(std::move(result))).finish());
+        });
 }
 
-DataSet InnerJoinExecutor::probe(
-    const std::vector<Expression*>& probeKeys,
-    Iterator* probeIter,
-    const std::unordered_map<List, std::vector<const Row*>>& hashTable) const {
+DataSet InnerJoinExecutor::probeRows(const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+                                     Iterator* probeIter,
+                                     const HashTable<List>& hashTable,
+                                     size_t num) const {
     DataSet ds;
     QueryExpressionContext ctx(ectx_);
-    ds.rows.reserve(probeIter->size());
-    for (; probeIter->valid(); probeIter->next()) {
-        List list;
-        list.values.reserve(probeKeys.size());
-        for (auto& col : probeKeys) {
-            Value val = col->eval(ctx(probeIter));
-            list.values.emplace_back(std::move(val));
+    ds.rows.reserve(num);
+    // The buffer of key is reused by the rows
+    List list;
+    list.values.reserve(keys.size());
+    for (size_t i = 0; probeIter->valid() && i < num; probeIter->next(), ++i) {
+        list.values.clear();
+        for (auto& key : keys) {
+            list.values.emplace_back(key->eval(ctx(probeIter)));
         }
         buildNewRow<List>(hashTable, list, *probeIter->row(), ds);
     }
     return ds;
 }
 
-DataSet InnerJoinExecutor::singleKeyProbe(
-    Expression* probeKey,
-    Iterator* probeIter,
-    const std::unordered_map<Value, std::vector<const Row*>>& hashTable) const {
+DataSet InnerJoinExecutor::probeRows(const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+                                     Iterator* probeIter,
+                                     const HashTable<Value>& hashTable,
+                                     size_t num) const {
+    DCHECK_EQ(keys.size(), 1U);
     DataSet ds;
     QueryExpressionContext ctx(ectx_);
-    for (; probeIter->valid(); probeIter->next()) {
-        auto& val = probeKey->eval(ctx(probeIter));
+    auto& key = keys.front();
+    for (size_t i = 0; probeIter->valid() && i < num; probeIter->next(), ++i) {
+        auto& val = key->eval(ctx(probeIter));
         buildNewRow<Value>(hashTable, val, *probeIter->row(), ds);
     }
     return ds;
 }
 
 template <class T>
-void InnerJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<const Row*>>& hashTable,
+void InnerJoinExecutor::buildNewRow(const HashTable<T>& hashTable,
                                     const T& val,
                                     const Row& rRow,
                                     DataSet& ds) const {
@@ -106,7 +168,15 @@ void InnerJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<cons
     if (range == hashTable.end()) {
         return;
     }
-    for (auto* row : range->second) {
+    joinRow(rRow, folly::range(range->second.data(), range->second.data() + range->second.size()),
+            &ds);
+}
+
+void InnerJoinExecutor::joinRow(const Row& probeRow,
+                                folly::Range<const Row* const*> matched,
+                                DataSet* ds) const {
+    auto& rRow = probeRow;
+    for (auto* row : matched) {
         auto& lRow = *row;
         Row newRow;
         newRow.reserve(lRow.size() + rRow.size());
@@ -122,7 +192,7 @@ void InnerJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<cons
                     std::make_move_iterator(rRow.values.begin()),
                     std::make_move_iterator(rRow.values.end()));
         }
-        ds.rows.emplace_back(std::move(newRow));
+        ds->rows.emplace_back(std::move(newRow));
     }
 }
 }   // namespace graph
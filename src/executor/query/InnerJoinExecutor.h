@@ -12,6 +12,8 @@
 namespace nebula {
 namespace graph {
 
+class CompiledExpression;
+
 class InnerJoinExecutor final : public JoinExecutor {
 public:
     InnerJoinExecutor(const PlanNode* node, QueryContext* qctx)
@@ -24,21 +26,34 @@ public:
 private:
     folly::Future<Status> join();
 
-    DataSet probe(const std::vector<Expression*>& probeKeys,
-                  Iterator* probeIter,
-                  const std::unordered_map<List, std::vector<const Row*>>& hashTable) const;
+    // Probe the hash table by the rows of `probeIter', which are split into morsels and
+    // probed in parallel if they're many
+    template <class T>
+    folly::Future<Status> probe(const std::vector<Expression*>& probeKeys,
+                                Iterator* probeIter,
+                                HashTable<T>&& hashTable);
+
+    // Probe `num' rows from the current position of `probeIter'
+    DataSet probeRows(const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+                      Iterator* probeIter,
+                      const HashTable<List>& hashTable,
+                      size_t num) const;
 
-    DataSet singleKeyProbe(
-        Expression* probeKey,
-        Iterator* probeIter,
-        const std::unordered_map<Value, std::vector<const Row*>>& hashTable) const;
+    DataSet probeRows(const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+                      Iterator* probeIter,
+                      const HashTable<Value>& hashTable,
+                      size_t num) const;
 
     template <class T>
-    void buildNewRow(const std::unordered_map<T, std::vector<const Row*>>& hashTable,
+    void buildNewRow(const HashTable<T>& hashTable,
                      const T& val,
                      const Row& rRow,
                      DataSet& ds) const;
 
+    void joinRow(const Row& probeRow,
+                 folly::Range<const Row* const*> matched,
+                 DataSet* ds) const override;
+
 private:
     bool exchange_{false};
 };
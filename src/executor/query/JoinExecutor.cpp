@@ -6,13 +6,181 @@
 
 #include "executor/query/JoinExecutor.h"
 
+#include <folly/hash/Hash.h>
+
 #include "planner/plan/Query.h"
+#include "context/CompiledExpression.h"
 #include "context/QueryExpressionContext.h"
 #include "context/Iterator.h"
+#include "service/GraphFlags.h"
+#include "util/ScopedTimer.h"
+
+DECLARE_bool(enable_lifetime_optimize);
 
 namespace nebula {
 namespace graph {
 
+namespace {
+
+// Max number of partitions of the grace hash join, i.e. the files opened at the same time
+constexpr size_t kMaxSpillPartitions = 128;
+// Max times of partitioning the rows, a partition whose build side still exceeds the budget
+// is partitioned again, except the rows of a too frequent key which are never split
+constexpr size_t kMaxSpillDepth = 3;
+
+Value evalKey(const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+             QueryExpressionContext& ctx) {
+    if (keys.size() == 1) {
+        return keys.front()->eval(ctx);
+    }
+    List list;
+    list.values.reserve(keys.size());
+    for (auto& expr : keys) {
+        list.values.emplace_back(expr->eval(ctx));
+    }
+    return Value(std::move(list));
+}
+
+uint64_t hashKey(const Value& key) {
+    // Mix the hash since the hash of integers is themselves
+    return folly::hash::twang_mix64(std::hash<Value>()(key));
+}
+
+// The partition of the key when the rows are partitioned `depth' times before
+size_t partitionOf(const Value& key, size_t depth, size_t numPartitions) {
+    auto hash = hashKey(key);
+    if (depth > 0) {
+        // Otherwise the rows of a partition all fall into the same one again
+        hash = folly::hash::hash_128_to_64(hash, depth);
+    }
+    return hash % numPartitions;
+}
+
+// Number of partitions to split the build rows of `size' bytes into the ones fitting in
+// `budget'. Twice as many partitions as needed to tolerate the skew of keys, and the
+// buffers of the files of both sides take no more than half of the budget.
+size_t numSpillPartitions(size_t size, size_t budget) {
+    auto maxPartitions = std::min(kMaxSpillPartitions, budget / (4 * SpillFile::kBufferSize));
+    return std::max<size_t>(2, std::min(size / budget * 2 + 2, maxPartitions));
+}
+
+// The budget left for the hash tables of partitions besides the file buffers
+size_t tableBudget(size_t budget, size_t numPartitions) {
+    auto buffers = 2 * numPartitions * SpillFile::kBufferSize;
+    return budget > buffers ? budget - buffers : 0;
+}
+
+Status makeSpillFiles(size_t num, std::vector<std::unique_ptr<SpillFile>>& files) {
+    files.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        auto file = SpillFile::make(FLAGS_spill_tmp_dir);
+        NG_RETURN_IF_ERROR(file);
+        files.emplace_back(std::move(file).value());
+    }
+    return Status::OK();
+}
+
+// The join key of a row and its hash
+struct HashedRow {
+    uint64_t            hash;
+    Value               key;
+    const Row*          row;
+};
+
+// The rows of a morsel scattered into partitions
+using Partitions = std::vector<std::vector<HashedRow>>;
+
+// The open addressing hash table of the distinct keys in one partition of the build side,
+// the build rows of the same key are stored contiguously in the input order.
+class PartitionTable final {
+public:
+    PartitionTable(const std::vector<Partitions>& morsels, size_t partition, size_t numPartitions)
+        : numPartitions_(numPartitions) {
+        size_t numRows = 0;
+        for (auto& morsel : morsels) {
+            numRows += morsel[partition].size();
+        }
+        size_t capacity = 8;
+        while (capacity < numRows * 2) {
+            capacity <<= 1;
+        }
+        mask_ = capacity - 1;
+        slots_.resize(capacity, kEmpty);
+
+        std::vector<uint32_t> keyIds;
+        keyIds.reserve(numRows);
+        std::vector<uint32_t> counts;
+        for (auto& morsel : morsels) {
+            for (auto& hashed : morsel[partition]) {
+                auto& slot = slots_[locate(hashed)];
+                if (slot == kEmpty) {
+                    slot = keys_.size();
+                    keys_.emplace_back(&hashed);
+                    counts.emplace_back(0);
+                }
+                keyIds.emplace_back(slot);
+                ++counts[slot];
+            }
+        }
+
+        offsets_.resize(keys_.size() + 1, 0);
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            offsets_[i + 1] = offsets_[i] + counts[i];
+            // Reuse as the position to put the next row of key
+            counts[i] = offsets_[i];
+        }
+        rows_.resize(numRows);
+        size_t i = 0;
+        for (auto& morsel : morsels) {
+            for (auto& hashed : morsel[partition]) {
+                rows_[counts[keyIds[i++]]++] = hashed.row;
+            }
+        }
+    }
+
+    folly::Range<const Row* const*> find(const HashedRow& hashed) const {
+        auto id = slots_[locate(hashed)];
+        if (id == kEmpty) {
+            return {};
+        }
+        return folly::Range<const Row* const*>(rows_.data() + offsets_[id],
+                                               rows_.data() + offsets_[id + 1]);
+    }
+
+private:
+    static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+    // Return the slot of the key, or the empty slot to put it
+    size_t locate(const HashedRow& hashed) const {
+        // The remainder has chosen the partition, so use the quotient
+        size_t pos = (hashed.hash / numPartitions_) & mask_;
+        while (slots_[pos] != kEmpty) {
+            auto* key = keys_[slots_[pos]];
+            if (key->hash == hashed.hash && key->key == hashed.key) {
+                break;
+            }
+            pos = (pos + 1) & mask_;
+        }
+        return pos;
+    }
+
+    size_t                                  numPartitions_;
+    size_t                                  mask_{0};
+    std::vector<uint32_t>                   slots_;
+    // The first row of each distinct key
+    std::vector<const HashedRow*>           keys_;
+    std::vector<uint32_t>                   offsets_;
+    std::vector<const Row*>                 rows_;
+};
+
+}   // namespace
+
+Status JoinExecutor::close() {
+    // The hash table has been destroyed with the join
+    arena_.reset();
+    return Executor::close();
+}
+
 Status JoinExecutor::checkInputDataSets() {
     auto* join = asNode<Join>(node());
     lhsIter_ = ectx_->getVersionedResult(join->leftVar().first, join->leftVar().second).iter();
@@ -36,36 +204,320 @@ Status JoinExecutor::checkInputDataSets() {
     return Status::OK();
 }
 
-void JoinExecutor::buildHashTable(
-    const std::vector<Expression*>& hashKeys,
-    Iterator* iter,
-    std::unordered_map<List, std::vector<const Row*>>& hashTable) const {
+void JoinExecutor::buildHashTable(const std::vector<Expression*>& hashKeys,
+                                  Iterator* iter,
+                                  HashTable<List>& hashTable) const {
     QueryExpressionContext ctx(ectx_);
+    auto keys = CompiledExpression::compile(qctx()->objPool(), hashKeys);
+    RowList::allocator_type allocator(hashTable.get_allocator());
+    // The buffer of key is reused by the rows, and copied only for a new key of the table
+    List list;
+    list.values.reserve(keys.size());
     for (; iter->valid(); iter->next()) {
-        List list;
-        list.values.reserve(hashKeys.size());
-        for (auto& col : hashKeys) {
-            Value val = col->eval(ctx(iter));
-            list.values.emplace_back(std::move(val));
+        list.values.clear();
+        for (auto& key : keys) {
+            list.values.emplace_back(key->eval(ctx(iter)));
         }
 
-        auto& vals = hashTable[list];
-        vals.emplace_back(iter->row());
+        auto found = hashTable.find(list);
+        if (found == hashTable.end()) {
+            found = hashTable.emplace(list, RowList(allocator)).first;
+        }
+        found->second.emplace_back(iter->row());
     }
 }
 
-void JoinExecutor::buildSingleKeyHashTable(
-    Expression* hashKey,
-    Iterator* iter,
-    std::unordered_map<Value, std::vector<const Row*>>& hashTable) const {
+void JoinExecutor::buildSingleKeyHashTable(Expression* hashKey,
+                                           Iterator* iter,
+                                           HashTable<Value>& hashTable) const {
     QueryExpressionContext ctx(ectx_);
+    auto key = CompiledExpression::compile(qctx()->objPool(), hashKey);
+    RowList::allocator_type allocator(hashTable.get_allocator());
     for (; iter->valid(); iter->next()) {
-        auto& val = hashKey->eval(ctx(iter));
+        auto& val = key->eval(ctx(iter));
 
-        auto& vals = hashTable[val];
-        vals.emplace_back(iter->row());
+        auto found = hashTable.find(val);
+        if (found == hashTable.end()) {
+            found = hashTable.emplace(val, RowList(allocator)).first;
+        }
+        found->second.emplace_back(iter->row());
     }
 }
 
+bool JoinExecutor::shouldJoinInParallel(Iterator* buildIter, Iterator* probeIter) const {
+    return buildIter->isSequentialIter() && probeIter->isSequentialIter() &&
+           shouldRunInParallel(buildIter->size() + probeIter->size());
+}
+
+folly::Future<Status> JoinExecutor::joinInParallel(const std::vector<Expression*>& buildKeys,
+                                                   Iterator* buildIter,
+                                                   const std::vector<Expression*>& probeKeys,
+                                                   Iterator* probeIter) {
+    const size_t numWorkers = maxNumWorkers();
+    const size_t partitionSize = std::max(FLAGS_join_partition_size, 1U);
+    const size_t numPartitions = std::max(numWorkers, buildIter->size() / partitionSize + 1);
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    struct WorkerState {
+        std::vector<std::unique_ptr<CompiledExpression>>    buildKeys;
+        std::vector<std::unique_ptr<CompiledExpression>>    probeKeys;
+        std::unique_ptr<Iterator>                           buildIter;
+        std::unique_ptr<Iterator>                           probeIter;
+    };
+    auto workers = std::make_shared<std::vector<WorkerState>>(numWorkers);
+    for (auto& worker : *workers) {
+        worker.buildKeys = CompiledExpression::compile(qctx()->objPool(), buildKeys);
+        worker.probeKeys = CompiledExpression::compile(qctx()->objPool(), probeKeys);
+        worker.buildIter = buildIter->copy();
+        worker.probeIter = probeIter->copy();
+    }
+
+    auto scatter = [this, numPartitions](
+                       const std::vector<std::unique_ptr<CompiledExpression>>& keys,
+                       Iterator* iter,
+                       size_t begin,
+                       size_t end) {
+        QueryExpressionContext ctx(ectx_);
+        Partitions partitions(numPartitions);
+        iter->reset(begin);
+        for (size_t pos = begin; pos < end; ++pos, iter->next()) {
+            auto key = evalKey(keys, ctx(iter));
+            auto hash = hashKey(key);
+            partitions[hash % numPartitions].emplace_back(
+                HashedRow{hash, std::move(key), iter->row()});
+        }
+        return partitions;
+    };
+
+    auto probeSize = probeIter->size();
+    return runMorsels(buildIter->size(),
+                      [workers, scatter](size_t worker, size_t begin, size_t end) {
+                          auto& state = (*workers)[worker];
+                          return scatter(state.buildKeys, state.buildIter.get(), begin, end);
+                      })
+        .thenValue([this, workers, scatter, probeSize](std::vector<Partitions> build) {
+            return runMorsels(probeSize,
+                              [workers, scatter](size_t worker, size_t begin, size_t end) {
+                                  auto& state = (*workers)[worker];
+                                  return scatter(
+                                      state.probeKeys, state.probeIter.get(), begin, end);
+                              })
+                .thenValue([build = std::move(build)](std::vector<Partitions> probe) mutable {
+                    return std::make_pair(std::move(build), std::move(probe));
+                });
+        })
+        .thenValue([this, numPartitions](
+                       std::pair<std::vector<Partitions>, std::vector<Partitions>> sides) {
+            auto shared = std::make_shared<decltype(sides)>(std::move(sides));
+            auto joinPartitions = [this, shared, numPartitions](
+                                      size_t, size_t begin, size_t end) {
+                DataSet ds;
+                for (size_t p = begin; p < end; ++p) {
+                    PartitionTable table(shared->first, p, numPartitions);
+                    for (auto& morsel : shared->second) {
+                        for (auto& hashed : morsel[p]) {
+                            joinRow(*hashed.row, table.find(hashed), &ds);
+                        }
+                    }
+                }
+                return ds;
+            };
+            return runMorsels(numPartitions, std::move(joinPartitions), 1);
+        })
+        .thenValue([this](std::vector<DataSet> partitions) {
+            SCOPED_TIMER(&execTime_);
+            DataSet result;
+            result.colNames = node()->colNames();
+            for (auto& ds : partitions) {
+                std::move(ds.rows.begin(), ds.rows.end(), std::back_inserter(result.rows));
+            }
+            return finish(ResultBuilder().value(Value(std::move(result))).finish());
+        });
+}
+
+bool JoinExecutor::shouldSpill(Iterator* buildIter, size_t* buildSize) const {
+    if (FLAGS_query_spill_memory_bytes <= 0) {
+        return false;
+    }
+    auto budget = static_cast<size_t>(FLAGS_query_spill_memory_bytes);
+    size_t size = 0;
+    size_t num = 0;
+    for (auto iter = buildIter->copy(); iter->valid(); iter->next()) {
+        // The row and its entry in hash table
+        size += SpillFile::estimateSize(*iter->row()) + sizeof(Value) + sizeof(const Row*);
+        if (size > budget) {
+            // Estimate by the scanned rows instead of scanning all of them
+            *buildSize = size / (num + 1) * buildIter->size();
+            return true;
+        }
+        num++;
+    }
+    *buildSize = size;
+    return false;
+}
+
+folly::Future<Status> JoinExecutor::joinBySpilling(const std::vector<Expression*>& buildKeys,
+                                                   Iterator* buildIter,
+                                                   const std::vector<Expression*>& probeKeys,
+                                                   Iterator* probeIter,
+                                                   size_t buildSize) {
+    auto budget = static_cast<size_t>(FLAGS_query_spill_memory_bytes);
+    auto numPartitions = numSpillPartitions(buildSize, budget);
+    std::vector<std::unique_ptr<SpillFile>> buildFiles;
+    std::vector<std::unique_ptr<SpillFile>> probeFiles;
+    NG_RETURN_IF_ERROR(makeSpillFiles(numPartitions, buildFiles));
+    NG_RETURN_IF_ERROR(makeSpillFiles(numPartitions, probeFiles));
+    NG_RETURN_IF_ERROR(spill(buildKeys, buildIter, buildFiles));
+    NG_RETURN_IF_ERROR(spill(probeKeys, probeIter, probeFiles));
+
+    // The inputs are on disk now, release them if no one else reads them
+    lhsIter_.reset();
+    rhsIter_.reset();
+    if (FLAGS_enable_lifetime_optimize) {
+        drop();
+    }
+
+    numSpillPartitions_ = 0;
+    numRepartitions_ = 0;
+    spilledBytes_ = 0;
+    DataSet result;
+    result.colNames = node()->colNames();
+    NG_RETURN_IF_ERROR(joinPartitions(
+        buildFiles, probeFiles, tableBudget(budget, numPartitions), 0, &result));
+    otherStats_.emplace("spill",
+                        folly::stringPrintf("%lu partitions, %lu repartitioned, %lu bytes",
+                                            numSpillPartitions_,
+                                            numRepartitions_,
+                                            spilledBytes_));
+    // The inputs have been dropped
+    return setOutput(ResultBuilder().value(Value(std::move(result))).finish());
+}
+
+Status JoinExecutor::spill(const std::vector<Expression*>& keys,
+                           Iterator* iter,
+                           std::vector<std::unique_ptr<SpillFile>>& files) const {
+    QueryExpressionContext ctx(ectx_);
+    auto compiledKeys = CompiledExpression::compile(qctx()->objPool(), keys);
+    for (; iter->valid(); iter->next()) {
+        auto& values = iter->row()->values;
+        Row row;
+        row.values.reserve(values.size() + 1);
+        row.values.emplace_back(evalKey(compiledKeys, ctx(iter)));
+        row.values.insert(row.values.end(), values.begin(), values.end());
+        auto partition = partitionOf(row.values.front(), 0, files.size());
+        NG_RETURN_IF_ERROR(files[partition]->write(row));
+    }
+    for (auto& file : files) {
+        NG_RETURN_IF_ERROR(file->rewind());
+    }
+    return Status::OK();
+}
+
+Status JoinExecutor::scatter(SpillFile* file,
+                             size_t depth,
+                             std::vector<std::unique_ptr<SpillFile>>& files) const {
+    Row row;
+    while (true) {
+        auto ret = file->read(&row);
+        NG_RETURN_IF_ERROR(ret);
+        if (!ret.value()) {
+            break;
+        }
+        auto partition = partitionOf(row.values.front(), depth, files.size());
+        NG_RETURN_IF_ERROR(files[partition]->write(row));
+    }
+    for (auto& partition : files) {
+        NG_RETURN_IF_ERROR(partition->rewind());
+    }
+    return Status::OK();
+}
+
+Status JoinExecutor::joinPartitions(std::vector<std::unique_ptr<SpillFile>>& buildFiles,
+                                    std::vector<std::unique_ptr<SpillFile>>& probeFiles,
+                                    size_t budget,
+                                    size_t depth,
+                                    DataSet* ds) {
+    for (size_t i = 0; i < buildFiles.size(); ++i) {
+        numSpillPartitions_++;
+        spilledBytes_ += buildFiles[i]->size() + probeFiles[i]->size();
+        NG_RETURN_IF_ERROR(
+            joinPartition(buildFiles[i].get(), probeFiles[i].get(), budget, depth, ds));
+        // Close the files of the joined partition to release their buffers
+        buildFiles[i].reset();
+        probeFiles[i].reset();
+    }
+    return Status::OK();
+}
+
+Status JoinExecutor::joinPartition(SpillFile* buildFile,
+                                   SpillFile* probeFile,
+                                   size_t budget,
+                                   size_t depth,
+                                   DataSet* ds) {
+    std::vector<Row> buildRows;
+    size_t size = 0;
+    Row row;
+    while (true) {
+        auto ret = buildFile->read(&row);
+        NG_RETURN_IF_ERROR(ret);
+        if (!ret.value()) {
+            break;
+        }
+        size += SpillFile::estimateSize(row) + sizeof(Value) + sizeof(const Row*);
+        if (size > budget && depth + 1 < kMaxSpillDepth) {
+            // Estimate by the loaded rows and partition the rows again
+            auto buildSize = size / (buildRows.size() + 1) * buildFile->numRows();
+            buildRows = std::vector<Row>();
+            return repartition(buildFile, probeFile, buildSize, budget, depth + 1, ds);
+        }
+        buildRows.emplace_back(std::move(row));
+    }
+
+    std::unordered_map<Value, std::vector<const Row*>> hashTable;
+    hashTable.reserve(buildRows.size());
+    for (auto& buildRow : buildRows) {
+        auto key = std::move(buildRow.values.front());
+        buildRow.values.erase(buildRow.values.begin());
+        hashTable[std::move(key)].emplace_back(&buildRow);
+    }
+
+    while (true) {
+        auto ret = probeFile->read(&row);
+        NG_RETURN_IF_ERROR(ret);
+        if (!ret.value()) {
+            break;
+        }
+        auto key = std::move(row.values.front());
+        row.values.erase(row.values.begin());
+        auto found = hashTable.find(key);
+        if (found == hashTable.end()) {
+            joinRow(row, {}, ds);
+        } else {
+            auto& matched = found->second;
+            joinRow(row, folly::range(matched.data(), matched.data() + matched.size()), ds);
+        }
+    }
+    return Status::OK();
+}
+
+Status JoinExecutor::repartition(SpillFile* buildFile,
+                                 SpillFile* probeFile,
+                                 size_t buildSize,
+                                 size_t budget,
+                                 size_t depth,
+                                 DataSet* ds) {
+    numRepartitions_++;
+    auto numPartitions = numSpillPartitions(buildSize, std::max<size_t>(budget, 1));
+    std::vector<std::unique_ptr<SpillFile>> buildFiles;
+    std::vector<std::unique_ptr<SpillFile>> probeFiles;
+    NG_RETURN_IF_ERROR(makeSpillFiles(numPartitions, buildFiles));
+    NG_RETURN_IF_ERROR(makeSpillFiles(numPartitions, probeFiles));
+    NG_RETURN_IF_ERROR(buildFile->rewind());
+    NG_RETURN_IF_ERROR(scatter(buildFile, depth, buildFiles));
+    NG_RETURN_IF_ERROR(scatter(probeFile, depth, probeFiles));
+    return joinPartitions(
+        buildFiles, probeFiles, tableBudget(budget, numPartitions), depth, ds);
+}
+
 }  // namespace graph
 }  // namespace nebula
@@ -7,7 +7,12 @@
 #ifndef EXECUTOR_QUERY_JOINEXECUTOR_H_
 #define EXECUTOR_QUERY_JOINEXECUTOR_H_
 
+#include <folly/Range.h>
+
+#include "context/QueryContext.h"
 #include "executor/Executor.h"
+#include "util/Arena.h"
+#include "util/SpillFile.h"
 
 namespace nebula {
 namespace graph {
@@ -19,21 +24,116 @@ public:
 
     Status checkInputDataSets();
 
+    Status close() override;
+
     void buildHashTable(const std::vector<Expression*>& hashKeys, Iterator* iter);
 
 protected:
+    // The buckets, nodes and row lists of the hash table are allocated in the arena of
+    // executor, which is released once the join is done. The keys and the joined rows are
+    // Value, List and Row of nebula-common, whose members always use the global heap, so
+    // they are not in the arena; a key is allocated once per distinct key instead.
+    using RowList = ArenaVector<const Row*>;
+
+    template <typename K>
+    using HashTable = std::unordered_map<K,
+                                         RowList,
+                                         std::hash<K>,
+                                         std::equal_to<K>,
+                                         ArenaAllocator<std::pair<const K, RowList>>>;
+
+    template <typename K>
+    HashTable<K> newHashTable(size_t bucketSize) {
+        using Allocator = typename HashTable<K>::allocator_type;
+        arena_ = std::make_unique<Arena>(memTracker_);
+        return HashTable<K>(
+            bucketSize, std::hash<K>(), std::equal_to<K>(), Allocator(arena_.get()));
+    }
+
     void buildHashTable(const std::vector<Expression*>& hashKeys,
                         Iterator* iter,
-                        std::unordered_map<List, std::vector<const Row*>>& hashTable) const;
+                        HashTable<List>& hashTable) const;
+
+    void buildSingleKeyHashTable(Expression* hashKey,
+                                 Iterator* iter,
+                                 HashTable<Value>& hashTable) const;
+
+    // Whether to join by the radix partitioned hash join
+    bool shouldJoinInParallel(Iterator* buildIter, Iterator* probeIter) const;
+
+    // Scatter the rows of both sides into partitions by the hash of keys in morsels, the
+    // partitions are sized to let their hash tables fit in cache, then build a flat hash
+    // table for each partition and probe it, the partitions are joined in parallel.
+    // The output rows are grouped by partitions.
+    folly::Future<Status> joinInParallel(const std::vector<Expression*>& buildKeys,
+                                         Iterator* buildIter,
+                                         const std::vector<Expression*>& probeKeys,
+                                         Iterator* probeIter);
+
+    // Whether the hash table built on `buildIter' exceeds the memory budget of query,
+    // `buildSize' is set to its estimated bytes
+    bool shouldSpill(Iterator* buildIter, size_t* buildSize) const;
 
-    void buildSingleKeyHashTable(
-        Expression* hashKey,
-        Iterator* iter,
-        std::unordered_map<Value, std::vector<const Row*>>& hashTable) const;
+    // Grace hash join: scatter both sides into partitions in temporary files by the hash
+    // of keys and release the inputs, then load the build side of each partition into
+    // memory and stream its probe side. A partition still exceeding the budget is
+    // partitioned again by another hash, up to a few times.
+    folly::Future<Status> joinBySpilling(const std::vector<Expression*>& buildKeys,
+                                         Iterator* buildIter,
+                                         const std::vector<Expression*>& probeKeys,
+                                         Iterator* probeIter,
+                                         size_t buildSize);
 
+    // Append the joined rows of `probeRow' and its matched build rows to `ds'
+    virtual void joinRow(const Row& probeRow,
+                         folly::Range<const Row* const*> matched,
+                         DataSet* ds) const = 0;
+
+private:
+    // Write the rows of `iter' into `files' by the hash of keys, the key is put at the first
+    // column of each row
+    Status spill(const std::vector<Expression*>& keys,
+                 Iterator* iter,
+                 std::vector<std::unique_ptr<SpillFile>>& files) const;
+
+    // Write the spilled rows of `file' into `files' by the hash of keys at the `depth'
+    Status scatter(SpillFile* file,
+                   size_t depth,
+                   std::vector<std::unique_ptr<SpillFile>>& files) const;
+
+    // Join the partitions one by one, the hash table of each one is built within `budget'
+    Status joinPartitions(std::vector<std::unique_ptr<SpillFile>>& buildFiles,
+                          std::vector<std::unique_ptr<SpillFile>>& probeFiles,
+                          size_t budget,
+                          size_t depth,
+                          DataSet* ds);
+
+    Status joinPartition(SpillFile* buildFile,
+                         SpillFile* probeFile,
+                         size_t budget,
+                         size_t depth,
+                         DataSet* ds);
+
+    // Partition the rows of a partition exceeding the budget again by another hash
+    Status repartition(SpillFile* buildFile,
+                       SpillFile* probeFile,
+                       size_t buildSize,
+                       size_t budget,
+                       size_t depth,
+                       DataSet* ds);
+
+protected:
     std::unique_ptr<Iterator>                          lhsIter_;
     std::unique_ptr<Iterator>                          rhsIter_;
     size_t                                             colSize_{0};
+
+private:
+    // The arena of the hash table of current run, the memory is accounted to the executor
+    std::unique_ptr<Arena>                             arena_;
+    // Statistics of the grace hash join
+    size_t                                             numSpillPartitions_{0};
+    size_t                                             numRepartitions_{0};
+    size_t                                             spilledBytes_{0};
 };
 }  // namespace graph
 }  // namespace nebula
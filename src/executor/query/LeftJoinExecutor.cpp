@@ -6,6 +6,7 @@
 
 #include "executor/query/LeftJoinExecutor.h"
 
+#include "context/CompiledExpression.h"
 #include "context/Iterator.h"
 #include "context/QueryExpressionContext.h"
 #include "planner/plan/Query.h"
@@ -20,7 +21,7 @@ folly::Future<Status> LeftJoinExecutor::execute() {
 }
 
 Status LeftJoinExecutor::close() {
-    return Executor::close();
+    return JoinExecutor::close();
 }
 
 folly::Future<Status> LeftJoinExecutor::join() {
@@ -33,16 +34,23 @@ folly::Future<Status> LeftJoinExecutor::join() {
     DCHECK_EQ(hashKeys.size(), probeKeys.size());
     DataSet result;
 
+    size_t buildSize = 0;
+    if (!lhsIter_->empty() && shouldSpill(rhsIter_.get(), &buildSize)) {
+        return joinBySpilling(probeKeys, rhsIter_.get(), hashKeys, lhsIter_.get(), buildSize);
+    }
+
+    if (!lhsIter_->empty() && shouldJoinInParallel(rhsIter_.get(), lhsIter_.get())) {
+        return joinInParallel(probeKeys, rhsIter_.get(), hashKeys, lhsIter_.get());
+    }
+
     if (hashKeys.size() == 1 && probeKeys.size() == 1) {
-        std::unordered_map<Value, std::vector<const Row*>> hashTable;
-        hashTable.reserve(rhsIter_->size() == 0 ? 1 : rhsIter_->size());
+        auto hashTable = newHashTable<Value>(rhsIter_->size() == 0 ? 1 : rhsIter_->size());
         if (!lhsIter_->empty()) {
             buildSingleKeyHashTable(join->probeKeys().front(), rhsIter_.get(), hashTable);
             result = singleKeyProbe(join->hashKeys().front(), lhsIter_.get(), hashTable);
         }
     } else {
-        std::unordered_map<List, std::vector<const Row*>> hashTable;
-        hashTable.reserve(rhsIter_->size() == 0 ? 1 : rhsIter_->size());
+        auto hashTable = newHashTable<List>(rhsIter_->size() == 0 ? 1 : rhsIter_->size());
         if (!lhsIter_->empty()) {
             buildHashTable(join->probeKeys(), rhsIter_.get(), hashTable);
             result = probe(join->hashKeys(), lhsIter_.get(), hashTable);
@@ -57,16 +65,18 @@ folly::Future<Status> LeftJoinExecutor::join() {
 DataSet LeftJoinExecutor::probe(
     const std::vector<Expression*>& probeKeys,
     Iterator* probeIter,
-    const std::unordered_map<List, std::vector<const Row*>>& hashTable) const {
+    const HashTable<List>& hashTable) const {
     DataSet ds;
     ds.rows.reserve(probeIter->size());
     QueryExpressionContext ctx(ectx_);
+    auto keys = CompiledExpression::compile(qctx()->objPool(), probeKeys);
+    // The buffer of key is reused by the rows
+    List list;
+    list.values.reserve(keys.size());
     for (; probeIter->valid(); probeIter->next()) {
-        List list;
-        list.values.reserve(probeKeys.size());
-        for (auto& col : probeKeys) {
-            Value val = col->eval(ctx(probeIter));
-            list.values.emplace_back(std::move(val));
+        list.values.clear();
+        for (auto& key : keys) {
+            list.values.emplace_back(key->eval(ctx(probeIter)));
         }
 
         buildNewRow<List>(hashTable, list, *probeIter->row(), ds);
@@ -77,24 +87,38 @@ DataSet LeftJoinExecutor::probe(
 DataSet LeftJoinExecutor::singleKeyProbe(
     Expression* probeKey,
     Iterator* probeIter,
-    const std::unordered_map<Value, std::vector<const Row*>>& hashTable) const {
+    const HashTable<Value>& hashTable) const {
     DataSet ds;
     ds.rows.reserve(probeIter->size());
     QueryExpressionContext ctx(ectx_);
+    auto key = CompiledExpression::compile(qctx()->objPool(), probeKey);
     for (; probeIter->valid(); probeIter->next()) {
-        auto& val = probeKey->eval(ctx(probeIter));
+        auto& val = key->eval(ctx(probeIter));
         buildNewRow<Value>(hashTable, val, *probeIter->row(), ds);
     }
     return ds;
 }
 
 template <class T>
-void LeftJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<const Row*>>& hashTable,
+void LeftJoinExecutor::buildNewRow(const HashTable<T>& hashTable,
                                    const T& val,
                                    const Row& lRow,
                                    DataSet& ds) const {
     auto range = hashTable.find(val);
     if (range == hashTable.end()) {
+        joinRow(lRow, {}, &ds);
+    } else {
+        joinRow(lRow,
+                folly::range(range->second.data(), range->second.data() + range->second.size()),
+                &ds);
+    }
+}
+
+void LeftJoinExecutor::joinRow(const Row& probeRow,
+                               folly::Range<const Row* const*> matched,
+                               DataSet* ds) const {
+    auto& lRow = probeRow;
+    if (matched.empty()) {
         auto lRowSize = lRow.size();
         Row newRow;
         newRow.reserve(colSize_);
@@ -103,9 +127,9 @@ void LeftJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<const
                 std::make_move_iterator(lRow.values.begin()),
                 std::make_move_iterator(lRow.values.end()));
         values.insert(values.end(), colSize_ - lRowSize, Value::kEmpty);
-        ds.rows.emplace_back(std::move(newRow));
+        ds->rows.emplace_back(std::move(newRow));
     } else {
-        for (auto* row : range->second) {
+        for (auto* row : matched) {
             auto& rRow = *row;
             Row newRow;
             auto& values = newRow.values;
@@ -114,7 +138,7 @@ void LeftJoinExecutor::buildNewRow(const std::unordered_map<T, std::vector<const
                     std::make_move_iterator(lRow.values.begin()),
                     std::make_move_iterator(lRow.values.end()));
             values.insert(values.end(), rRow.values.begin(), rRow.values.end());
-            ds.rows.emplace_back(std::move(newRow));
+            ds->rows.emplace_back(std::move(newRow));
         }
     }
 }
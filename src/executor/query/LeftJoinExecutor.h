@@ -26,19 +26,23 @@ private:
 
     DataSet probe(const std::vector<Expression*>& probeKeys,
                   Iterator* probeIter,
-                  const std::unordered_map<List, std::vector<const Row*>>& hashTable) const;
+                  const HashTable<List>& hashTable) const;
 
     DataSet singleKeyProbe(
         Expression* probeKey,
         Iterator* probeIter,
-        const std::unordered_map<Value, std::vector<const Row*>>& hashTable) const;
+        const HashTable<Value>& hashTable) const;
 
     template <class T>
-    void buildNewRow(const std::unordered_map<T, std::vector<const Row*>>& hashTable,
+    void buildNewRow(const HashTable<T>& hashTable,
                      const T& val,
                      const Row& lRow,
                      DataSet& ds) const;
 
+    void joinRow(const Row& probeRow,
+                 folly::Range<const Row* const*> matched,
+                 DataSet* ds) const override;
+
 private:
     size_t rightColSize_{0};
 };
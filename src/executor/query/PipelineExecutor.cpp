@@ -0,0 +1,464 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "executor/query/PipelineExecutor.h"
+
+#include "common/interface/gen-cpp2/graph_types.h"
+#include "context/CompiledExpression.h"
+#include "context/Iterator.h"
+#include "context/QueryExpressionContext.h"
+#include "planner/plan/ExecutionPlan.h"
+#include "planner/plan/Query.h"
+#include "service/GraphFlags.h"
+#include "util/ScopedTimer.h"
+
+DECLARE_bool(enable_lifetime_optimize);
+
+namespace nebula {
+namespace graph {
+
+class PipelineExecutor::Stage {
+public:
+    // `ownInput' means the input rows are the batches owned by the pipeline, which are moved
+    // instead of copied
+    Stage(const PlanNode *node, bool ownInput) : node_(node), ownInput_(ownInput) {}
+
+    virtual ~Stage() = default;
+
+    // Consume the rows from the current position of `iter' and append the outputs to `out',
+    // stop when `iter' is exhausted, `out' has `maxRows' rows at least or no more input rows
+    // are wanted. Only the rows accepted by all `selectors', which are the stages fused below
+    // this one on the same iterator, are processed.
+    Status consume(Iterator *iter,
+                   size_t maxRows,
+                   DataSet *out,
+                   const std::vector<Stage *> &selectors = {}) {
+        SCOPED_TIMER(&execTime_);
+        auto selectorsDone = [&selectors]() {
+            return std::any_of(
+                selectors.begin(), selectors.end(), [](auto *s) { return s->done(); });
+        };
+        for (; iter->valid() && out->rows.size() < maxRows && !done() && !selectorsDone();
+             iter->next()) {
+            bool accepted = true;
+            for (auto *selector : selectors) {
+                auto result = selector->accept(iter);
+                NG_RETURN_IF_ERROR(result);
+                if (!result.value()) {
+                    accepted = false;
+                    break;
+                }
+            }
+            if (accepted) {
+                NG_RETURN_IF_ERROR(process(iter, out));
+            }
+        }
+        return Status::OK();
+    }
+
+    // No more input rows are wanted
+    virtual bool done() const {
+        return false;
+    }
+
+    // Whether the current row of `iter' is kept, only for Filter and Limit which output the
+    // input rows as they are
+    virtual StatusOr<bool> accept(Iterator *) {
+        return Status::Error("`%s' could not select rows", PlanNode::toString(node_->kind()));
+    }
+
+    const PlanNode *node() const {
+        return node_;
+    }
+
+    size_t numRows() const {
+        return numRows_;
+    }
+
+    uint64_t execTime() const {
+        return execTime_;
+    }
+
+protected:
+    // Process the current row of `iter' and append the outputs to `out'
+    virtual Status process(Iterator *iter, DataSet *out) = 0;
+
+    Row takeRow(Iterator *iter) const {
+        if (ownInput_) {
+            return static_cast<SequentialIter *>(iter)->moveRow();
+        }
+        return *iter->row();
+    }
+
+    const PlanNode *node_;
+    bool            ownInput_{false};
+    size_t          numRows_{0};
+    uint64_t        execTime_{0};
+};
+
+namespace {
+
+class FilterStage final : public PipelineExecutor::Stage {
+public:
+    FilterStage(const PlanNode *node, QueryContext *qctx, bool ownInput)
+        : Stage(node, ownInput),
+          ctx_(qctx->ectx()),
+          condition_(CompiledExpression::compile(qctx->objPool(),
+                                                 static_cast<const Filter *>(node)->condition())) {}
+
+    StatusOr<bool> accept(Iterator *iter) override {
+        auto &val = condition_->eval(ctx_(iter));
+        if (val.isBadNull() || (!val.empty() && !val.isBool() && !val.isNull())) {
+            return Status::Error("Internal Error: Wrong type result, "
+                                 "the type should be NULL,EMPTY or BOOL");
+        }
+        if (val.empty() || val.isNull() || !val.getBool()) {
+            return false;
+        }
+        ++numRows_;
+        return true;
+    }
+
+private:
+    Status process(Iterator *iter, DataSet *out) override {
+        auto result = accept(iter);
+        NG_RETURN_IF_ERROR(result);
+        if (result.value()) {
+            out->rows.emplace_back(takeRow(iter));
+        }
+        return Status::OK();
+    }
+
+    QueryExpressionContext                  ctx_;
+    std::unique_ptr<CompiledExpression>     condition_;
+};
+
+class ProjectStage final : public PipelineExecutor::Stage {
+public:
+    ProjectStage(const PlanNode *node, QueryContext *qctx, bool ownInput)
+        : Stage(node, ownInput), ctx_(qctx->ectx()) {
+        for (auto *col : static_cast<const Project *>(node)->columns()->columns()) {
+            exprs_.emplace_back(CompiledExpression::compile(qctx->objPool(), col->expr()));
+        }
+    }
+
+private:
+    Status process(Iterator *iter, DataSet *out) override {
+        Row row;
+        row.values.reserve(exprs_.size());
+        for (auto &expr : exprs_) {
+            row.values.emplace_back(expr->eval(ctx_(iter)));
+        }
+        out->rows.emplace_back(std::move(row));
+        ++numRows_;
+        return Status::OK();
+    }
+
+    QueryExpressionContext                              ctx_;
+    std::vector<std::unique_ptr<CompiledExpression>>    exprs_;
+};
+
+class UnwindStage final : public PipelineExecutor::Stage {
+public:
+    UnwindStage(const PlanNode *node, QueryContext *qctx, bool ownInput, bool emptyInput)
+        : Stage(node, ownInput),
+          ctx_(qctx->ectx()),
+          unwindExpr_(CompiledExpression::compile(
+              qctx->objPool(), static_cast<const Unwind *>(node)->unwindExpr())),
+          emptyInput_(emptyInput) {}
+
+private:
+    Status process(Iterator *iter, DataSet *out) override {
+        Value list = unwindExpr_->eval(ctx_(iter));
+        if (!list.isList()) {
+            if (!list.isNull() && !list.empty()) {
+                append(iter, std::move(list), true, out);
+            }
+            return Status::OK();
+        }
+        auto &values = list.mutableList().values;
+        for (size_t i = 0; i < values.size(); ++i) {
+            append(iter, std::move(values[i]), i + 1 == values.size(), out);
+        }
+        return Status::OK();
+    }
+
+    // The input row could be taken by the last one appended only
+    void append(Iterator *iter, Value &&val, bool last, DataSet *out) {
+        Row row;
+        if (!emptyInput_) {
+            if (last && ownInput_) {
+                row = takeRow(iter);
+            } else {
+                // Allocate the values once instead of growing the copy of input
+                auto &input = iter->row()->values;
+                row.values.reserve(input.size() + 1);
+                row.values.insert(row.values.end(), input.begin(), input.end());
+            }
+        }
+        row.values.emplace_back(std::move(val));
+        out->rows.emplace_back(std::move(row));
+        ++numRows_;
+    }
+
+    QueryExpressionContext                  ctx_;
+    std::unique_ptr<CompiledExpression>     unwindExpr_;
+    bool                                    emptyInput_{false};
+};
+
+// Dedup is always the top of chain, which appends to the output of pipeline directly. So the
+// unique rows are kept only once, in the output, and referred by their indices.
+class DedupStage final : public PipelineExecutor::Stage {
+public:
+    explicit DedupStage(const PlanNode *node)
+        : Stage(node, true), unique_(0, RowHash{&rows_}, RowEqual{&rows_}) {}
+
+private:
+    struct RowHash {
+        size_t operator()(size_t index) const {
+            return std::hash<Row>()((**rows)[index]);
+        }
+
+        const std::vector<Row> **rows;
+    };
+
+    struct RowEqual {
+        bool operator()(size_t lhs, size_t rhs) const {
+            return (**rows)[lhs] == (**rows)[rhs];
+        }
+
+        const std::vector<Row> **rows;
+    };
+
+    Status process(Iterator *iter, DataSet *out) override {
+        DCHECK(rows_ == nullptr || rows_ == &out->rows);
+        rows_ = &out->rows;
+        out->rows.emplace_back(takeRow(iter));
+        if (unique_.emplace(out->rows.size() - 1).second) {
+            ++numRows_;
+        } else {
+            out->rows.pop_back();
+        }
+        return Status::OK();
+    }
+
+    const std::vector<Row>                                  *rows_{nullptr};
+    std::unordered_set<size_t, RowHash, RowEqual>           unique_;
+};
+
+class LimitStage final : public PipelineExecutor::Stage {
+public:
+    LimitStage(const PlanNode *node, bool ownInput) : Stage(node, ownInput) {
+        auto *limit = static_cast<const Limit *>(node);
+        offset_ = limit->offset();
+        count_ = limit->count();
+    }
+
+    bool done() const override {
+        return count_ <= 0;
+    }
+
+    StatusOr<bool> accept(Iterator *) override {
+        if (offset_ > 0) {
+            --offset_;
+            return false;
+        }
+        --count_;
+        ++numRows_;
+        return true;
+    }
+
+private:
+    Status process(Iterator *iter, DataSet *out) override {
+        if (accept(iter).value()) {
+            out->rows.emplace_back(takeRow(iter));
+        }
+        return Status::OK();
+    }
+
+    int64_t offset_{0};
+    int64_t count_{0};
+};
+
+}   // namespace
+
+PipelineExecutor::PipelineExecutor(std::vector<const PlanNode *> nodes, QueryContext *qctx)
+    : Executor("PipelineExecutor", DCHECK_NOTNULL(nodes.back()), qctx), nodes_(std::move(nodes)) {
+    DCHECK_GE(nodes_.size(), 2U);
+}
+
+PipelineExecutor::~PipelineExecutor() {}
+
+// static
+bool PipelineExecutor::isPipelinable(const PlanNode *node) {
+    switch (node->kind()) {
+        case PlanNode::Kind::kFilter:
+        case PlanNode::Kind::kProject:
+        case PlanNode::Kind::kUnwind:
+        case PlanNode::Kind::kDedup:
+        case PlanNode::Kind::kLimit:
+            return node->numDeps() == 1U && node->inputVars().size() == 1U &&
+                   node->inputVars()[0] != nullptr;
+        default:
+            return false;
+    }
+}
+
+// static
+std::vector<const PlanNode *> PipelineExecutor::collectChain(const PlanNode *top) {
+    std::vector<const PlanNode *> chain;
+    if (!FLAGS_enable_pipeline_execution || !isPipelinable(top)) {
+        return chain;
+    }
+    chain.emplace_back(top);
+    auto *current = top;
+    while (true) {
+        auto *input = current->inputVars()[0];
+        auto *dep = current->dep();
+        // The output of dependency must be read by current node only. Dedup keeps the unique
+        // rows in the output of pipeline, so it's only fused as the top.
+        if (input->name != dep->outputVar() || !isPipelinable(dep) ||
+            dep->kind() == PlanNode::Kind::kDedup || input->readBy.size() != 1U ||
+            *input->readBy.begin() != current) {
+            break;
+        }
+        chain.emplace_back(dep);
+        current = dep;
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    // Filter and Limit keep the kind of input iterator, e.g. the one of GetNeighbors. Those
+    // below the first Project or Unwind select the rows of input iterator, which are then
+    // turned into the plain rows by Project or Unwind.
+    auto first = std::find_if(chain.begin(), chain.end(), [](auto *node) {
+        return node->kind() == PlanNode::Kind::kProject || node->kind() == PlanNode::Kind::kUnwind;
+    });
+    if (first == chain.end() || chain.size() < 2U) {
+        chain.clear();
+    }
+    return chain;
+}
+
+folly::Future<Status> PipelineExecutor::execute() {
+    SCOPED_TIMER(&execTime_);
+    auto *bottom = nodes_.front();
+    auto &inputResult = ectx_->getResult(bottom->inputVar());
+    auto iter = inputResult.iter();
+    bool emptyInput = inputResult.valuePtr()->type() != Value::Type::DATASET;
+
+    // The stages below `first' select the rows of input iterator for it
+    size_t first = 0;
+    while (nodes_[first]->kind() != PlanNode::Kind::kProject &&
+           nodes_[first]->kind() != PlanNode::Kind::kUnwind) {
+        ++first;
+    }
+    stages_.clear();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        auto *node = nodes_[i];
+        // The input of bottom is the variable which may be read by others
+        bool ownInput = i > first;
+        switch (node->kind()) {
+            case PlanNode::Kind::kFilter:
+                stages_.emplace_back(std::make_unique<FilterStage>(node, qctx(), ownInput));
+                break;
+            case PlanNode::Kind::kProject:
+                stages_.emplace_back(std::make_unique<ProjectStage>(node, qctx(), ownInput));
+                break;
+            case PlanNode::Kind::kUnwind:
+                stages_.emplace_back(std::make_unique<UnwindStage>(
+                    node, qctx(), ownInput, i == first && emptyInput));
+                break;
+            case PlanNode::Kind::kDedup:
+                DCHECK_EQ(i + 1, nodes_.size());
+                stages_.emplace_back(std::make_unique<DedupStage>(node));
+                break;
+            case PlanNode::Kind::kLimit:
+                stages_.emplace_back(std::make_unique<LimitStage>(node, ownInput));
+                break;
+            default:
+                return Status::Error("Node `%s' could not be pipelined",
+                                     PlanNode::toString(node->kind()));
+        }
+    }
+    std::vector<Stage *> selectors;
+    for (size_t i = 0; i < first; ++i) {
+        selectors.emplace_back(stages_[i].get());
+    }
+
+    // The inputs of stages above `first', which are created once and refilled by swapping in
+    // the output rows of the stage below for each batch
+    std::vector<std::shared_ptr<Value>> inputs(nodes_.size());
+    std::vector<std::unique_ptr<SequentialIter>> inputIters(nodes_.size());
+    for (size_t i = first + 1; i < nodes_.size(); ++i) {
+        DataSet input;
+        input.colNames = nodes_[i - 1]->colNames();
+        inputs[i] = std::make_shared<Value>(std::move(input));
+        inputIters[i] = std::make_unique<SequentialIter>(inputs[i]);
+    }
+
+    // The top stage appends to the output directly
+    const size_t batchSize = std::max(FLAGS_pipeline_batch_size, 1U);
+    DataSet ds;
+    ds.colNames = node()->colNames();
+    DataSet batch;
+    auto outOf = [&](size_t i) { return i + 1 == stages_.size() ? &ds : &batch; };
+    bool done = false;
+    while (iter->valid() && !done) {
+        batch.rows.clear();
+        auto *out = outOf(first);
+        NG_RETURN_IF_ERROR(stages_[first]->consume(
+            iter.get(), out->rows.size() + batchSize, out, selectors));
+        for (size_t i = 0; i <= first; ++i) {
+            done = done || stages_[i]->done();
+        }
+        for (size_t i = first + 1; i < stages_.size() && !batch.rows.empty(); ++i) {
+            inputs[i]->mutableDataSet().rows.swap(batch.rows);
+            batch.rows.clear();
+            auto *inputIter = inputIters[i].get();
+            inputIter->reset();
+            auto &stage = stages_[i];
+            NG_RETURN_IF_ERROR(
+                stage->consume(inputIter, std::numeric_limits<size_t>::max(), outOf(i)));
+            done = done || stage->done();
+        }
+    }
+
+    std::stringstream ss;
+    for (auto &stage : stages_) {
+        ss << PlanNode::toString(stage->node()->kind()) << "_" << stage->node()->id() << "("
+           << stage->numRows() << ") ";
+    }
+    otherStats_.emplace("pipeline", ss.str());
+
+    if (FLAGS_enable_lifetime_optimize) {
+        // The outputs of the inner nodes are never saved, only the input of bottom is left
+        drop(bottom);
+    }
+    return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+}
+
+Status PipelineExecutor::close() {
+    // The fused nodes are profiled as if they were run by their own executors
+    for (auto &stage : stages_) {
+        if (stage->node() == node()) {
+            continue;
+        }
+        ProfilingStats stats;
+        stats.rows = stage->numRows();
+        stats.execDurationInUs = stage->execTime();
+        stats.totalDurationInUs = stage->execTime();
+        stats.otherStats = std::make_unique<std::unordered_map<std::string, std::string>>();
+        stats.otherStats->emplace("fused into",
+                                  folly::stringPrintf("%s_%ld",
+                                                      PlanNode::toString(node()->kind()),
+                                                      node()->id()));
+        qctx()->plan()->addProfileStats(stage->node()->id(), std::move(stats));
+    }
+    return Executor::close();
+}
+
+}   // namespace graph
+}   // namespace nebula
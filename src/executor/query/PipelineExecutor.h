@@ -0,0 +1,56 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef EXECUTOR_QUERY_PIPELINEEXECUTOR_H_
+#define EXECUTOR_QUERY_PIPELINEEXECUTOR_H_
+
+#include "executor/Executor.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * PipelineExecutor runs a chain of row-at-a-time plan nodes, i.e. Filter, Project, Limit,
+ * Unwind and Dedup, as a whole. The input is pulled in bounded batches and each batch is
+ * pushed through all stages, so the intermediate results of the inner nodes are never
+ * materialized. The output of the top stage is still appended into one DataSet saved into
+ * the execution context, so the memory is bounded by the input plus the output of chain
+ * rather than the batch size.
+ *
+ * The chain is built when creating executors, a node is fused into the chain of its
+ * successor only if its output is read by nobody else. Filter and Limit below the first
+ * Project or Unwind select the rows on the input iterator directly, and Dedup is fused as
+ * the top of chain only.
+ */
+class PipelineExecutor final : public Executor {
+public:
+    // `nodes' are ordered from the bottom to the top of the chain
+    PipelineExecutor(std::vector<const PlanNode *> nodes, QueryContext *qctx);
+
+    ~PipelineExecutor() override;
+
+    folly::Future<Status> execute() override;
+
+    // Report the stats of the fused nodes besides the top one
+    Status close() override;
+
+    // Collect the chain ended with `top' from the bottom to the top, return an empty
+    // list if there are less than two nodes could be fused.
+    static std::vector<const PlanNode *> collectChain(const PlanNode *top);
+
+    class Stage;
+
+private:
+    static bool isPipelinable(const PlanNode *node);
+
+    std::vector<const PlanNode *>           nodes_;
+    std::vector<std::unique_ptr<Stage>>     stages_;
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // EXECUTOR_QUERY_PIPELINEEXECUTOR_H_
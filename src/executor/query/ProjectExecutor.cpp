@@ -6,9 +6,12 @@
 
 #include "executor/query/ProjectExecutor.h"
 
+#include "context/BatchEvaluator.h"
+#include "context/CompiledExpression.h"
 #include "context/QueryExpressionContext.h"
 #include "parser/Clauses.h"
 #include "planner/plan/Query.h"
+#include "service/GraphFlags.h"
 #include "util/ScopedTimer.h"
 
 namespace nebula {
@@ -20,6 +23,31 @@ folly::Future<Status> ProjectExecutor::execute() {
     auto columns = project->columns()->columns();
     auto iter = ectx_->getResult(project->inputVar()).iter();
     DCHECK(!!iter);
+    if (iter->isSequentialIter() && shouldRunInParallel(iter->size())) {
+        return projectInParallel(std::move(iter));
+    }
+
+    std::vector<std::unique_ptr<CompiledExpression>> exprs;
+    exprs.reserve(columns.size());
+    for (auto& col : columns) {
+        exprs.emplace_back(CompiledExpression::compile(qctx()->objPool(), col->expr()));
+    }
+    if (FLAGS_enable_batch_eval && iter->isSequentialIter()) {
+        auto* seqIter = static_cast<SequentialIter*>(iter.get());
+        std::vector<std::unique_ptr<BatchEvaluator>> evaluators;
+        bool vectorized = false;
+        for (auto& expr : exprs) {
+            evaluators.emplace_back(BatchEvaluator::make(expr->expr(), seqIter));
+            vectorized = vectorized || evaluators.back() != nullptr;
+        }
+        if (vectorized) {
+            DataSet ds;
+            ds.colNames = project->colNames();
+            ds.rows = projectRows(exprs, evaluators, seqIter, 0, seqIter->size());
+            return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+        }
+    }
+
     QueryExpressionContext ctx(ectx_);
 
     VLOG(1) << "input: " << project->inputVar();
@@ -28,9 +56,9 @@ folly::Future<Status> ProjectExecutor::execute() {
     ds.rows.reserve(iter->size());
     for (; iter->valid(); iter->next()) {
         Row row;
-        for (auto& col : columns) {
-            Value val = col->expr()->eval(ctx(iter.get()));
-            row.values.emplace_back(std::move(val));
+        row.values.reserve(exprs.size());
+        for (auto& expr : exprs) {
+            row.values.emplace_back(expr->eval(ctx(iter.get())));
         }
         ds.rows.emplace_back(std::move(row));
     }
@@ -38,5 +66,86 @@ folly::Future<Status> ProjectExecutor::execute() {
     return finish(ResultBuilder().value(Value(std::move(ds))).finish());
 }
 
+folly::Future<Status> ProjectExecutor::projectInParallel(std::unique_ptr<Iterator> iter) {
+    auto columns = asNode<Project>(node())->columns()->columns();
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    struct WorkerState {
+        std::vector<std::unique_ptr<CompiledExpression>>    exprs;
+        std::vector<std::unique_ptr<BatchEvaluator>>        evaluators;
+        std::unique_ptr<Iterator>                           iter;
+    };
+    std::vector<WorkerState> workers(maxNumWorkers());
+    for (auto& worker : workers) {
+        worker.iter = iter->copy();
+        auto* seqIter = static_cast<SequentialIter*>(worker.iter.get());
+        for (auto& col : columns) {
+            auto expr = CompiledExpression::compile(qctx()->objPool(), col->expr());
+            worker.evaluators.emplace_back(
+                FLAGS_enable_batch_eval ? BatchEvaluator::make(expr->expr(), seqIter) : nullptr);
+            worker.exprs.emplace_back(std::move(expr));
+        }
+    }
+
+    auto scatter = [this, workers = std::move(workers)](
+                       size_t worker, size_t begin, size_t end) -> std::vector<Row> {
+        auto& state = workers[worker];
+        return projectRows(state.exprs,
+                           state.evaluators,
+                           static_cast<SequentialIter*>(state.iter.get()),
+                           begin,
+                           end);
+    };
+    return runMorsels(iter->size(), std::move(scatter))
+        .thenValue([this](std::vector<std::vector<Row>> morsels) {
+            SCOPED_TIMER(&execTime_);
+            DataSet ds;
+            ds.colNames = node()->colNames();
+            size_t size = 0;
+            for (auto& rows : morsels) {
+                size += rows.size();
+            }
+            ds.rows.reserve(size);
+            for (auto& rows : morsels) {
+                std::move(rows.begin(), rows.end(), std::back_inserter(ds.rows));
+            }
+            return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+        });
+}
+
+std::vector<Row> ProjectExecutor::projectRows(
+    const std::vector<std::unique_ptr<CompiledExpression>>& exprs,
+    const std::vector<std::unique_ptr<BatchEvaluator>>& evaluators,
+    SequentialIter* iter,
+    size_t begin,
+    size_t end) const {
+    DCHECK_EQ(exprs.size(), evaluators.size());
+    QueryExpressionContext ctx(ectx_);
+    const size_t batchSize = std::max(FLAGS_batch_eval_size, 1U);
+    std::vector<Row> rows(end - begin);
+    for (auto& row : rows) {
+        row.values.reserve(exprs.size());
+    }
+    std::vector<Value> vals;
+    for (size_t pos = begin; pos < end; pos += batchSize) {
+        auto num = std::min(batchSize, end - pos);
+        for (size_t c = 0; c < exprs.size(); ++c) {
+            vals.clear();
+            if (evaluators[c] != nullptr) {
+                evaluators[c]->eval(iter, pos, num, ctx, &vals);
+            } else {
+                iter->reset(pos);
+                for (size_t i = 0; i < num; ++i, iter->next()) {
+                    vals.emplace_back(exprs[c]->eval(ctx(iter)));
+                }
+            }
+            for (size_t i = 0; i < num; ++i) {
+                rows[pos - begin + i].values.emplace_back(std::move(vals[i]));
+            }
+        }
+    }
+    return rows;
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -12,12 +12,29 @@
 namespace nebula {
 namespace graph {
 
+class BatchEvaluator;
+class CompiledExpression;
+class SequentialIter;
+
 class ProjectExecutor final : public Executor {
 public:
     ProjectExecutor(const PlanNode *node, QueryContext *qctx)
         : Executor("ProjectExecutor", node, qctx) {}
 
     folly::Future<Status> execute() override;
+
+private:
+    // Split the rows into morsels and project them in parallel
+    folly::Future<Status> projectInParallel(std::unique_ptr<Iterator> iter);
+
+    // Project the rows in [begin, end) of `iter', the expressions which have evaluators
+    // are evaluated in batch and the others row by row
+    std::vector<Row> projectRows(
+        const std::vector<std::unique_ptr<CompiledExpression>> &exprs,
+        const std::vector<std::unique_ptr<BatchEvaluator>> &evaluators,
+        SequentialIter *iter,
+        size_t begin,
+        size_t end) const;
 };
 
 }   // namespace graph
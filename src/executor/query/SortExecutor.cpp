@@ -6,7 +6,11 @@
 
 #include "executor/query/SortExecutor.h"
 #include "planner/plan/Query.h"
+#include "service/GraphFlags.h"
 #include "util/ScopedTimer.h"
+#include "util/SpillFile.h"
+
+DECLARE_bool(enable_lifetime_optimize);
 
 namespace nebula {
 namespace graph {
@@ -27,27 +31,328 @@ folly::Future<Status> SortExecutor::execute() {
         return Status::Error(ss.str());
     }
 
-    auto &factors = sort->factors();
-    auto comparator = [&factors] (const Row &lhs, const Row &rhs) {
-        for (auto &item : factors) {
-            auto index = item.first;
-            auto orderType = item.second;
-            if (lhs[index] == rhs[index]) {
+    RowComparator comparator(sort->factors());
+    auto seqIter = static_cast<SequentialIter*>(iter);
+    // The input is resident already and the sorted rows would be materialized all again, so
+    // spilling only pays off when the rows beyond a limit are never read
+    if (outputLimit() < seqIter->size() && shouldSpill(seqIter)) {
+        return sortBySpilling(std::move(result), comparator);
+    }
+    auto size = seqIter->size();
+    if (size > 1) {
+        auto sortKeys = SortKeys::make(sort->factors(), &*seqIter->begin(), size);
+        if (sortKeys != nullptr) {
+            return sortByKeys(std::move(result), std::move(sortKeys));
+        }
+    }
+    std::sort(seqIter->begin(), seqIter->end(), comparator);
+    return finish(ResultBuilder().value(result.valuePtr()).iter(std::move(result).iter()).finish());
+}
+
+struct SortExecutor::SortState {
+    Result                                      input;
+    std::unique_ptr<SortKeys>                   sortKeys;
+    std::vector<SortKeys::Key>                  keys;
+    // The buffer to merge the sorted runs of keys
+    std::vector<SortKeys::Key>                  buffer;
+    // The ranges of sorted runs in keys
+    std::vector<std::pair<size_t, size_t>>      runs;
+};
+
+folly::Future<Status> SortExecutor::sortByKeys(Result input, std::unique_ptr<SortKeys> sortKeys) {
+    auto size = input.iterRef()->size();
+    auto state = std::shared_ptr<SortState>(
+        new SortState{std::move(input), std::move(sortKeys), {}, {}, {}});
+    state->keys.resize(size);
+    if (!shouldRunInParallel(size)) {
+        for (size_t i = 0; i < size; ++i) {
+            state->keys[i] = state->sortKeys->encode(i);
+        }
+        std::sort(state->keys.begin(), state->keys.end(), *state->sortKeys);
+        return permute(state.get());
+    }
+
+    auto sortMorsel = [state](size_t, size_t begin, size_t end) {
+        auto &keys = state->keys;
+        for (size_t i = begin; i < end; ++i) {
+            keys[i] = state->sortKeys->encode(i);
+        }
+        std::sort(keys.begin() + begin, keys.begin() + end, *state->sortKeys);
+        return std::make_pair(begin, end);
+    };
+    return runMorsels(size, std::move(sortMorsel))
+        .thenValue([this, state](std::vector<std::pair<size_t, size_t>> runs) {
+            state->runs = std::move(runs);
+            return mergeRuns(state);
+        });
+}
+
+folly::Future<Status> SortExecutor::mergeRuns(std::shared_ptr<SortState> state) {
+    if (state->runs.size() <= 1) {
+        return permute(state.get());
+    }
+    state->buffer.resize(state->keys.size());
+    auto mergePairs = [state](size_t, size_t begin, size_t end) {
+        auto keys = state->keys.begin();
+        auto out = state->buffer.begin();
+        auto &runs = state->runs;
+        for (size_t i = begin; i < end; ++i) {
+            auto &lhs = runs[2 * i];
+            if (2 * i + 1 == runs.size()) {
+                std::copy(keys + lhs.first, keys + lhs.second, out + lhs.first);
                 continue;
             }
+            auto &rhs = runs[2 * i + 1];
+            std::merge(keys + lhs.first,
+                       keys + lhs.second,
+                       keys + rhs.first,
+                       keys + rhs.second,
+                       out + lhs.first,
+                       *state->sortKeys);
+        }
+        return folly::unit;
+    };
+    auto numPairs = (state->runs.size() + 1) / 2;
+    return runMorsels(numPairs, std::move(mergePairs), 1)
+        .thenValue([this, state](std::vector<folly::Unit>) {
+            std::swap(state->keys, state->buffer);
+            std::vector<std::pair<size_t, size_t>> runs;
+            for (size_t i = 0; i < state->runs.size(); i += 2) {
+                auto last = std::min(i + 1, state->runs.size() - 1);
+                runs.emplace_back(state->runs[i].first, state->runs[last].second);
+            }
+            state->runs = std::move(runs);
+            return mergeRuns(state);
+        });
+}
+
+Status SortExecutor::permute(SortState *state) {
+    SCOPED_TIMER(&execTime_);
+    auto &input = state->input;
+    auto rows = static_cast<SequentialIter*>(input.iterRef())->begin();
+    std::vector<Row> sorted;
+    sorted.reserve(state->keys.size());
+    for (auto &key : state->keys) {
+        sorted.emplace_back(std::move(rows[key.index]));
+    }
+    std::move(sorted.begin(), sorted.end(), rows);
+    return finish(ResultBuilder().value(input.valuePtr()).iter(std::move(input).iter()).finish());
+}
+
+bool SortExecutor::shouldSpill(SequentialIter *iter) const {
+    if (FLAGS_query_spill_memory_bytes <= 0) {
+        return false;
+    }
+    auto budget = static_cast<size_t>(FLAGS_query_spill_memory_bytes);
+    size_t size = 0;
+    for (auto it = iter->begin(); it != iter->end(); ++it) {
+        size += SpillFile::estimateSize(*it);
+        if (size > budget) {
+            return true;
+        }
+    }
+    return false;
+}
 
-            if (orderType == OrderFactor::OrderType::ASCEND) {
-                return lhs[index] < rhs[index];
-            } else if (orderType == OrderFactor::OrderType::DESCEND) {
-                return lhs[index] > rhs[index];
+size_t SortExecutor::outputLimit() const {
+    auto &readBy = node()->outputVarPtr()->readBy;
+    if (readBy.size() != 1) {
+        return std::numeric_limits<size_t>::max();
+    }
+    int64_t offset = 0;
+    int64_t count = 0;
+    auto *reader = *readBy.begin();
+    if (reader->kind() == PlanNode::Kind::kLimit) {
+        auto *limit = asNode<Limit>(reader);
+        offset = limit->offset();
+        count = limit->count();
+    } else if (reader->kind() == PlanNode::Kind::kTopN &&
+               asNode<TopN>(reader)->factors() == asNode<Sort>(node())->factors()) {
+        auto *topn = asNode<TopN>(reader);
+        offset = topn->offset();
+        count = topn->count();
+    } else {
+        return std::numeric_limits<size_t>::max();
+    }
+    if (offset < 0 || count < 0 || count > std::numeric_limits<int64_t>::max() - offset) {
+        return std::numeric_limits<size_t>::max();
+    }
+    return offset + count;
+}
+
+namespace {
+
+// The upper bound of the sorted runs merged at once, each of them holds an open file and
+// its buffer
+constexpr size_t kMaxMergeFanIn = 64;
+
+using SortedRuns = std::vector<std::unique_ptr<SpillFile>>;
+
+// Merge the sorted runs by a heap and emit the first `limit' rows in order. The heap top is
+// the least one, the ties are broken by the order of runs to keep the merge deterministic.
+template <typename Emit>
+Status mergeSortedRuns(SortedRuns runs,
+                       const RowComparator &comparator,
+                       size_t limit,
+                       Emit &&emit) {
+    std::vector<std::pair<Row, size_t>> heads;
+    heads.reserve(runs.size());
+    auto greater = [&comparator](const std::pair<Row, size_t> &lhs,
+                                 const std::pair<Row, size_t> &rhs) {
+        if (comparator(rhs.first, lhs.first)) {
+            return true;
+        }
+        if (comparator(lhs.first, rhs.first)) {
+            return false;
+        }
+        return lhs.second > rhs.second;
+    };
+    for (size_t i = 0; i < runs.size(); ++i) {
+        Row row;
+        auto ret = runs[i]->read(&row);
+        NG_RETURN_IF_ERROR(ret);
+        if (ret.value()) {
+            heads.emplace_back(std::move(row), i);
+        } else {
+            runs[i].reset();
+        }
+    }
+    std::make_heap(heads.begin(), heads.end(), greater);
+
+    for (size_t num = 0; !heads.empty() && num < limit; ++num) {
+        std::pop_heap(heads.begin(), heads.end(), greater);
+        auto &head = heads.back();
+        NG_RETURN_IF_ERROR(emit(std::move(head.first)));
+        auto ret = runs[head.second]->read(&head.first);
+        NG_RETURN_IF_ERROR(ret);
+        if (ret.value()) {
+            std::push_heap(heads.begin(), heads.end(), greater);
+        } else {
+            // Close the exhausted run as soon as possible
+            runs[head.second].reset();
+            heads.pop_back();
+        }
+    }
+    return Status::OK();
+}
+
+// Merge the sorted runs into a longer one on disk
+StatusOr<std::unique_ptr<SpillFile>> mergeToFile(SortedRuns runs,
+                                                 const RowComparator &comparator,
+                                                 size_t limit) {
+    auto file = SpillFile::make(FLAGS_spill_tmp_dir);
+    NG_RETURN_IF_ERROR(file);
+    auto merged = std::move(file).value();
+    auto emit = [&merged](Row &&row) { return merged->write(row); };
+    NG_RETURN_IF_ERROR(mergeSortedRuns(std::move(runs), comparator, limit, emit));
+    NG_RETURN_IF_ERROR(merged->rewind());
+    return std::move(merged);
+}
+
+}   // namespace
+
+folly::Future<Status> SortExecutor::sortBySpilling(Result input, const RowComparator &comparator) {
+    auto budget = static_cast<size_t>(FLAGS_query_spill_memory_bytes);
+    auto limit = outputLimit();
+    auto colNames = input.value().getDataSet().colNames;
+    auto *iter = static_cast<SequentialIter *>(input.iterRef());
+    // The file buffers of the runs merged at once are kept within the budget too
+    auto fanIn = std::max<size_t>(2, std::min(kMaxMergeFanIn, budget / SpillFile::kBufferSize));
+
+    // levels[k] holds the runs merged k times. A full level is merged into one run of the
+    // next level at once, so at most fanIn files of each level are open at the same time.
+    std::vector<SortedRuns> levels(1);
+    size_t numRuns = 0;
+    size_t spilledBytes = 0;
+    size_t numMerges = 0;
+    auto addRun = [&](std::unique_ptr<SpillFile> spill) -> Status {
+        levels[0].emplace_back(std::move(spill));
+        for (size_t k = 0; levels[k].size() >= fanIn; ++k) {
+            auto merged = mergeToFile(std::move(levels[k]), comparator, limit);
+            NG_RETURN_IF_ERROR(merged);
+            numMerges++;
+            levels[k].clear();
+            if (k + 1 == levels.size()) {
+                levels.emplace_back();
             }
+            levels[k + 1].emplace_back(std::move(merged).value());
         }
-        return false;
+        return Status::OK();
     };
 
-    auto seqIter = static_cast<SequentialIter*>(iter);
-    std::sort(seqIter->begin(), seqIter->end(), comparator);
-    return finish(ResultBuilder().value(result.valuePtr()).iter(std::move(result).iter()).finish());
+    std::vector<const Row *> run;
+    auto writeRun = [&]() -> Status {
+        std::sort(run.begin(), run.end(), [&comparator](const Row *lhs, const Row *rhs) {
+            return comparator(*lhs, *rhs);
+        });
+        auto file = SpillFile::make(FLAGS_spill_tmp_dir);
+        NG_RETURN_IF_ERROR(file);
+        auto spill = std::move(file).value();
+        // The rows after the limit in a run never show up in the output
+        auto num = std::min(run.size(), limit);
+        for (size_t i = 0; i < num; ++i) {
+            NG_RETURN_IF_ERROR(spill->write(*run[i]));
+        }
+        NG_RETURN_IF_ERROR(spill->rewind());
+        numRuns++;
+        spilledBytes += spill->size();
+        run.clear();
+        return addRun(std::move(spill));
+    };
+    size_t runSize = 0;
+    for (auto it = iter->begin(); it != iter->end(); ++it) {
+        run.emplace_back(&*it);
+        runSize += SpillFile::estimateSize(*it);
+        if (runSize >= budget) {
+            NG_RETURN_IF_ERROR(writeRun());
+            runSize = 0;
+        }
+    }
+    if (!run.empty()) {
+        NG_RETURN_IF_ERROR(writeRun());
+    }
+
+    // The input is on disk now, release it if no one else reads it
+    input = Result::EmptyResult();
+    if (FLAGS_enable_lifetime_optimize) {
+        drop();
+    }
+
+    // The runs of higher levels hold the earlier input rows
+    SortedRuns runs;
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+        std::move(level->begin(), level->end(), std::back_inserter(runs));
+    }
+    levels.clear();
+    // Merge the consecutive runs pass by pass until they could be merged at once
+    while (runs.size() > fanIn) {
+        SortedRuns next;
+        for (size_t i = 0; i < runs.size(); i += fanIn) {
+            auto last = std::min(i + fanIn, runs.size());
+            SortedRuns group(std::make_move_iterator(runs.begin() + i),
+                             std::make_move_iterator(runs.begin() + last));
+            auto merged = mergeToFile(std::move(group), comparator, limit);
+            NG_RETURN_IF_ERROR(merged);
+            numMerges++;
+            next.emplace_back(std::move(merged).value());
+        }
+        runs = std::move(next);
+    }
+    otherStats_.emplace("spill",
+                        folly::stringPrintf("%lu runs, %lu bytes, %lu intermediate merges",
+                                            numRuns,
+                                            spilledBytes,
+                                            numMerges));
+
+    DataSet ds;
+    ds.colNames = std::move(colNames);
+    auto emit = [&ds](Row &&row) {
+        ds.rows.emplace_back(std::move(row));
+        return Status::OK();
+    };
+    NG_RETURN_IF_ERROR(mergeSortedRuns(std::move(runs), comparator, limit, emit));
+    // The input has been dropped
+    return setOutput(ResultBuilder().value(Value(std::move(ds))).finish());
 }
 
 }   // namespace graph
@@ -8,6 +8,7 @@
 #define EXECUTOR_QUERY_SORTEXECUTOR_H_
 
 #include "executor/Executor.h"
+#include "executor/query/SortKeys.h"
 
 namespace nebula {
 namespace graph {
@@ -18,6 +19,34 @@ public:
         : Executor("SortExecutor", node, qctx) {}
 
     folly::Future<Status> execute() override;
+
+private:
+    // Whether the input rows exceed the memory budget of query
+    bool shouldSpill(SequentialIter *iter) const;
+
+    // Number of the sorted rows read by the only downstream Limit or TopN in the same order,
+    // the rest are never used
+    size_t outputLimit() const;
+
+    // External merge sort: write the sorted runs up to the memory budget into temporary
+    // files and release the input, then merge the runs by a heap. No more than 64 runs are
+    // merged at once, the longer runs are merged in multiple passes.
+    // It's only used when the output is read up to a limit, i.e. by Limit or TopN, so that
+    // the rows beyond the limit are dropped from the runs and never read back. The merged
+    // rows are not streamed to the downstream, so without a limit the output would take the
+    // same memory as the input sorted in place.
+    folly::Future<Status> sortBySpilling(Result input, const RowComparator &comparator);
+
+    struct SortState;
+
+    // Sort the normalized keys, in parallel for the large input: the morsels are sorted by
+    // the workers, then merged pairwise round by round
+    folly::Future<Status> sortByKeys(Result input, std::unique_ptr<SortKeys> sortKeys);
+
+    folly::Future<Status> mergeRuns(std::shared_ptr<SortState> state);
+
+    // Move the rows to their positions in the sorted keys
+    Status permute(SortState *state);
 };
 
 }   // namespace graph
@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "executor/query/SortKeys.h"
+
+namespace nebula {
+namespace graph {
+
+// static
+std::unique_ptr<SortKeys> SortKeys::make(
+    const std::vector<std::pair<size_t, OrderFactor::OrderType>>& factors,
+    const Row* rows,
+    size_t size) {
+    if (factors.empty()) {
+        return nullptr;
+    }
+    auto column = factors.front().first;
+    const Value* sample = nullptr;
+    for (size_t i = 0; i < size; ++i) {
+        auto& value = rows[i][column];
+        if (value.isNull()) {
+            continue;
+        }
+        if (!value.isInt() && !value.isStr()) {
+            return nullptr;
+        }
+        if (sample == nullptr) {
+            sample = &value;
+        } else if (value.type() != sample->type()) {
+            return nullptr;
+        }
+    }
+    auto type = sample == nullptr ? Value::Type::INT : sample->type();
+    // Follow the order of NULL and the other values defined by Value
+    bool nullGreater = sample == nullptr || *sample < Value::kNullValue;
+    return std::unique_ptr<SortKeys>(new SortKeys(factors, rows, type, nullGreater));
+}
+
+SortKeys::SortKeys(const std::vector<std::pair<size_t, OrderFactor::OrderType>>& factors,
+                   const Row* rows,
+                   Value::Type type,
+                   bool nullGreater)
+    : comparator_(factors), rows_(rows), type_(type) {
+    column_ = factors.front().first;
+    descend_ = factors.front().second == OrderFactor::OrderType::DESCEND;
+    bool nullFirst = nullGreater == descend_;
+    valueRank_ = nullFirst ? 1 : 0;
+    nullRank_ = nullFirst ? 0 : 1;
+}
+
+SortKeys::Key SortKeys::encode(size_t index) const {
+    Key key;
+    key.index = index;
+    auto& value = rows_[index][column_];
+    if (value.isNull()) {
+        // All NULLs have the same key, and are compared by the comparator
+        key.rank = nullRank_;
+        key.prefix = 0;
+        return key;
+    }
+    key.rank = valueRank_;
+    if (type_ == Value::Type::INT) {
+        // Flip the sign bit to compare as unsigned
+        key.prefix = static_cast<uint64_t>(value.getInt()) ^ (1ULL << 63);
+    } else {
+        // The first 8 bytes in big endian, padded with zero
+        auto& str = value.getStr();
+        uint64_t prefix = 0;
+        for (size_t i = 0; i < sizeof(prefix); ++i) {
+            prefix <<= 8;
+            if (i < str.size()) {
+                prefix |= static_cast<uint8_t>(str[i]);
+            }
+        }
+        key.prefix = prefix;
+    }
+    if (descend_) {
+        key.prefix = ~key.prefix;
+    }
+    return key;
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,104 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef EXECUTOR_QUERY_SORTKEYS_H_
+#define EXECUTOR_QUERY_SORTKEYS_H_
+
+#include "common/base/Base.h"
+#include "common/datatypes/DataSet.h"
+#include "parser/TraverseSentences.h"
+
+namespace nebula {
+namespace graph {
+
+// Compare rows by the order factors, i.e. the column indices and the order types
+class RowComparator final {
+public:
+    explicit RowComparator(const std::vector<std::pair<size_t, OrderFactor::OrderType>>& factors)
+        : factors_(factors) {}
+
+    bool operator()(const Row& lhs, const Row& rhs) const {
+        for (auto& item : factors_) {
+            auto index = item.first;
+            auto orderType = item.second;
+            if (lhs[index] == rhs[index]) {
+                continue;
+            }
+
+            if (orderType == OrderFactor::OrderType::ASCEND) {
+                return lhs[index] < rhs[index];
+            } else if (orderType == OrderFactor::OrderType::DESCEND) {
+                return lhs[index] > rhs[index];
+            }
+        }
+        return false;
+    }
+
+private:
+    const std::vector<std::pair<size_t, OrderFactor::OrderType>>&        factors_;
+};
+
+/**
+ * SortKeys normalizes the column of the first order factor into fixed size keys compared
+ * as unsigned integers, i.e. memcmp, which respect ASC/DESC and the order of NULL, so most
+ * comparisons of rows don't dispatch on the types of values. Ints are encoded as they are,
+ * and strings by their first 8 bytes. The ties of keys are broken by the comparator of all
+ * order factors, and then by the row indices to make sorting stable.
+ */
+class SortKeys final {
+public:
+    struct Key {
+        // Decide the order of NULL and the other values
+        uint8_t             rank;
+        uint64_t            prefix;
+        size_t              index;
+    };
+
+    // Return nullptr if the values of the first sort column are neither all ints nor all
+    // strings besides NULL, which are not worth normalizing
+    static std::unique_ptr<SortKeys> make(
+        const std::vector<std::pair<size_t, OrderFactor::OrderType>>& factors,
+        const Row* rows,
+        size_t size);
+
+    // Encode the key of the `index'th row
+    Key encode(size_t index) const;
+
+    bool operator()(const Key& lhs, const Key& rhs) const {
+        if (lhs.rank != rhs.rank) {
+            return lhs.rank < rhs.rank;
+        }
+        if (lhs.prefix != rhs.prefix) {
+            return lhs.prefix < rhs.prefix;
+        }
+        if (comparator_(rows_[lhs.index], rows_[rhs.index])) {
+            return true;
+        }
+        if (comparator_(rows_[rhs.index], rows_[lhs.index])) {
+            return false;
+        }
+        return lhs.index < rhs.index;
+    }
+
+private:
+    SortKeys(const std::vector<std::pair<size_t, OrderFactor::OrderType>>& factors,
+             const Row* rows,
+             Value::Type type,
+             bool nullGreater);
+
+    RowComparator                   comparator_;
+    const Row*                      rows_{nullptr};
+    size_t                          column_{0};
+    bool                            descend_{false};
+    Value::Type                     type_;
+    uint8_t                         valueRank_{0};
+    uint8_t                         nullRank_{0};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // EXECUTOR_QUERY_SORTKEYS_H_
@@ -26,23 +26,7 @@ folly::Future<Status> TopNExecutor::execute() {
         return Status::Error(ss.str());
     }
 
-    auto &factors = topn->factors();
-    comparator_ = [&factors] (const Row &lhs, const Row &rhs) {
-        for (auto &item : factors) {
-            auto index = item.first;
-            auto orderType = item.second;
-            if (lhs[index] == rhs[index]) {
-                continue;
-            }
-
-            if (orderType == OrderFactor::OrderType::ASCEND) {
-                return lhs[index] < rhs[index];
-            } else if (orderType == OrderFactor::OrderType::DESCEND) {
-                return lhs[index] > rhs[index];
-            }
-        }
-        return false;
-    };
+    comparator_ = RowComparator(topn->factors());
 
     offset_ = topn->offset();
     auto count = topn->count();
@@ -63,11 +47,71 @@ folly::Future<Status> TopNExecutor::execute() {
             .value(result.valuePtr()).iter(std::move(result).iter()).finish());
     }
 
+    auto sortKeys =
+        SortKeys::make(topn->factors(), &*static_cast<SequentialIter*>(iter)->begin(), size);
+    if (sortKeys != nullptr) {
+        return topNByKeys(std::move(result), std::move(sortKeys));
+    }
+
     executeTopN<SequentialIter>(iter);
     iter->eraseRange(maxCount_, size);
     return finish(ResultBuilder().value(result.valuePtr()).iter(std::move(result).iter()).finish());
 }
 
+folly::Future<Status> TopNExecutor::topNByKeys(Result input, std::unique_ptr<SortKeys> sortKeys) {
+    auto size = input.iterRef()->size();
+    auto heapSize = static_cast<size_t>(heapSize_);
+    if (!shouldRunInParallel(size)) {
+        std::vector<SortKeys::Key> keys;
+        keys.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            keys.emplace_back(sortKeys->encode(i));
+        }
+        std::partial_sort(keys.begin(), keys.begin() + heapSize, keys.end(), *sortKeys);
+        keys.resize(heapSize);
+        return topNRows(input, keys);
+    }
+
+    std::shared_ptr<SortKeys> shared = std::move(sortKeys);
+    auto selectMorsel = [shared, heapSize](size_t, size_t begin, size_t end) {
+        std::vector<SortKeys::Key> keys;
+        keys.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            keys.emplace_back(shared->encode(i));
+        }
+        auto num = std::min(heapSize, keys.size());
+        std::partial_sort(keys.begin(), keys.begin() + num, keys.end(), *shared);
+        keys.resize(num);
+        return keys;
+    };
+    auto ptr = std::make_shared<Result>(std::move(input));
+    return runMorsels(size, std::move(selectMorsel))
+        .thenValue([this, ptr, shared, heapSize](std::vector<std::vector<SortKeys::Key>> tops) {
+            SCOPED_TIMER(&execTime_);
+            std::vector<SortKeys::Key> keys;
+            for (auto &top : tops) {
+                keys.insert(keys.end(), top.begin(), top.end());
+            }
+            std::partial_sort(keys.begin(), keys.begin() + heapSize, keys.end(), *shared);
+            keys.resize(heapSize);
+            return topNRows(*ptr, keys);
+        });
+}
+
+Status TopNExecutor::topNRows(Result &input, const std::vector<SortKeys::Key> &keys) {
+    auto *iter = static_cast<SequentialIter*>(input.iterRef());
+    auto size = iter->size();
+    auto beg = iter->begin();
+    std::vector<Row> rows;
+    rows.reserve(maxCount_);
+    for (int64_t i = 0; i < maxCount_; ++i) {
+        rows.emplace_back(std::move(beg[keys[offset_ + i].index]));
+    }
+    std::move(rows.begin(), rows.end(), beg);
+    iter->eraseRange(maxCount_, size);
+    return finish(ResultBuilder().value(input.valuePtr()).iter(std::move(input).iter()).finish());
+}
+
 template<typename U>
 void TopNExecutor::executeTopN(Iterator *iter) {
     auto uIter = static_cast<U*>(iter);
@@ -8,6 +8,7 @@
 #define EXECUTOR_QUERY_TOPNEXECUTOR_H_
 
 #include "executor/Executor.h"
+#include "executor/query/SortKeys.h"
 
 namespace nebula {
 namespace graph {
@@ -23,6 +24,13 @@ private:
     template<typename U>
     void executeTopN(Iterator *iter);
 
+    // Select the top keys of all rows, each worker selects the top ones of its morsel
+    // for the large input, which are selected again as the final ones
+    folly::Future<Status> topNByKeys(Result input, std::unique_ptr<SortKeys> sortKeys);
+
+    // Move the rows of the top keys to the front and erase the rest
+    Status topNRows(Result &input, const std::vector<SortKeys::Key> &keys);
+
     int64_t offset_;
     int64_t maxCount_;
     int64_t heapSize_;
@@ -20,6 +20,9 @@ folly::Future<Status> UnwindExecutor::execute() {
     auto &inputRes = ectx_->getResult(unwind->inputVar());
     auto iter = inputRes.iter();
     bool emptyInput = inputRes.valuePtr()->type() == Value::Type::DATASET ? false : true;
+    if (iter->isSequentialIter() && shouldRunInParallel(iter->size())) {
+        return unwindInParallel(std::move(iter));
+    }
     QueryExpressionContext ctx(ectx_);
     auto *unwindExpr = unwind->unwindExpr();
 
@@ -31,7 +34,10 @@ folly::Future<Status> UnwindExecutor::execute() {
         for (auto &v : vals) {
             Row row;
             if (!emptyInput) {
-                row = *(iter->row());
+                // Allocate the values once instead of growing the copy of input
+                auto &input = iter->row()->values;
+                row.values.reserve(input.size() + 1);
+                row.values.insert(row.values.end(), input.begin(), input.end());
             }
             row.values.emplace_back(std::move(v));
             ds.rows.emplace_back(std::move(row));
@@ -41,6 +47,47 @@ folly::Future<Status> UnwindExecutor::execute() {
     return finish(ResultBuilder().value(Value(std::move(ds))).finish());
 }
 
+folly::Future<Status> UnwindExecutor::unwindInParallel(std::unique_ptr<Iterator> iter) {
+    auto *unwindExpr = asNode<Unwind>(node())->unwindExpr();
+
+    // Expressions cache the evaluation results, so each worker has its own copy
+    std::vector<std::pair<Expression *, std::unique_ptr<Iterator>>> workers;
+    for (size_t i = 0; i < maxNumWorkers(); ++i) {
+        workers.emplace_back(unwindExpr->clone(), iter->copy());
+    }
+    auto scatter = [this, workers = std::move(workers)](
+                       size_t worker, size_t begin, size_t end) -> std::vector<Row> {
+        auto *expr = workers[worker].first;
+        auto *morselIter = workers[worker].second.get();
+        QueryExpressionContext ctx(ectx_);
+        std::vector<Row> rows;
+        morselIter->reset(begin);
+        for (size_t pos = begin; pos < end; ++pos, morselIter->next()) {
+            Value list = expr->eval(ctx(morselIter));
+            std::vector<Value> vals = extractList(list);
+            for (auto &v : vals) {
+                auto &input = morselIter->row()->values;
+                Row row;
+                row.values.reserve(input.size() + 1);
+                row.values.insert(row.values.end(), input.begin(), input.end());
+                row.values.emplace_back(std::move(v));
+                rows.emplace_back(std::move(row));
+            }
+        }
+        return rows;
+    };
+    return runMorsels(iter->size(), std::move(scatter))
+        .thenValue([this](std::vector<std::vector<Row>> morsels) {
+            SCOPED_TIMER(&execTime_);
+            DataSet ds;
+            ds.colNames = node()->colNames();
+            for (auto &rows : morsels) {
+                std::move(rows.begin(), rows.end(), std::back_inserter(ds.rows));
+            }
+            return finish(ResultBuilder().value(Value(std::move(ds))).finish());
+        });
+}
+
 std::vector<Value> UnwindExecutor::extractList(Value &val) {
     std::vector<Value> ret;
     if (val.isList()) {
@@ -20,6 +20,9 @@ public:
     folly::Future<Status> execute() override;
 
 private:
+    // Split the rows into morsels and unwind them in parallel
+    folly::Future<Status> unwindInParallel(std::unique_ptr<Iterator> iter);
+
     std::vector<Value> extractList(Value &val);
 };
 
@@ -10,6 +10,9 @@
 #include "executor/query/AggregateExecutor.h"
 #include "planner/plan/Query.h"
 
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+
 namespace nebula {
 namespace graph {
 class AggregateTest : public testing::Test {
@@ -2185,5 +2188,84 @@ TEST_F(AggregateTest, BitXor) {
         TEST_AGG_4("BIT_XOR", "bit_xor", true)
     }
 }
+
+TEST_F(AggregateTest, Parallel) {
+    auto aggregate = [](std::vector<Expression*> groupKeys,
+                        std::vector<Expression*> groupItems,
+                        std::vector<std::string> colNames) {
+        auto* agg =
+            Aggregate::make(qctx_.get(), nullptr, std::move(groupKeys), std::move(groupItems));
+        agg->setInputVar(*input_);
+        agg->setColNames(std::move(colNames));
+        auto aggExe = std::make_unique<AggregateExecutor>(agg, qctx_.get());
+        auto status = aggExe->execute().get();
+        EXPECT_TRUE(status.ok());
+        auto& result = qctx_->ectx()->getResult(agg->outputVar());
+        EXPECT_EQ(result.state(), Result::State::kSuccess);
+        DataSet ds = result.value().getDataSet();
+        std::sort(ds.rows.begin(), ds.rows.end(), RowCmp());
+        return ds;
+    };
+    auto check = [&aggregate](std::vector<Expression*> groupKeys,
+                              std::vector<Expression*> groupItems,
+                              std::vector<std::string> colNames) {
+        auto expected = aggregate(groupKeys, groupItems, colNames);
+        gflags::FlagSaver flagSaver;
+        FLAGS_max_query_parallelism = 3;
+        FLAGS_morsel_size = 2;
+        auto ds = aggregate(std::move(groupKeys), std::move(groupItems), std::move(colNames));
+        EXPECT_EQ(ds, expected);
+    };
+    auto col = [](const std::string& name) {
+        return InputPropertyExpression::make(pool_, name);
+    };
+
+    // key = col3
+    // items = col3, count(col1), sum(col1), collect(col1)
+    check({col("col3")},
+          {col("col3"),
+           AggregateExpression::make(pool_, "COUNT", col("col1"), false),
+           AggregateExpression::make(pool_, "SUM", col("col1"), false),
+           AggregateExpression::make(pool_, "COLLECT", col("col1"), false)},
+          {"col3", "count", "sum", "list"});
+    // key = col2, col3
+    // items = col2, col3, max(col1)
+    check({col("col2"), col("col3")},
+          {col("col2"),
+           col("col3"),
+           AggregateExpression::make(pool_, "MAX", col("col1"), false)},
+          {"col2", "col3", "max"});
+    // key =
+    // items = avg(col1), collect(distinct col2)
+    check({},
+          {AggregateExpression::make(pool_, "AVG", col("col1"), false),
+           AggregateExpression::make(pool_, "COLLECT", col("col2"), true)},
+          {"avg", "list"});
+    // key = col2
+    // items = min(col1), avg(col1), bit_or(col1), collect_set(col3), count(distinct col3)
+    check({col("col2")},
+          {AggregateExpression::make(pool_, "MIN", col("col1"), false),
+           AggregateExpression::make(pool_, "AVG", col("col1"), false),
+           AggregateExpression::make(pool_, "BIT_OR", col("col1"), false),
+           AggregateExpression::make(pool_, "COLLECT_SET", col("col3"), false),
+           AggregateExpression::make(pool_, "COUNT", col("col3"), true)},
+          {"min", "avg", "bit_or", "set", "count"});
+    // key =
+    // items = count(col1), collect(col1), sum(distinct col2), std(col1)
+    // STD could not be merged, which is aggregated serially
+    check({},
+          {AggregateExpression::make(pool_, "COUNT", col("col1"), false),
+           AggregateExpression::make(pool_, "COLLECT", col("col1"), false),
+           AggregateExpression::make(pool_, "SUM", col("col2"), true),
+           AggregateExpression::make(pool_, "STD", col("col1"), false)},
+          {"count", "list", "sum", "std"});
+    // key =
+    // items = count(col1), collect(col1), max(distinct col2)
+    check({},
+          {AggregateExpression::make(pool_, "COUNT", col("col1"), false),
+           AggregateExpression::make(pool_, "COLLECT", col("col1"), false),
+           AggregateExpression::make(pool_, "MAX", col("col2"), true)},
+          {"count", "list", "max"});
+}
 }   // namespace graph
 }   // namespace nebula
@@ -12,6 +12,9 @@
 #include "planner/plan/Query.h"
 #include "util/ExpressionUtils.h"
 
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+
 namespace nebula {
 namespace graph {
 
@@ -76,6 +79,18 @@ TEST_F(FilterTest, TestSequential) {
                         expected);
 }
 
+TEST_F(FilterTest, TestSequentialInParallel) {
+    FLAGS_max_query_parallelism = 3;
+    FLAGS_morsel_size = 1;
+    DataSet expected({"name"});
+    expected.emplace_back(Row({Value("Ann")}));
+    expected.emplace_back(Row({Value("Ann")}));
+    FILTER_RESUTL_CHECK("input_sequential",
+                        "filter_sequential",
+                        "YIELD $-.v_name AS name WHERE $-.e_start_year >= 2010",
+                        expected);
+}
+
 TEST_F(FilterTest, TestNullValue) {
     DataSet expected({"name"});
     FILTER_RESUTL_CHECK(
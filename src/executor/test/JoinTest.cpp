@@ -12,6 +12,11 @@
 #include "executor/query/LeftJoinExecutor.h"
 #include "executor/test/QueryTestBase.h"
 
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+DECLARE_uint32(join_partition_size);
+DECLARE_int64(query_spill_memory_bytes);
+
 namespace nebula {
 namespace graph {
 class JoinTest : public QueryTestBase {
@@ -38,6 +43,23 @@ protected:
                 "var1",
                 ResultBuilder().value(Value(std::move(ds))).finish());
         }
+        {
+            // $var1 in the iterator of GetVertices, which could not be joined by partitions
+            auto value = qctx_->ectx()->getResult("var1").value();
+            qctx_->symTable()->newVariable("var1_prop");
+            qctx_->ectx()->setResult(
+                "var1_prop",
+                ResultBuilder().value(std::move(value)).iter(Iterator::Kind::kProp).finish());
+        }
+        {
+            // The first rows of $var1
+            DataSet ds = qctx_->ectx()->getResult("var1").value().getDataSet();
+            ds.rows.resize(4);
+            qctx_->symTable()->newVariable("var1_head");
+            qctx_->ectx()->setResult(
+                "var1_head",
+                ResultBuilder().value(Value(std::move(ds))).finish());
+        }
         {
             DataSet ds;
             ds.colNames = {"src", "dst"};
@@ -82,6 +104,20 @@ protected:
     void testInnerJoin(std::string left, std::string right, DataSet& expected, int64_t line);
     void testLeftJoin(std::string left, std::string right, DataSet& expected, int64_t line);
 
+    // Join $var1 with itself and return the sorted result
+    DataSet joinVar1(bool leftJoin,
+                     const std::vector<std::string>& hashKeyProps,
+                     const std::vector<std::string>& probeKeyProps) {
+        return joinVars(leftJoin, "var1", "var1", hashKeyProps, probeKeyProps);
+    }
+
+    // Join two variables both in the columns of $var1 and return the sorted result
+    DataSet joinVars(bool leftJoin,
+                     const std::string& lhs,
+                     const std::string& rhs,
+                     const std::vector<std::string>& hashKeyProps,
+                     const std::vector<std::string>& probeKeyProps);
+
 protected:
     std::unique_ptr<QueryContext> qctx_;
     ObjectPool* pool_;
@@ -163,6 +199,45 @@ void JoinTest::testLeftJoin(std::string left, std::string right,
     EXPECT_EQ(result.state(), Result::State::kSuccess) << "LINE: " << line;
 }
 
+DataSet JoinTest::joinVars(bool leftJoin,
+                           const std::string& lhs,
+                           const std::string& rhs,
+                           const std::vector<std::string>& hashKeyProps,
+                           const std::vector<std::string>& probeKeyProps) {
+    std::vector<Expression*> hashKeys;
+    for (auto& prop : hashKeyProps) {
+        hashKeys.emplace_back(VariablePropertyExpression::make(pool_, lhs, prop));
+    }
+    std::vector<Expression*> probeKeys;
+    for (auto& prop : probeKeyProps) {
+        probeKeys.emplace_back(VariablePropertyExpression::make(pool_, rhs, prop));
+    }
+    std::vector<std::string> colNames = {
+        kVid, "tag_prop", "edge_prop", kDst, kVid, "tag_prop", "edge_prop", kDst};
+
+    Executor* exe = nullptr;
+    PlanNode* node = nullptr;
+    if (leftJoin) {
+        node = LeftJoin::make(qctx_.get(), nullptr, {lhs, 0}, {rhs, 0},
+                              std::move(hashKeys), std::move(probeKeys));
+        exe = pool_->add(new LeftJoinExecutor(node, qctx_.get()));
+    } else {
+        node = InnerJoin::make(qctx_.get(), nullptr, {lhs, 0}, {rhs, 0},
+                               std::move(hashKeys), std::move(probeKeys));
+        exe = pool_->add(new InnerJoinExecutor(node, qctx_.get()));
+    }
+    node->setColNames(std::move(colNames));
+    EXPECT_TRUE(exe->execute().get().ok());
+    auto& result = qctx_->ectx()->getResult(node->outputVar());
+    EXPECT_EQ(result.state(), Result::State::kSuccess);
+    DataSet ds = result.value().getDataSet();
+    std::sort(ds.rows.begin(), ds.rows.end(), [](const Row& lhs, const Row& rhs) {
+        return std::lexicographical_compare(
+            lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end());
+    });
+    return ds;
+}
+
 TEST_F(JoinTest, InnerJoin) {
     DataSet expected;
     expected.colNames = {
@@ -558,5 +633,87 @@ TEST_F(JoinTest, InnerJoinAndLeftjoin) {
     EXPECT_EQ(result.state(), Result::State::kSuccess);
 }
 
+TEST_F(JoinTest, JoinInParallel) {
+    auto check = [this](bool leftJoin,
+                        std::vector<std::string> hashKeyProps,
+                        std::vector<std::string> probeKeyProps) {
+        auto expected = joinVar1(leftJoin, hashKeyProps, probeKeyProps);
+        gflags::FlagSaver flagSaver;
+        FLAGS_max_query_parallelism = 3;
+        FLAGS_morsel_size = 2;
+        FLAGS_join_partition_size = 1;
+        auto ds = joinVar1(leftJoin, std::move(hashKeyProps), std::move(probeKeyProps));
+        EXPECT_FALSE(ds.rows.empty());
+        EXPECT_EQ(ds, expected);
+    };
+
+    // $var1 join $var1 on $var1.edge_prop = $var1.tag_prop
+    check(false, {"edge_prop"}, {"tag_prop"});
+    check(true, {"edge_prop"}, {"tag_prop"});
+    // $var1 join $var1 on ($var1._vid, $var1.tag_prop) = ($var1._vid, $var1.tag_prop)
+    check(false, {kVid, "tag_prop"}, {kVid, "tag_prop"});
+    check(true, {kVid, "tag_prop"}, {kVid, "tag_prop"});
+}
+
+TEST_F(JoinTest, JoinInParallelBySmallerSide) {
+    auto check = [this](bool leftJoin, const std::string& lhs, const std::string& rhs) {
+        auto expected = joinVars(leftJoin, lhs, rhs, {"edge_prop"}, {"tag_prop"});
+        gflags::FlagSaver flagSaver;
+        FLAGS_max_query_parallelism = 3;
+        FLAGS_morsel_size = 2;
+        FLAGS_join_partition_size = 1;
+        auto ds = joinVars(leftJoin, lhs, rhs, {"edge_prop"}, {"tag_prop"});
+        EXPECT_FALSE(ds.rows.empty());
+        EXPECT_EQ(ds, expected) << lhs << " join " << rhs;
+    };
+
+    // The hash table is built on the left side, which is the smaller one
+    check(false, "var1_head", "var1");
+    check(true, "var1_head", "var1");
+    // Or on the right side, and the columns are exchanged back
+    check(false, "var1", "var1_head");
+    check(true, "var1", "var1_head");
+}
+
+TEST_F(JoinTest, ProbeInParallel) {
+    auto check = [this](const std::string& lhs, const std::string& rhs) {
+        auto expected = joinVars(false, lhs, rhs, {"edge_prop"}, {"tag_prop"});
+        gflags::FlagSaver flagSaver;
+        FLAGS_max_query_parallelism = 3;
+        FLAGS_morsel_size = 2;
+        auto ds = joinVars(false, lhs, rhs, {"edge_prop"}, {"tag_prop"});
+        EXPECT_FALSE(ds.rows.empty());
+        EXPECT_EQ(ds, expected) << lhs << " join " << rhs;
+    };
+
+    // Build on $var1 and probe $var1_prop in morsels, the columns are exchanged back
+    check("var1_prop", "var1");
+    // Build on $var1_head and probe $var1_prop in morsels
+    check("var1_head", "var1_prop");
+}
+
+TEST_F(JoinTest, JoinBySpilling) {
+    auto check = [this](bool leftJoin,
+                        std::vector<std::string> hashKeyProps,
+                        std::vector<std::string> probeKeyProps) {
+        auto expected = joinVar1(leftJoin, hashKeyProps, probeKeyProps);
+        gflags::FlagSaver flagSaver;
+        // The tiny budgets partition the oversize partitions again
+        for (int64_t budget : {1, 200, 1L << 30}) {
+            FLAGS_query_spill_memory_bytes = budget;
+            auto ds = joinVar1(leftJoin, hashKeyProps, probeKeyProps);
+            EXPECT_FALSE(ds.rows.empty());
+            EXPECT_EQ(ds, expected) << "budget: " << budget;
+        }
+    };
+
+    // $var1 join $var1 on $var1.edge_prop = $var1.tag_prop
+    check(false, {"edge_prop"}, {"tag_prop"});
+    check(true, {"edge_prop"}, {"tag_prop"});
+    // $var1 join $var1 on ($var1._vid, $var1.tag_prop) = ($var1._vid, $var1.tag_prop)
+    check(false, {kVid, "tag_prop"}, {kVid, "tag_prop"});
+    check(true, {kVid, "tag_prop"}, {kVid, "tag_prop"});
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -0,0 +1,160 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "common/interface/gen-cpp2/graph_types.h"
+#include "context/QueryContext.h"
+#include "executor/query/PipelineExecutor.h"
+#include "executor/test/QueryTestBase.h"
+#include "planner/plan/Logic.h"
+#include "planner/plan/Query.h"
+#include "util/ExpressionUtils.h"
+
+DECLARE_bool(enable_pipeline_execution);
+DECLARE_uint32(pipeline_batch_size);
+
+namespace nebula {
+namespace graph {
+
+class PipelineTest : public QueryTestBase, public ::testing::WithParamInterface<uint32_t> {
+public:
+    void SetUp() override {
+        QueryTestBase::SetUp();
+        FLAGS_enable_pipeline_execution = true;
+        FLAGS_pipeline_batch_size = GetParam();
+    }
+
+protected:
+    Project* makeProject(PlanNode* input) {
+        auto yieldSentence = getYieldSentence(
+            "YIELD $-.v_name AS name, $-.e_start_year AS start WHERE $-.e_start_year > 2008",
+            qctx_.get());
+        auto* filter = Filter::make(qctx_.get(), input, yieldSentence->where()->filter());
+        filter->setInputVar("input_sequential");
+        // Filter is fused at the bottom of chain to select the input rows for Project
+        auto* project = Project::make(qctx_.get(), filter, yieldSentence->yieldColumns());
+        project->setColNames(std::vector<std::string>{"name", "start"});
+        return project;
+    }
+
+    void check(const PlanNode* root, const DataSet& expected) {
+        auto* exec = Executor::create(root, qctx_.get());
+        ASSERT_NE(dynamic_cast<PipelineExecutor*>(exec), nullptr);
+        // Execute the dependencies
+        for (auto* dep : exec->depends()) {
+            for (auto* input : dep->depends()) {
+                EXPECT_TRUE(input->execute().get().ok());
+            }
+            EXPECT_TRUE(dep->execute().get().ok());
+        }
+        EXPECT_TRUE(exec->execute().get().ok());
+        auto& result = qctx_->ectx()->getResult(root->outputVar());
+        EXPECT_EQ(result.state(), Result::State::kSuccess);
+        EXPECT_EQ(result.value().getDataSet(), expected);
+    }
+};
+
+TEST_P(PipelineTest, ProjectLimit) {
+    auto* start = StartNode::make(qctx_.get());
+    auto* project = makeProject(start);
+    auto* limit = Limit::make(qctx_.get(), project, 1, 2);
+    limit->setColNames(project->colNames());
+
+    DataSet expected({"name", "start"});
+    expected.emplace_back(Row({Value("Joy"), Value(2009)}));
+    expected.emplace_back(Row({Value("Kate"), Value(2009)}));
+    check(limit, expected);
+}
+
+TEST_P(PipelineTest, DedupOnlyOnTop) {
+    auto* start = StartNode::make(qctx_.get());
+    auto* project = makeProject(start);
+    auto* dedup = Dedup::make(qctx_.get(), project);
+    dedup->setColNames(project->colNames());
+    auto* limit = Limit::make(qctx_.get(), dedup, 0, 10);
+    limit->setColNames(project->colNames());
+
+    // Dedup keeps the unique rows in the output of chain, so the chain ends with it
+    EXPECT_TRUE(PipelineExecutor::collectChain(limit).empty());
+    auto chain = PipelineExecutor::collectChain(dedup);
+    ASSERT_EQ(chain.size(), 3U);
+    EXPECT_EQ(chain.front()->kind(), PlanNode::Kind::kFilter);
+
+    DataSet expected({"name", "start"});
+    expected.emplace_back(Row({Value("Ann"), Value(2010)}));
+    expected.emplace_back(Row({Value("Joy"), Value(2009)}));
+    expected.emplace_back(Row({Value("Kate"), Value(2009)}));
+    expected.emplace_back(Row({Value("Lily"), Value(2009)}));
+    check(dedup, expected);
+}
+
+TEST_P(PipelineTest, FilterGetNeighbors) {
+    auto* pool = qctx_->objPool();
+    auto yieldSentence = getYieldSentence(
+        "YIELD $^.person.name AS name WHERE study.start_year >= 2010", qctx_.get());
+    auto* condition =
+        ExpressionUtils::rewriteLabelAttr2EdgeProp(pool, yieldSentence->where()->filter());
+    auto* start = StartNode::make(qctx_.get());
+    auto* filter = Filter::make(qctx_.get(), start, condition);
+    filter->setInputVar("input_neighbor");
+    auto* project = Project::make(qctx_.get(), filter, yieldSentence->yieldColumns());
+    project->setColNames(std::vector<std::string>{"name"});
+
+    // The rows are selected on the iterator of GetNeighbors
+    DataSet expected({"name"});
+    expected.emplace_back(Row({Value("Ann")}));
+    expected.emplace_back(Row({Value("Ann")}));
+    expected.emplace_back(Row({Value("Tom")}));
+    check(project, expected);
+}
+
+TEST_P(PipelineTest, ProfileFusedNodes) {
+    auto* start = StartNode::make(qctx_.get());
+    auto* project = makeProject(start);
+    auto* dedup = Dedup::make(qctx_.get(), project);
+    dedup->setColNames(project->colNames());
+    qctx_->plan()->setRoot(dedup);
+    PlanDescription planDesc;
+    qctx_->plan()->describe(&planDesc);
+
+    DataSet expected({"name", "start"});
+    expected.emplace_back(Row({Value("Ann"), Value(2010)}));
+    expected.emplace_back(Row({Value("Joy"), Value(2009)}));
+    expected.emplace_back(Row({Value("Kate"), Value(2009)}));
+    expected.emplace_back(Row({Value("Lily"), Value(2009)}));
+    check(dedup, expected);
+    EXPECT_TRUE(Executor::create(dedup, qctx_.get())->close().ok());
+
+    // Each fused node has its own stats
+    auto profileOf = [&planDesc](const PlanNode* node) -> const ProfilingStats& {
+        auto& desc = planDesc.planNodeDescs[planDesc.nodeIndexMap.at(node->id())];
+        EXPECT_EQ(desc.profiles->size(), 1);
+        return desc.profiles->front();
+    };
+    auto& projectStats = profileOf(project);
+    EXPECT_GT(projectStats.rows, expected.rows.size());
+    ASSERT_NE(projectStats.otherStats, nullptr);
+    EXPECT_EQ(projectStats.otherStats->at("fused into"),
+              folly::stringPrintf("Dedup_%ld", dedup->id()));
+    EXPECT_EQ(profileOf(dedup).rows, expected.rows.size());
+}
+
+TEST_P(PipelineTest, NotFusedIfShared) {
+    auto* start = StartNode::make(qctx_.get());
+    auto* project = makeProject(start);
+    auto* dedup = Dedup::make(qctx_.get(), project);
+    auto* limit = Limit::make(qctx_.get(), project, 0, 1);
+    UNUSED(limit);
+
+    // The output of project is also read by limit
+    EXPECT_TRUE(PipelineExecutor::collectChain(dedup).empty());
+}
+
+INSTANTIATE_TEST_CASE_P(BatchSize, PipelineTest, ::testing::Values(1, 2, 1024));
+
+}   // namespace graph
+}   // namespace nebula
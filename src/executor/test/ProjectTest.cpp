@@ -11,6 +11,10 @@
 #include "executor/test/QueryTestBase.h"
 #include "planner/plan/Logic.h"
 #include "planner/plan/Query.h"
+#include "validator/Validator.h"
+
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
 
 namespace nebula {
 namespace graph {
@@ -101,6 +105,65 @@ TEST_F(ProjectTest, Project2Col) {
     EXPECT_EQ(result.state(), Result::State::kSuccess);
 }
 
+TEST_F(ProjectTest, ProjectInParallel) {
+    FLAGS_max_query_parallelism = 4;
+    FLAGS_morsel_size = 3;
+    std::string input = "input_project";
+    auto yieldColumns = getYieldColumns(
+        "YIELD $input_project.vid AS vid, $input_project.col2 + 1 AS col2", qctx_.get());
+    auto* project = Project::make(qctx_.get(), start_, yieldColumns);
+    project->setInputVar(input);
+    project->setColNames(std::vector<std::string>{"vid", "col2"});
+
+    auto proExe = Executor::create(project, qctx_.get());
+    auto status = proExe->execute().get();
+    EXPECT_TRUE(status.ok());
+    auto& result = qctx_->ectx()->getResult(project->outputVar());
+
+    // The results of morsels are concatenated in order
+    DataSet expected;
+    expected.colNames = {"vid", "col2"};
+    for (auto i = 0; i < 10; ++i) {
+        Row row;
+        row.values.emplace_back(i);
+        row.values.emplace_back(i + 2);
+        expected.rows.emplace_back(std::move(row));
+    }
+    EXPECT_EQ(result.value().getDataSet(), expected);
+    EXPECT_EQ(result.state(), Result::State::kSuccess);
+}
+
+TEST_F(ProjectTest, ProjectWithParameter) {
+    std::string input = "input_project";
+    auto yieldColumns = getYieldColumns("YIELD $input_project.vid + $p AS vid", qctx_.get());
+    auto* project = Project::make(qctx_.get(), start_, yieldColumns);
+    project->setInputVar(input);
+    project->setColNames(std::vector<std::string>{"vid"});
+
+    // Bind the parameter the way QueryInstance does
+    std::unordered_map<std::string, Value> params = {{"p", 10}};
+    ASSERT_TRUE(Validator::validateParameters(params, qctx_.get()).ok());
+    EXPECT_FALSE(Validator::validateParameters({{"input_project", 10}}, qctx_.get()).ok());
+    for (auto& param : params) {
+        qctx_->ectx()->setValue(param.first, Value(param.second));
+    }
+
+    auto proExe = Executor::create(project, qctx_.get());
+    auto status = proExe->execute().get();
+    EXPECT_TRUE(status.ok());
+    auto& result = qctx_->ectx()->getResult(project->outputVar());
+
+    DataSet expected;
+    expected.colNames = {"vid"};
+    for (auto i = 0; i < 10; ++i) {
+        Row row;
+        row.values.emplace_back(i + 10);
+        expected.rows.emplace_back(std::move(row));
+    }
+    EXPECT_EQ(result.value().getDataSet(), expected);
+    EXPECT_EQ(result.state(), Result::State::kSuccess);
+}
+
 TEST_F(ProjectTest, EmptyInput) {
     std::string input = "empty";
     auto yieldColumns = getYieldColumns("YIELD $input_project.vid AS vid", qctx_.get());
@@ -154,6 +154,8 @@ protected:
     }
 
 protected:
+    // Restore the flags changed by each test
+    gflags::FlagSaver                     flagSaver_;
     std::unique_ptr<QueryContext>         qctx_;
     std::unique_ptr<Sentence>             sentences_;
 };
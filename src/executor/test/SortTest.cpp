@@ -13,6 +13,10 @@
 #include "planner/plan/Logic.h"
 #include "planner/plan/Query.h"
 
+DECLARE_int64(query_spill_memory_bytes);
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+
 namespace nebula {
 namespace graph {
 
@@ -131,5 +135,132 @@ TEST_F(SortTest, sortTwoColDesDes_union) {
     factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::DESCEND));
     SORT_RESUTL_CHECK("union_sequential", "union_sort_two_cols_des_des", true, factors, expected);
 }
+
+TEST_F(SortTest, sortInParallel) {
+    // Every row is a morsel
+    FLAGS_max_query_parallelism = 3;
+    FLAGS_morsel_size = 1;
+    {
+        DataSet expected({"age", "start_year"});
+        expected.emplace_back(Row({18, 2010}));
+        expected.emplace_back(Row({18, 2010}));
+        expected.emplace_back(Row({19, 2009}));
+        expected.emplace_back(Row({20, 2009}));
+        expected.emplace_back(Row({20, 2008}));
+        expected.emplace_back(Row({Value::kNullValue, 2009}));
+        std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+        factors.emplace_back(std::make_pair(2, OrderFactor::OrderType::ASCEND));
+        factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::DESCEND));
+        SORT_RESUTL_CHECK("input_sequential", "sort_int_in_parallel", true, factors, expected);
+    }
+    // Sort by the string column first
+    {
+        DataSet expected({"age", "start_year"});
+        expected.emplace_back(Row({19, 2009}));
+        expected.emplace_back(Row({20, 2008}));
+        expected.emplace_back(Row({20, 2009}));
+        expected.emplace_back(Row({Value::kNullValue, 2009}));
+        expected.emplace_back(Row({18, 2010}));
+        expected.emplace_back(Row({18, 2010}));
+        std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+        factors.emplace_back(std::make_pair(3, OrderFactor::OrderType::DESCEND));
+        factors.emplace_back(std::make_pair(2, OrderFactor::OrderType::ASCEND));
+        factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::ASCEND));
+        SORT_RESUTL_CHECK("input_sequential", "sort_str_in_parallel", true, factors, expected);
+    }
+}
+
+TEST_F(SortTest, sortBySpilling) {
+    DataSet expected({"age", "start_year"});
+    expected.emplace_back(Row({18, 2010}));
+    expected.emplace_back(Row({18, 2010}));
+    expected.emplace_back(Row({19, 2009}));
+    expected.emplace_back(Row({20, 2009}));
+    expected.emplace_back(Row({20, 2008}));
+    expected.emplace_back(Row({Value::kNullValue, 2009}));
+    std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+    factors.emplace_back(std::make_pair(2, OrderFactor::OrderType::ASCEND));
+    factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::DESCEND));
+    // Sorted in place without a limit, the input is resident already
+    FLAGS_query_spill_memory_bytes = 1;
+    SORT_RESUTL_CHECK("input_sequential", "sort_spill_no_limit", true, factors, expected);
+    auto& input = qctx_->ectx()->getResult("input_sequential");
+    EXPECT_EQ(qctx_->ectx()->getResult("sort_spill_no_limit").valuePtr(), input.valuePtr());
+
+    // Every row is a sorted run, or several rows in a run
+    for (auto budget : {1, 1000}) {
+        FLAGS_query_spill_memory_bytes = budget;
+        auto* start = StartNode::make(qctx_.get());
+        auto* sortNode = Sort::make(qctx_.get(), start, factors);
+        sortNode->setInputVar("input_sequential");
+        Limit::make(qctx_.get(), sortNode, 0, 5);
+        auto* sortExec = Executor::create(sortNode, qctx_.get());
+        EXPECT_TRUE(sortExec->execute().get().ok());
+        // The rows after the limit are dropped from the runs
+        auto& sortResult = qctx_->ectx()->getResult(sortNode->outputVar());
+        auto& rows = sortResult.value().getDataSet().rows;
+        ASSERT_EQ(rows.size(), 5);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            EXPECT_EQ(rows[i].values[2], expected.rows[i].values[0]);
+            EXPECT_EQ(rows[i].values[4], expected.rows[i].values[1]);
+        }
+    }
+}
+
+TEST_F(SortTest, sortBySpillingInMultiplePasses) {
+    DataSet ds({"v"});
+    for (int64_t i = 0; i < 1000; ++i) {
+        ds.emplace_back(Row({(i * 7919) % 1000}));
+    }
+    qctx_->symTable()->newVariable("input_many");
+    qctx_->ectx()->setResult("input_many", ResultBuilder().value(Value(std::move(ds))).finish());
+    std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+    factors.emplace_back(std::make_pair(0, OrderFactor::OrderType::ASCEND));
+
+    // A tiny budget merges two runs at once: a thousand runs are merged level by level
+    // while spilling, and the rest of levels in passes
+    for (auto budget : {1, 100}) {
+        FLAGS_query_spill_memory_bytes = budget;
+        auto* start = StartNode::make(qctx_.get());
+        auto* sortNode = Sort::make(qctx_.get(), start, factors);
+        sortNode->setInputVar("input_many");
+        Limit::make(qctx_.get(), sortNode, 0, 999);
+        auto* sortExec = Executor::create(sortNode, qctx_.get());
+        EXPECT_TRUE(sortExec->execute().get().ok());
+        auto& rows = qctx_->ectx()->getResult(sortNode->outputVar()).value().getDataSet().rows;
+        ASSERT_EQ(rows.size(), 999);
+        for (int64_t i = 0; i < 999; ++i) {
+            EXPECT_EQ(rows[i].values[0], Value(i));
+        }
+    }
+}
+
+TEST_F(SortTest, sortBySpillingWithLimit) {
+    std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+    factors.emplace_back(std::make_pair(2, OrderFactor::OrderType::ASCEND));
+    factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::DESCEND));
+    auto* start = StartNode::make(qctx_.get());
+    auto* sortNode = Sort::make(qctx_.get(), start, factors);
+    sortNode->setInputVar("input_sequential");
+    auto* limit = Limit::make(qctx_.get(), sortNode, 1, 2);
+
+    FLAGS_query_spill_memory_bytes = 1;
+    auto* sortExec = Executor::create(sortNode, qctx_.get());
+    EXPECT_TRUE(sortExec->execute().get().ok());
+    // Only the rows read by limit are merged
+    auto& sortResult = qctx_->ectx()->getResult(sortNode->outputVar());
+    EXPECT_EQ(sortResult.value().getDataSet().rows.size(), 3);
+
+    auto* limitExec = Executor::create(limit, qctx_.get());
+    EXPECT_TRUE(limitExec->execute().get().ok());
+    auto& limitResult = qctx_->ectx()->getResult(limit->outputVar());
+    auto iter = limitResult.iter();
+    std::vector<std::pair<Value, Value>> rows;
+    for (; iter->valid(); iter->next()) {
+        rows.emplace_back(iter->getColumn("v_age"), iter->getColumn("e_start_year"));
+    }
+    std::vector<std::pair<Value, Value>> expected = {{18, 2010}, {19, 2009}};
+    EXPECT_EQ(rows, expected);
+}
 }   // namespace graph
 }   // namespace nebula
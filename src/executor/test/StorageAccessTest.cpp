@@ -0,0 +1,146 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "context/QueryContext.h"
+#include "executor/StorageAccessExecutor.h"
+#include "planner/plan/Logic.h"
+
+using nebula::storage::StorageRpcResponse;
+using nebula::storage::cpp2::GetPropResponse;
+
+namespace nebula {
+namespace graph {
+
+class StorageAccessTestExecutor final : public StorageAccessExecutor {
+public:
+    StorageAccessTestExecutor(const PlanNode* node, QueryContext* qctx)
+        : StorageAccessExecutor("StorageAccessTestExecutor", node, qctx) {}
+
+    folly::Future<Status> execute() override {
+        return Status::OK();
+    }
+
+    const std::unordered_map<std::string, std::string>& stats() const {
+        return otherStats_;
+    }
+
+    using StorageAccessExecutor::addStats;
+    using StorageAccessExecutor::splitRows;
+    using StorageAccessExecutor::streamRequests;
+};
+
+class StorageAccessTest : public testing::Test {
+protected:
+    void SetUp() override {
+        qctx_ = std::make_unique<QueryContext>();
+        exe_ = std::make_unique<StorageAccessTestExecutor>(StartNode::make(qctx_.get()),
+                                                           qctx_.get());
+    }
+
+    static DataSet vertices(std::vector<int64_t> vids) {
+        DataSet ds({"_vid"});
+        for (auto vid : vids) {
+            ds.rows.emplace_back(Row({vid}));
+        }
+        return ds;
+    }
+
+    // The response of a host taking `execUs' to get the props of vertices
+    static StorageRpcResponse<GetPropResponse> respond(const HostAddr& host,
+                                                       int32_t execUs,
+                                                       DataSet ds) {
+        StorageRpcResponse<GetPropResponse> resp(1);
+        GetPropResponse r;
+        r.props_ref() = std::move(ds);
+        resp.responses().emplace_back(std::move(r));
+        resp.setLatency(host, execUs, execUs * 2);
+        return resp;
+    }
+
+protected:
+    std::unique_ptr<QueryContext>                   qctx_;
+    std::unique_ptr<StorageAccessTestExecutor>      exe_;
+};
+
+TEST_F(StorageAccessTest, SplitByParts) {
+    auto partOf = [](const Value& vid) { return vid.getInt() % 3 + 1; };
+    {
+        auto requests = exe_->splitRows(vertices({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), 0, partOf);
+        std::vector<DataSet> expected = {
+            vertices({0, 3, 6, 9}), vertices({1, 4, 7}), vertices({2, 5, 8})};
+        EXPECT_EQ(requests, expected);
+    }
+    {
+        // A new chunk of the partition is started once the last one is full
+        auto requests = exe_->splitRows(vertices({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), 2, partOf);
+        std::vector<DataSet> expected = {vertices({0, 3}),
+                                         vertices({1, 4}),
+                                         vertices({2, 5}),
+                                         vertices({6, 9}),
+                                         vertices({7}),
+                                         vertices({8})};
+        EXPECT_EQ(requests, expected);
+    }
+}
+
+TEST_F(StorageAccessTest, SplitByChunks) {
+    {
+        auto requests = exe_->splitRows(vertices({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), 4, nullptr);
+        std::vector<DataSet> expected = {
+            vertices({0, 1, 2, 3}), vertices({4, 5, 6, 7}), vertices({8, 9})};
+        EXPECT_EQ(requests, expected);
+    }
+    {
+        // Neither by parts nor by chunks
+        auto requests = exe_->splitRows(vertices({0, 1, 2}), 0, nullptr);
+        ASSERT_EQ(requests.size(), 1);
+        EXPECT_EQ(requests.front(), vertices({0, 1, 2}));
+    }
+}
+
+TEST_F(StorageAccessTest, StreamRequests) {
+    HostAddr host("127.0.0.1", 9779);
+    std::vector<DataSet> requests = {vertices({0, 3}), vertices({1, 4}), vertices({2})};
+    auto send = [host](DataSet ds) {
+        if (ds.rows.front().values.front() == Value(1)) {
+            StorageRpcResponse<GetPropResponse> resp(1);
+            resp.markFailure();
+            resp.failedParts().emplace(2, nebula::cpp2::ErrorCode::E_LEADER_CHANGED);
+            return folly::makeSemiFuture(std::move(resp));
+        }
+        return folly::makeSemiFuture(respond(host, 10, std::move(ds)));
+    };
+    std::vector<Value> vids;
+    auto onResp = [&vids, this](StorageRpcResponse<GetPropResponse>& resp) {
+        exe_->addStats(resp);
+        for (auto& r : resp.responses()) {
+            for (auto& row : r.props_ref()->rows) {
+                vids.emplace_back(row.values.front());
+            }
+        }
+    };
+    auto resp = exe_->streamRequests<GetPropResponse>(std::move(requests), 2, send, onResp).get();
+
+    // The datasets are taken by onResp
+    EXPECT_TRUE(resp.responses().empty());
+    std::sort(vids.begin(), vids.end());
+    EXPECT_EQ(vids, std::vector<Value>({0, 2, 3}));
+    EXPECT_EQ(resp.completeness(), 66);
+    ASSERT_EQ(resp.failedParts().size(), 1);
+    EXPECT_EQ(resp.failedParts().begin()->first, 2);
+    EXPECT_EQ(resp.hostLatency().size(), 2);
+
+    // The stats of the host are summed up over its responses
+    auto& stats = exe_->stats();
+    EXPECT_EQ(stats.at("streamed requests"), "3 in 2 lanes");
+    EXPECT_EQ(stats.at(folly::stringPrintf("%s exec/total/rows", host.toString().c_str())),
+              "20(us)/40(us)/3 in 2 responses");
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -13,6 +13,9 @@
 #include "planner/plan/Logic.h"
 #include "planner/plan/Query.h"
 
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+
 namespace nebula {
 namespace graph {
 
@@ -113,5 +116,19 @@ TEST_F(TopNTest, topnTwoColDesAsc) {
     factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::ASCEND));
     TOPN_RESUTL_CHECK("input_sequential", "topn_two_cols_des_asc", true, factors, 1, 9, expected);
 }
+TEST_F(TopNTest, topnInParallel) {
+    // Every row is a morsel
+    FLAGS_max_query_parallelism = 3;
+    FLAGS_morsel_size = 1;
+    DataSet expected({"age", "start_year"});
+    expected.emplace_back(Row({18, 2010}));
+    expected.emplace_back(Row({19, 2009}));
+    expected.emplace_back(Row({20, 2009}));
+    std::vector<std::pair<size_t, OrderFactor::OrderType>> factors;
+    factors.emplace_back(std::make_pair(2, OrderFactor::OrderType::ASCEND));
+    factors.emplace_back(std::make_pair(4, OrderFactor::OrderType::DESCEND));
+    TOPN_RESUTL_CHECK("input_sequential", "topn_in_parallel", true, factors, 1, 3, expected);
+}
+
 }   // namespace graph
 }   // namespace nebula
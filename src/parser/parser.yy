@@ -533,6 +533,7 @@ expression
         delete $1;
     }
     | VARIABLE {
+        qctx->addReferredVar(*$1);
         $$ = VariableExpression::make(qctx->objPool(), *$1);
         delete $1;
     }
@@ -685,6 +686,9 @@ compound_expression
         $$ = $1;
     }
     | function_call_expression {
+        if (graph::ExpressionUtils::findNonDeterministicFunction($1)) {
+            qctx->setNonDeterministic();
+        }
         $$ = $1;
     }
     | container_expression {
@@ -722,6 +726,7 @@ subscript_expression
         delete $1;
     }
     | VARIABLE L_BRACKET expression R_BRACKET {
+        qctx->addReferredVar(*$1);
         $$ = SubscriptExpression::make(qctx->objPool(), VariableExpression::make(qctx->objPool(), *$1), $3);
         delete $1;
     }
@@ -744,14 +749,17 @@ subscript_range_expression
         delete($1);
     }
     | VARIABLE L_BRACKET expression DOT_DOT expression R_BRACKET {
+        qctx->addReferredVar(*$1);
         $$ = SubscriptRangeExpression::make(qctx->objPool(), VariableExpression::make(qctx->objPool(), *$1), $3, $5);
         delete($1);
     }
     | VARIABLE L_BRACKET DOT_DOT expression R_BRACKET {
+        qctx->addReferredVar(*$1);
         $$ = SubscriptRangeExpression::make(qctx->objPool(), VariableExpression::make(qctx->objPool(), *$1), nullptr, $4);
         delete($1);
     }
     | VARIABLE L_BRACKET expression DOT_DOT R_BRACKET {
+        qctx->addReferredVar(*$1);
         $$ = SubscriptRangeExpression::make(qctx->objPool(), VariableExpression::make(qctx->objPool(), *$1), $3, nullptr);
         delete($1);
     }
@@ -1226,6 +1234,12 @@ from_clause
     | KW_FROM vid_ref_expression {
         $$ = new FromClause($2);
     }
+    | KW_FROM VARIABLE {
+        // The list of vids bound as a parameter
+        qctx->addReferredVar(*$2);
+        $$ = new FromClause(VariableExpression::make(qctx->objPool(), *$2));
+        delete $2;
+    }
     ;
 
 vid_list
@@ -1244,6 +1258,9 @@ vid
         $$ = ConstantExpression::make(qctx->objPool(), $1);
     }
     | function_call_expression {
+        if (graph::ExpressionUtils::findNonDeterministicFunction($1)) {
+            qctx->setNonDeterministic();
+        }
         $$ = $1;
     }
     | uuid_expression {
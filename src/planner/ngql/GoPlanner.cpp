@@ -398,7 +398,7 @@ SubPlan GoPlanner::nStepsPlan(SubPlan& startVidPlan) {
     auto* getDst = QueryUtil::extractDstFromGN(qctx, gn, goCtx_->vidsVar);
 
     PlanNode* loopBody = getDst;
-    PlanNode* loopDep = nullptr;
+    PlanNode* loopDep = startVidPlan.root;
     if (goCtx_->joinInput) {
         auto* joinLeft = extractVidFromRuntimeInput(startVidPlan.root);
         auto* joinRight = extractSrcDstFromGN(getDst, gn->outputVar());
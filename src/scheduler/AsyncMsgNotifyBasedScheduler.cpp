@@ -6,10 +6,14 @@
 
 #include "scheduler/AsyncMsgNotifyBasedScheduler.h"
 
+#include "scheduler/ChainRunner.h"
+#include "service/GraphFlags.h"
+
 DECLARE_bool(enable_lifetime_optimize);
 
 namespace nebula {
 namespace graph {
+
 AsyncMsgNotifyBasedScheduler::AsyncMsgNotifyBasedScheduler(QueryContext* qctx) : Scheduler() {
     qctx_ = qctx;
 }
@@ -20,54 +24,91 @@ folly::Future<Status> AsyncMsgNotifyBasedScheduler::schedule() {
         analyzeLifetime(qctx_->plan()->root());
     }
     auto executor = Executor::create(qctx_->plan()->root(), qctx_);
+    chainRunner_ = std::make_unique<ChainRunner>(qctx_->rctx()->runner());
+    compile(executor);
     return doSchedule(executor);
 }
 
-folly::Future<Status> AsyncMsgNotifyBasedScheduler::doSchedule(Executor* root) const {
-    std::unordered_map<int64_t, std::vector<folly::Promise<Status>>> promiseMap;
-    std::unordered_map<int64_t, std::vector<folly::Future<Status>>> futureMap;
-    std::queue<Executor*> queue;
-    std::queue<Executor*> queue2;
-    std::unordered_set<Executor*> visited;
-
-    auto* runner = qctx_->rctx()->runner();
-    folly::Promise<Status> promiseForRoot;
-    auto resultFuture = promiseForRoot.getFuture();
-    promiseMap[root->id()].emplace_back(std::move(promiseForRoot));
-    queue.push(root);
-    visited.emplace(root);
-    while (!queue.empty()) {
-        auto* exe = queue.front();
-        queue.pop();
-        queue2.push(exe);
+void AsyncMsgNotifyBasedScheduler::compile(Executor* root) {
+    if (graphs_.find(root) != graphs_.end()) {
+        return;
+    }
+    auto graph = std::make_unique<ScheduleGraph>();
+    std::unordered_map<Executor*, size_t> indices;
+    std::vector<Executor*> bodies;
 
-        std::vector<folly::Future<Status>> futures;
+    indices.emplace(root, 0);
+    graph->executors.emplace_back(root);
+    graph->numPromises.emplace_back(1);
+    // The executors are appended in the order of search, so the vector is the queue
+    for (size_t i = 0; i < graph->executors.size(); ++i) {
+        auto* exe = graph->executors[i];
+        std::vector<size_t> depends;
+        depends.reserve(exe->depends().size());
         for (auto* dep : exe->depends()) {
-            auto notVisited = visited.emplace(dep).second;
-            if (notVisited) {
-                queue.push(dep);
+            auto inserted = indices.emplace(dep, graph->executors.size());
+            if (inserted.second) {
+                graph->executors.emplace_back(dep);
+                graph->numPromises.emplace_back(0);
             }
-            folly::Promise<Status> p;
-            futures.emplace_back(p.getFuture());
-            auto& promises = promiseMap[dep->id()];
-            promises.emplace_back(std::move(p));
+            auto index = inserted.first->second;
+            graph->numPromises[index] += 1;
+            depends.emplace_back(index);
+        }
+        graph->depends.emplace_back(std::move(depends));
+        // Only the executors run by runExecutor are chained
+        auto kind = exe->node()->kind();
+        graph->inlined.emplace_back(FLAGS_inline_executor_time_slice_us > 0 &&
+                                    kind != PlanNode::Kind::kSelect &&
+                                    kind != PlanNode::Kind::kLoop &&
+                                    exe->depends().size() == 1 &&
+                                    (*exe->depends().begin())->successors().size() == 1);
+
+        if (exe->node()->kind() == PlanNode::Kind::kLoop) {
+            bodies.emplace_back(static_cast<LoopExecutor*>(exe)->loopBody());
+        } else if (exe->node()->kind() == PlanNode::Kind::kSelect) {
+            bodies.emplace_back(static_cast<SelectExecutor*>(exe)->thenBody());
+            bodies.emplace_back(static_cast<SelectExecutor*>(exe)->elseBody());
         }
-        futureMap.emplace(exe->id(), std::move(futures));
     }
+    graphs_.emplace(root, std::move(graph));
 
-    while (!queue2.empty()) {
-        auto* exe = queue2.front();
-        queue2.pop();
+    for (auto* body : bodies) {
+        compile(body);
+    }
+}
+
+folly::Future<Status> AsyncMsgNotifyBasedScheduler::doSchedule(Executor* root) const {
+    auto found = graphs_.find(root);
+    DCHECK(found != graphs_.end());
+    auto& graph = *found->second;
+    auto numExecutors = graph.executors.size();
 
-        auto currentFuturesFound = futureMap.find(exe->id());
-        DCHECK(currentFuturesFound != futureMap.end());
-        auto currentExeFutures = std::move(currentFuturesFound->second);
+    std::vector<std::vector<folly::Promise<Status>>> promises(numExecutors);
+    std::vector<std::vector<folly::Future<Status>>> futures(numExecutors);
+    for (size_t i = 0; i < numExecutors; ++i) {
+        promises[i].reserve(graph.numPromises[i]);
+    }
 
-        auto currentPromisesFound = promiseMap.find(exe->id());
-        DCHECK(currentPromisesFound != promiseMap.end());
-        auto currentExePromises = std::move(currentPromisesFound->second);
+    auto* runner = qctx_->rctx()->runner();
+    folly::Promise<Status> promiseForRoot;
+    auto resultFuture = promiseForRoot.getFuture();
+    promises.front().emplace_back(std::move(promiseForRoot));
+    for (size_t i = 0; i < numExecutors; ++i) {
+        auto& depends = graph.depends[i];
+        futures[i].reserve(depends.size());
+        for (auto dep : depends) {
+            folly::Promise<Status> p;
+            futures[i].emplace_back(p.getFuture());
+            promises[dep].emplace_back(std::move(p));
+        }
+    }
 
-        scheduleExecutor(std::move(currentExeFutures), exe, runner, std::move(currentExePromises));
+    for (size_t i = 0; i < numExecutors; ++i) {
+        scheduleExecutor(std::move(futures[i]),
+                         graph.executors[i],
+                         graph.inlined[i] ? chainRunner_.get() : runner,
+                         std::move(promises[i]));
     }
 
     return resultFuture;
@@ -239,7 +280,9 @@ void AsyncMsgNotifyBasedScheduler::runLoop(std::vector<folly::Future<Status>>&&
                     }
                     if (val.getBool()) {
                         auto loopBody = loop->loopBody();
+                        time::Duration scheduleTime;
                         auto scheduleFuture = doSchedule(loopBody);
+                        loop->addScheduleTime(scheduleTime.elapsedInUSec());
                         std::vector<folly::Future<Status>> fs;
                         fs.emplace_back(std::move(scheduleFuture));
                         runLoop(std::move(fs), loop, runner, std::move(pros));
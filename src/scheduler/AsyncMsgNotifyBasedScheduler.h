@@ -21,6 +21,11 @@ namespace graph {
  * send a message to the nodes who is depend on it.
  * A bread first search would be applied to traverse the whole execution plan, and build the
  * message notifiers according to the previously described mechanism.
+ * The search is done only once for the plan and each body of loop and select, the result is
+ * kept as a schedule graph which just creates the notifiers each time the body is run.
+ * An executor which is the only successor of its only dependency, i.e. in the middle of a
+ * linear chain, runs right on the thread finishing the dependency instead of hopping to the
+ * thread pool, until the chain has run out of the time slice on that thread.
  */
 class AsyncMsgNotifyBasedScheduler final : public Scheduler {
 public:
@@ -29,6 +34,26 @@ public:
     folly::Future<Status> schedule() override;
 
 private:
+    friend class SchedulerTest;
+
+    /**
+     * The dependencies of a (sub)plan found by the bread first search.
+     *  executors: in the order of search, the root is the first one.
+     *  depends: the indices of the dependencies of each executor.
+     *  numPromises: the number of the executors waiting for each executor, plus one for
+     *               the caller waiting for the root.
+     *  inlined: whether each executor is chained to its dependency.
+     */
+    struct ScheduleGraph {
+        std::vector<Executor*>              executors;
+        std::vector<std::vector<size_t>>    depends;
+        std::vector<size_t>                 numPromises;
+        std::vector<bool>                   inlined;
+    };
+
+    // Build the schedule graphs of the plan rooted by `root' and the bodies in it
+    void compile(Executor* root);
+
     folly::Future<Status> doSchedule(Executor* root) const;
 
     /**
@@ -71,6 +96,12 @@ private:
     folly::Future<Status> execute(Executor *executor) const;
 
     QueryContext *qctx_{nullptr};
+
+    // Read only once the plan is compiled
+    std::unordered_map<const Executor*, std::unique_ptr<ScheduleGraph>> graphs_;
+
+    // Run the chained executors inline within the time slice, or by the thread pool
+    std::unique_ptr<folly::Executor> chainRunner_;
 };
 }  // namespace graph
 }  // namespace nebula
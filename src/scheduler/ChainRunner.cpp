@@ -0,0 +1,46 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "scheduler/ChainRunner.h"
+
+#include <folly/ScopeGuard.h>
+
+#include "common/base/Logging.h"
+#include "common/time/WallClock.h"
+#include "service/GraphFlags.h"
+
+namespace nebula {
+namespace graph {
+
+namespace {
+
+// The chain of executors running inline on the current thread
+thread_local size_t gInlineDepth = 0;
+thread_local int64_t gInlineStartUs = 0;
+
+}   // namespace
+
+ChainRunner::ChainRunner(folly::Executor* runner) : runner_(DCHECK_NOTNULL(runner)) {}
+
+void ChainRunner::add(folly::Func func) {
+    auto now = time::WallClock::fastNowInMicroSec();
+    if (gInlineDepth == 0) {
+        gInlineStartUs = now;
+    }
+    if (gInlineDepth >= kMaxInlineDepth ||
+        now - gInlineStartUs >= FLAGS_inline_executor_time_slice_us) {
+        runner_->add(std::move(func));
+        return;
+    }
+    ++gInlineDepth;
+    SCOPE_EXIT {
+        --gInlineDepth;
+    };
+    func();
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,37 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef SCHEDULER_CHAINRUNNER_H_
+#define SCHEDULER_CHAINRUNNER_H_
+
+#include <folly/Executor.h>
+
+namespace nebula {
+namespace graph {
+
+/**
+ * Run the task right away on the calling thread, i.e. the one finishing the dependency, so the
+ * cheap executors of a chain run back to back without the hops to the thread pool. The task is
+ * dispatched to the thread pool once the chain has run longer than the time slice, or has
+ * nested deeper than kMaxInlineDepth on the stack.
+ */
+class ChainRunner final : public folly::Executor {
+public:
+    // Bound the depth of stack the chain of inline executors takes
+    static constexpr size_t kMaxInlineDepth = 64;
+
+    explicit ChainRunner(folly::Executor* runner);
+
+    void add(folly::Func func) override;
+
+private:
+    folly::Executor* runner_{nullptr};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // SCHEDULER_CHAINRUNNER_H_
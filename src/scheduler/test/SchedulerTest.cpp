@@ -0,0 +1,220 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+
+#include "common/expression/VariableExpression.h"
+#include "context/QueryContext.h"
+#include "planner/plan/Logic.h"
+#include "planner/plan/Query.h"
+#include "scheduler/AsyncMsgNotifyBasedScheduler.h"
+#include "scheduler/ChainRunner.h"
+#include "service/GraphFlags.h"
+
+DECLARE_bool(enable_lifetime_optimize);
+
+namespace nebula {
+namespace graph {
+
+class SchedulerTest : public testing::Test {
+protected:
+    void SetUp() override {
+        // This need the analysis of validator, so disable it when only test scheduler itself.
+        FLAGS_enable_lifetime_optimize = false;
+        FLAGS_inline_executor_time_slice_us = 500;
+        pool_ = std::make_unique<folly::CPUThreadPoolExecutor>(2);
+        qctx_ = newQueryContext();
+    }
+
+    std::unique_ptr<QueryContext> newQueryContext() const {
+        auto rctx = std::make_unique<RequestContext<ExecutionResponse>>();
+        rctx->setRunner(pool_.get());
+        auto qctx = std::make_unique<QueryContext>();
+        qctx->setRCtx(std::move(rctx));
+        return qctx;
+    }
+
+    // Run `body' five times by ++counter{0} <= 5
+    static Loop* makeLoop(QueryContext* qctx, PlanNode* body) {
+        auto* pool = qctx->objPool();
+        std::string counter = "counter";
+        qctx->ectx()->setValue(counter, 0);
+        auto condition = RelationalExpression::makeLE(
+            pool,
+            UnaryExpression::makeIncr(
+                pool,
+                VersionedVariableExpression::make(
+                    pool, counter, ConstantExpression::make(pool, 0))),
+            ConstantExpression::make(pool, static_cast<int32_t>(5)));
+        return Loop::make(qctx, StartNode::make(qctx), body, condition);
+    }
+
+    static void compile(AsyncMsgNotifyBasedScheduler& scheduler, Executor* root) {
+        scheduler.compile(root);
+    }
+
+    static size_t numGraphs(const AsyncMsgNotifyBasedScheduler& scheduler) {
+        return scheduler.graphs_.size();
+    }
+
+    static const AsyncMsgNotifyBasedScheduler::ScheduleGraph& graphOf(
+        const AsyncMsgNotifyBasedScheduler& scheduler,
+        const Executor* root) {
+        return *scheduler.graphs_.at(root);
+    }
+
+protected:
+    // Restore the flags changed by each test
+    gflags::FlagSaver                               flagSaver_;
+    std::unique_ptr<folly::CPUThreadPoolExecutor>   pool_;
+    std::unique_ptr<QueryContext>                   qctx_;
+};
+
+TEST_F(SchedulerTest, CompileNestedBodies) {
+    auto* qctx = qctx_.get();
+    auto* thenBody = PassThroughNode::make(qctx, StartNode::make(qctx));
+    auto* elseBody = StartNode::make(qctx);
+    auto* select = Select::make(qctx,
+                                StartNode::make(qctx),
+                                thenBody,
+                                elseBody,
+                                ConstantExpression::make(qctx->objPool(), true));
+    auto* loop = makeLoop(qctx, select);
+    auto* root = PassThroughNode::make(qctx, loop);
+    auto* exe = Executor::create(root, qctx);
+
+    AsyncMsgNotifyBasedScheduler scheduler(qctx);
+    compile(scheduler, exe);
+    // The plan, the body of loop and both branches of select
+    EXPECT_EQ(numGraphs(scheduler), 4);
+
+    // In the order of search: the pass through, the loop and its input
+    auto& graph = graphOf(scheduler, exe);
+    ASSERT_EQ(graph.executors.size(), 3);
+    EXPECT_EQ(graph.executors[1]->node()->kind(), PlanNode::Kind::kLoop);
+    EXPECT_EQ(graph.depends, std::vector<std::vector<size_t>>({{1}, {2}, {}}));
+    EXPECT_EQ(graph.numPromises, std::vector<size_t>({1, 1, 1}));
+    EXPECT_EQ(graph.inlined, std::vector<bool>({true, false, false}));
+
+    auto* loopExe = static_cast<LoopExecutor*>(graph.executors[1]);
+    auto& loopBody = graphOf(scheduler, loopExe->loopBody());
+    ASSERT_EQ(loopBody.executors.size(), 2);
+    EXPECT_EQ(loopBody.executors[0]->node()->kind(), PlanNode::Kind::kSelect);
+    EXPECT_EQ(loopBody.inlined, std::vector<bool>({false, false}));
+
+    auto* selectExe = static_cast<SelectExecutor*>(loopBody.executors[0]);
+    auto& thenGraph = graphOf(scheduler, selectExe->thenBody());
+    EXPECT_EQ(thenGraph.executors.size(), 2);
+    EXPECT_EQ(thenGraph.inlined, std::vector<bool>({true, false}));
+    auto& elseGraph = graphOf(scheduler, selectExe->elseBody());
+    EXPECT_EQ(elseGraph.executors.size(), 1);
+
+    // Compiled only once
+    compile(scheduler, exe);
+    EXPECT_EQ(numGraphs(scheduler), 4);
+    EXPECT_EQ(&graphOf(scheduler, exe), &graph);
+}
+
+TEST_F(SchedulerTest, NotInlineFanOut) {
+    auto* qctx = qctx_.get();
+    auto* start = StartNode::make(qctx);
+    auto* left = PassThroughNode::make(qctx, start);
+    auto* right = PassThroughNode::make(qctx, start);
+    auto* root = PassThroughNode::make(qctx, Union::make(qctx, left, right));
+    auto* exe = Executor::create(root, qctx);
+
+    {
+        AsyncMsgNotifyBasedScheduler scheduler(qctx);
+        compile(scheduler, exe);
+        auto& graph = graphOf(scheduler, exe);
+        ASSERT_EQ(graph.executors.size(), 5);
+        // Both sides wait for the start
+        EXPECT_EQ(graph.numPromises.back(), 2);
+        // Only the pass through on the union is chained, the union has two dependencies and
+        // the start has two successors
+        EXPECT_EQ(graph.inlined, std::vector<bool>({true, false, false, false, false}));
+    }
+    {
+        FLAGS_inline_executor_time_slice_us = 0;
+        AsyncMsgNotifyBasedScheduler scheduler(qctx);
+        compile(scheduler, exe);
+        auto& graph = graphOf(scheduler, exe);
+        EXPECT_EQ(graph.inlined, std::vector<bool>(5, false));
+    }
+}
+
+TEST_F(SchedulerTest, RearmLoopBody) {
+    for (auto timeSlice : {0, 500}) {
+        FLAGS_inline_executor_time_slice_us = timeSlice;
+        auto qctx = newQueryContext();
+        auto* bodyStart = StartNode::make(qctx.get());
+        auto* body = PassThroughNode::make(qctx.get(), bodyStart);
+        auto* loop = makeLoop(qctx.get(), body);
+        qctx->plan()->setRoot(PassThroughNode::make(qctx.get(), loop));
+
+        AsyncMsgNotifyBasedScheduler scheduler(qctx.get());
+        auto status = scheduler.schedule().get();
+        ASSERT_TRUE(status.ok()) << status;
+        EXPECT_EQ(numGraphs(scheduler), 2);
+        // The notifiers of body are created again in each iteration
+        EXPECT_EQ(qctx->ectx()->numVersions(bodyStart->outputVar()), 5);
+        EXPECT_EQ(qctx->ectx()->numVersions(body->outputVar()), 5);
+    }
+}
+
+TEST_F(SchedulerTest, RunChainInline) {
+    folly::ManualExecutor pool;
+    ChainRunner runner(&pool);
+    auto caller = std::this_thread::get_id();
+    std::thread::id callee;
+    runner.add([&callee] { callee = std::this_thread::get_id(); });
+    EXPECT_EQ(callee, caller);
+    EXPECT_EQ(pool.run(), 0);
+}
+
+TEST_F(SchedulerTest, RunChainByPoolBeyondDepth) {
+    FLAGS_inline_executor_time_slice_us = std::numeric_limits<uint32_t>::max();
+    folly::ManualExecutor pool;
+    ChainRunner runner(&pool);
+    size_t ran = 0;
+    std::function<void()> next = [&] {
+        if (++ran < 100) {
+            runner.add(next);
+        }
+    };
+    runner.add(next);
+    EXPECT_EQ(ran, ChainRunner::kMaxInlineDepth);
+    // Continued on a fresh stack of the pool
+    EXPECT_EQ(pool.run(), 1);
+    EXPECT_EQ(ran, 100);
+    EXPECT_EQ(pool.run(), 0);
+}
+
+TEST_F(SchedulerTest, RunChainByPoolBeyondTimeSlice) {
+    FLAGS_inline_executor_time_slice_us = 1000;
+    folly::ManualExecutor pool;
+    ChainRunner runner(&pool);
+    size_t ran = 0;
+    std::function<void()> next = [&] {
+        if (++ran < 4) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            runner.add(next);
+        }
+    };
+    runner.add(next);
+    EXPECT_EQ(ran, 1);
+    // Each task from the pool starts a new time slice
+    EXPECT_EQ(pool.run(), 1);
+    EXPECT_EQ(ran, 3);
+    EXPECT_EQ(pool.run(), 1);
+    EXPECT_EQ(ran, 4);
+    EXPECT_EQ(pool.run(), 0);
+}
+
+}   // namespace graph
+}   // namespace nebula
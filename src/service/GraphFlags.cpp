@@ -61,3 +61,95 @@ DEFINE_double(system_memory_high_watermark_ratio, 0.8, "high watermark ratio of
 
 DEFINE_bool(disable_octal_escape_char, false, "Octal escape character will be disabled"
                                          " in next version to ensure compatibility with cypher.");
+
+DEFINE_bool(enable_plan_cache, false, "Whether to cache the execution plans of read-only queries");
+DEFINE_uint32(plan_cache_capacity, 1024, "Max number of plan instances kept in plan cache");
+DEFINE_uint32(plan_cache_instances_per_query,
+              8,
+              "Max number of idle plan instances kept for the same query");
+DEFINE_int64(plan_cache_ttl_secs,
+             10,
+             "Seconds before a cached plan expires, 0 for never expire");
+
+DEFINE_uint32(max_query_parallelism,
+              1,
+              "Max number of worker threads processing the morsels of one query at the same "
+              "time, 1 disables the intra-operator parallelism");
+DEFINE_uint32(morsel_size, 4096, "Number of input rows in one morsel of parallel executors");
+DEFINE_uint32(join_partition_size,
+              2048,
+              "Expected number of build rows in one partition of the parallel hash join, "
+              "the hash table of a partition is supposed to fit in CPU cache");
+
+DEFINE_bool(enable_pipeline_execution,
+            false,
+            "Whether to fuse the chains of row-at-a-time executors into pipelines");
+DEFINE_uint32(pipeline_batch_size, 1024, "Max number of rows exchanged between pipeline stages");
+DEFINE_bool(enable_batch_eval,
+            false,
+            "Whether to evaluate the expressions of Filter and Project in batch");
+DEFINE_uint32(batch_eval_size, 1024, "Number of rows evaluated in one batch");
+DEFINE_bool(enable_expr_compile,
+            true,
+            "Whether to compile the expressions of Filter, Project, Aggregate and Join");
+
+DEFINE_int64(query_spill_memory_bytes,
+             0,
+             "Memory budget in bytes of each hash join or sort of a query, the inputs are "
+             "spilled to temporary files once exceeding it, 0 disables spilling. A sort is "
+             "spilled only if its output is read up to a limit");
+DEFINE_string(spill_tmp_dir, "/tmp", "Directory to put the temporary files of spilled rows");
+
+DEFINE_string(vertex_cache_spaces,
+              "",
+              "Comma separated names of the spaces whose vertex properties are cached in graphd, "
+              "empty disables the cache");
+DEFINE_uint32(vertex_cache_capacity, 100000, "Max number of vertices in the vertex cache");
+DEFINE_int64(vertex_cache_ttl_secs,
+             60,
+             "Seconds before a cached vertex expires, the changes made through the other graphds "
+             "are seen after it");
+
+DEFINE_string(neighbor_cache_spaces,
+              "",
+              "Comma separated names of the spaces whose neighbors of vertices, i.e. the results "
+              "of getNeighbors, are cached in graphd, empty disables the cache");
+DEFINE_int64(neighbor_cache_capacity_bytes,
+             256 * 1024 * 1024,
+             "Max rough bytes of the neighbors in the neighbor cache");
+DEFINE_int64(neighbor_cache_ttl_secs,
+             60,
+             "Seconds before the cached neighbors of a vertex expire, the edges changed through "
+             "the other graphds are seen after it");
+
+DEFINE_uint32(storage_coalesce_window_ms,
+              0,
+              "Window in milliseconds to batch the compatible getNeighbors and getProps "
+              "requests of concurrent queries into one, 0 disables coalescing");
+
+DEFINE_bool(stream_storage_responses,
+            false,
+            "Whether to send the getNeighbors and getProps requests of vertices by partitions and "
+            "handle each response as it arrives, instead of waiting for all hosts");
+
+DEFINE_uint32(storage_request_chunk_size,
+              0,
+              "Max number of vids of a partition in one getNeighbors or getProps request, the "
+              "larger sets of vids are split into chunks, 0 disables splitting");
+
+DEFINE_uint32(storage_request_concurrency,
+              16,
+              "Max number of the split storage requests of an executor in flight, 0 for no limit");
+
+DEFINE_uint32(inline_executor_time_slice_us,
+              500,
+              "Time slice in microseconds to run a linear chain of executors inline on the "
+              "thread finishing the first one, 0 dispatches every executor to the thread pool");
+
+DEFINE_int64(query_memory_quota_bytes,
+             0,
+             "Max bytes of the results held by one query, the query fails once exceeding it, "
+             "0 for unlimited");
+DEFINE_uint32(system_memory_sample_interval_ms,
+              100,
+              "Interval in milliseconds to sample the system memory for the high watermark");
@@ -42,6 +42,47 @@ DECLARE_double(system_memory_high_watermark_ratio);
 // optimizer
 DECLARE_bool(enable_optimizer);
 
+// plan cache
+DECLARE_bool(enable_plan_cache);
+DECLARE_uint32(plan_cache_capacity);
+DECLARE_uint32(plan_cache_instances_per_query);
+DECLARE_int64(plan_cache_ttl_secs);
+
+// intra-operator parallelism
+DECLARE_uint32(max_query_parallelism);
+DECLARE_uint32(morsel_size);
+DECLARE_uint32(join_partition_size);
+
+// vectorized execution
+DECLARE_bool(enable_pipeline_execution);
+DECLARE_uint32(pipeline_batch_size);
+DECLARE_bool(enable_batch_eval);
+DECLARE_uint32(batch_eval_size);
+DECLARE_bool(enable_expr_compile);
+
+// spill to disk
+DECLARE_int64(query_spill_memory_bytes);
+DECLARE_string(spill_tmp_dir);
+
+// vertex cache
+DECLARE_string(vertex_cache_spaces);
+DECLARE_uint32(vertex_cache_capacity);
+DECLARE_int64(vertex_cache_ttl_secs);
+DECLARE_string(neighbor_cache_spaces);
+DECLARE_int64(neighbor_cache_capacity_bytes);
+DECLARE_int64(neighbor_cache_ttl_secs);
+
+// scheduling
+DECLARE_uint32(storage_coalesce_window_ms);
+DECLARE_bool(stream_storage_responses);
+DECLARE_uint32(storage_request_chunk_size);
+DECLARE_uint32(storage_request_concurrency);
+DECLARE_uint32(inline_executor_time_slice_us);
+
+// memory tracking
+DECLARE_int64(query_memory_quota_bytes);
+DECLARE_uint32(system_memory_sample_interval_ms);
+
 DECLARE_int64(max_allowed_connections);
 
 DECLARE_string(local_ip);
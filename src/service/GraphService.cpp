@@ -15,6 +15,7 @@
 #include "service/PasswordAuthenticator.h"
 #include "service/CloudAuthenticator.h"
 #include "stats/StatsDef.h"
+#include "util/MemoryTracker.h"
 #include "common/time/TimezoneInfo.h"
 
 namespace nebula {
@@ -52,6 +53,7 @@ Status GraphService::init(std::shared_ptr<folly::IOThreadPoolExecutor> ioExecuto
         LOG(WARNING) << "Init sessin manager failed: " << initSessionMgrStatus.toString();
     }
     queryEngine_ = std::make_unique<QueryEngine>();
+    MemoryTracker::startSystemMemoryRefresher(FLAGS_system_memory_sample_interval_ms);
 
     myAddr_ = hostAddr;
     return queryEngine_->init(std::move(ioExecutor), metaClient_.get());
@@ -122,8 +124,17 @@ void GraphService::signout(int64_t sessionId) {
 
 folly::Future<ExecutionResponse>
 GraphService::future_execute(int64_t sessionId, const std::string& query) {
+    return future_executeWithParameter(sessionId, query, {});
+}
+
+
+folly::Future<ExecutionResponse> GraphService::future_executeWithParameter(
+    int64_t sessionId,
+    const std::string& query,
+    const std::unordered_map<std::string, Value>& parameterMap) {
     auto ctx = std::make_unique<RequestContext<ExecutionResponse>>();
     ctx->setQuery(query);
+    ctx->setParameterMap(parameterMap);
     ctx->setRunner(getThreadManager());
     ctx->setSessionMgr(sessionManager_.get());
     auto future = ctx->future();
@@ -37,6 +37,14 @@ public:
     folly::Future<ExecutionResponse>
     future_execute(int64_t sessionId, const std::string& stmt) override;
 
+    // The literals are bound as parameters, e.g. the vids of `GO FROM $vids', so the same
+    // statement text is prepared once into the plan cache and reused by the later calls
+    folly::Future<ExecutionResponse>
+    future_executeWithParameter(
+        int64_t sessionId,
+        const std::string& stmt,
+        const std::unordered_map<std::string, Value>& parameterMap) override;
+
 private:
     bool auth(const std::string& username, const std::string& password);
 
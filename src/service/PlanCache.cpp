@@ -0,0 +1,296 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "service/PlanCache.h"
+
+#include <folly/hash/Hash.h>
+
+#include "common/time/WallClock.h"
+#include "parser/SequentialSentences.h"
+#include "parser/TraverseSentences.h"
+#include "planner/plan/ExecutionPlan.h"
+#include "service/PermissionCheck.h"
+#include "stats/StatsDef.h"
+
+namespace nebula {
+namespace graph {
+
+size_t PlanCacheKeyHash::operator()(const PlanCacheKey& key) const {
+    auto hash = std::hash<std::string>()(key.stmt);
+    hash = folly::hash::hash_combine(hash, key.space, key.schemaVersion);
+    return folly::hash::hash_combine(hash, std::hash<std::string>()(key.user));
+}
+
+CachedPlan::CachedPlan(std::unique_ptr<QueryContext> qctx,
+                       std::unique_ptr<Sentence> sentence,
+                       std::unique_ptr<ExecutionContext> plannedEctx)
+    : qctx_(std::move(qctx)),
+      sentence_(std::move(sentence)),
+      plannedEctx_(std::move(plannedEctx)),
+      createdInSec_(time::WallClock::fastNowInSec()) {
+    DCHECK(qctx_ != nullptr);
+    DCHECK(plannedEctx_ != nullptr);
+    qctx_->releaseRuntime();
+}
+
+PlanNode* CachedPlan::root() const {
+    return qctx_->plan()->root();
+}
+
+void CachedPlan::instantiate(QueryContext* qctx) const {
+    plannedEctx_->deepCopyTo(qctx->ectx());
+    qctx->plan()->setRoot(root());
+}
+
+Status CachedPlan::checkPermission(QueryContext* qctx) const {
+    auto* session = qctx->rctx()->session();
+    auto space = session->space();
+    if (space.id > kInvalidSpaceID) {
+        qctx->vctx()->switchToSpace(space);
+    }
+    // Each sentence is checked the same way as its validator does
+    std::vector<Sentence*> stack = {sentence_.get()};
+    while (!stack.empty()) {
+        auto* current = stack.back();
+        stack.pop_back();
+        NG_RETURN_IF_ERROR(
+            PermissionCheck::permissionCheck(session, current, qctx->vctx(), space.id));
+        switch (current->kind()) {
+            case Sentence::Kind::kSequential: {
+                auto seq = static_cast<SequentialSentences*>(current);
+                for (auto* s : seq->sentences()) {
+                    stack.emplace_back(s);
+                }
+                break;
+            }
+            case Sentence::Kind::kPipe: {
+                auto pipe = static_cast<PipedSentence*>(current);
+                stack.emplace_back(pipe->left());
+                stack.emplace_back(pipe->right());
+                break;
+            }
+            case Sentence::Kind::kSet: {
+                auto set = static_cast<SetSentence*>(current);
+                stack.emplace_back(set->left());
+                stack.emplace_back(set->right());
+                break;
+            }
+            case Sentence::Kind::kAssignment: {
+                auto assign = static_cast<AssignmentSentence*>(current);
+                stack.emplace_back(assign->sentence());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return Status::OK();
+}
+
+PlanCache::PlanCache(size_t capacity, int64_t ttlInSec, size_t maxInstancesPerKey)
+    : capacity_(capacity), ttlInSec_(ttlInSec), maxInstancesPerKey_(maxInstancesPerKey) {}
+
+PlanCacheKey PlanCache::makeKey(const std::string& query,
+                                GraphSpaceID space,
+                                std::string user,
+                                int64_t schemaVersion) const {
+    PlanCacheKey key;
+    key.stmt = normalize(query);
+    key.space = space;
+    key.user = std::move(user);
+    key.schemaVersion = schemaVersion;
+    return key;
+}
+
+std::unique_ptr<CachedPlan> PlanCache::acquire(const PlanCacheKey& key) {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto found = index_.find(key);
+    if (found == index_.end() || found->second->second.empty()) {
+        stats::StatsManager::addValue(kNumPlanCacheMisses);
+        return nullptr;
+    }
+    auto& instances = found->second->second;
+    auto plan = std::move(instances.back());
+    instances.pop_back();
+    --numInstances_;
+    if (instances.empty()) {
+        // Put back by `release' when done
+        lru_.erase(found->second);
+        index_.erase(found);
+    } else {
+        lru_.splice(lru_.begin(), lru_, found->second);
+    }
+    if (ttlInSec_ > 0 && time::WallClock::fastNowInSec() - plan->createdInSec() > ttlInSec_) {
+        stats::StatsManager::addValue(kNumPlanCacheEvictions);
+        stats::StatsManager::addValue(kNumPlanCacheMisses);
+        return nullptr;
+    }
+    stats::StatsManager::addValue(kNumPlanCacheHits);
+    return plan;
+}
+
+void PlanCache::release(const PlanCacheKey& key, std::unique_ptr<CachedPlan> plan) {
+    DCHECK(plan != nullptr);
+    std::lock_guard<std::mutex> guard(lock_);
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+        lru_.emplace_front(key, Instances());
+        found = index_.emplace(key, lru_.begin()).first;
+    } else {
+        lru_.splice(lru_.begin(), lru_, found->second);
+    }
+    auto& instances = found->second->second;
+    if (instances.size() >= maxInstancesPerKey_) {
+        return;
+    }
+    instances.emplace_back(std::move(plan));
+    ++numInstances_;
+    evictIfNeeded();
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return numInstances_;
+}
+
+void PlanCache::evictIfNeeded() {
+    while (numInstances_ > capacity_ && !lru_.empty()) {
+        auto& last = lru_.back();
+        numInstances_ -= last.second.size();
+        stats::StatsManager::addValue(kNumPlanCacheEvictions, last.second.size());
+        index_.erase(last.first);
+        lru_.pop_back();
+    }
+}
+
+// static
+std::string PlanCache::normalize(const std::string& query) {
+    std::string normalized;
+    normalized.reserve(query.size());
+    char quote = '\0';
+    bool escaped = false;
+    bool pendingSpace = false;
+    for (auto c : query) {
+        if (quote != '\0') {
+            normalized.push_back(c);
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == quote) {
+                quote = '\0';
+            }
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized.push_back(' ');
+            pendingSpace = false;
+        }
+        if (c == '"' || c == '\'' || c == '`') {
+            quote = c;
+        }
+        normalized.push_back(c);
+    }
+    while (!normalized.empty() && (normalized.back() == ';' || normalized.back() == ' ')) {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+// static
+bool PlanCache::isCacheable(const Sentence* sentence, const QueryContext* qctx) {
+    // The results of these functions are folded or baked into the plan
+    if (qctx->isNonDeterministic()) {
+        return false;
+    }
+
+    std::vector<const Sentence*> stack = {sentence};
+    while (!stack.empty()) {
+        auto* current = stack.back();
+        stack.pop_back();
+        switch (current->kind()) {
+            case Sentence::Kind::kSequential: {
+                auto seq = static_cast<const SequentialSentences*>(current);
+                for (auto* s : seq->sentences()) {
+                    stack.emplace_back(s);
+                }
+                break;
+            }
+            case Sentence::Kind::kPipe: {
+                auto pipe = static_cast<const PipedSentence*>(current);
+                stack.emplace_back(pipe->left());
+                stack.emplace_back(pipe->right());
+                break;
+            }
+            case Sentence::Kind::kSet: {
+                auto set = static_cast<SetSentence*>(const_cast<Sentence*>(current));
+                stack.emplace_back(set->left());
+                stack.emplace_back(set->right());
+                break;
+            }
+            case Sentence::Kind::kAssignment: {
+                auto assign = static_cast<const AssignmentSentence*>(current);
+                stack.emplace_back(assign->sentence());
+                break;
+            }
+            case Sentence::Kind::kGo:
+            case Sentence::Kind::kMatch:
+            case Sentence::Kind::kLookup:
+            case Sentence::Kind::kYield:
+            case Sentence::Kind::kOrderBy:
+            case Sentence::Kind::kLimit:
+            case Sentence::Kind::kGroupBy:
+            case Sentence::Kind::kFetchVertices:
+            case Sentence::Kind::kFetchEdges:
+            case Sentence::Kind::kFindPath:
+            case Sentence::Kind::kGetSubgraph:
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// static
+StatusOr<int64_t> PlanCache::schemaVersion(const QueryContext* qctx, GraphSpaceID space) {
+    if (space <= kInvalidSpaceID) {
+        return 0;
+    }
+    auto tags = qctx->schemaMng()->getAllLatestVerTagSchema(space);
+    NG_RETURN_IF_ERROR(tags);
+    auto edges = qctx->schemaMng()->getAllLatestVerEdgeSchema(space);
+    NG_RETURN_IF_ERROR(edges);
+    auto tagIndexes = qctx->indexMng()->getTagIndexes(space);
+    NG_RETURN_IF_ERROR(tagIndexes);
+    auto edgeIndexes = qctx->indexMng()->getEdgeIndexes(space);
+    NG_RETURN_IF_ERROR(edgeIndexes);
+
+    // Summed up regardless of the order. A schema altered gets a new version, and the one
+    // dropped and created again gets a new id.
+    enum Kind : int8_t { kTag, kEdge, kTagIndex, kEdgeIndex };
+    uint64_t version = 0;
+    for (auto& tag : tags.value()) {
+        version += folly::hash::hash_combine(kTag, tag.first, tag.second->getVersion());
+    }
+    for (auto& edge : edges.value()) {
+        version += folly::hash::hash_combine(kEdge, edge.first, edge.second->getVersion());
+    }
+    for (auto& index : tagIndexes.value()) {
+        version += folly::hash::hash_combine(kTagIndex, index->get_index_id());
+    }
+    for (auto& index : edgeIndexes.value()) {
+        version += folly::hash::hash_combine(kEdgeIndex, index->get_index_id());
+    }
+    return static_cast<int64_t>(version);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,140 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef SERVICE_PLANCACHE_H_
+#define SERVICE_PLANCACHE_H_
+
+#include <list>
+#include <mutex>
+
+#include "common/base/Base.h"
+#include "common/cpp/helpers.h"
+#include "common/thrift/ThriftTypes.h"
+#include "context/QueryContext.h"
+#include "parser/Sentence.h"
+
+namespace nebula {
+namespace graph {
+
+class PlanNode;
+
+struct PlanCacheKey {
+    // The normalized query text
+    std::string             stmt;
+    GraphSpaceID            space{-1};
+    std::string             user;
+    // The version of the schemas and indexes of the space reported by the SchemaManager,
+    // which changes once the schema is altered by any graph daemon
+    int64_t                 schemaVersion{0};
+
+    bool operator==(const PlanCacheKey& rhs) const {
+        return space == rhs.space && schemaVersion == rhs.schemaVersion && stmt == rhs.stmt &&
+               user == rhs.user;
+    }
+};
+
+struct PlanCacheKeyHash {
+    size_t operator()(const PlanCacheKey& key) const;
+};
+
+/**
+ * A parsed, validated and optimized execution plan. It owns the query context which the
+ * plan was built in, since plan nodes, expressions and symbols are all allocated in it.
+ * Only the planning artifacts are kept, the runtime state is dropped before caching.
+ * The variables initialized when planning, e.g. the constant start vids and the loop
+ * counters, are kept aside and copied into each query which reuses the plan.
+ *
+ * Expressions cache their evaluation results internally, so one instance could only be
+ * used by one query at a time. The cache hands out an instance exclusively and takes it
+ * back when the query is done.
+ */
+class CachedPlan final : public cpp::NonCopyable, public cpp::NonMovable {
+public:
+    CachedPlan(std::unique_ptr<QueryContext> qctx,
+               std::unique_ptr<Sentence> sentence,
+               std::unique_ptr<ExecutionContext> plannedEctx);
+
+    PlanNode* root() const;
+
+    // Make the plan ready to be executed by the query
+    void instantiate(QueryContext* qctx) const;
+
+    // The context the plan was built in, which keeps the symbols of plan
+    const QueryContext* plannedQctx() const {
+        return qctx_.get();
+    }
+
+    int64_t createdInSec() const {
+        return createdInSec_;
+    }
+
+    // Check the permission of the user of query again, the roles may have been changed
+    // since the plan was validated
+    Status checkPermission(QueryContext* qctx) const;
+
+private:
+    std::unique_ptr<QueryContext>               qctx_;
+    std::unique_ptr<Sentence>                   sentence_;
+    std::unique_ptr<ExecutionContext>           plannedEctx_;
+    int64_t                                     createdInSec_{0};
+};
+
+/**
+ * PlanCache is a per-graphd LRU cache of execution plans keyed by the normalized query
+ * text, the space, the user and the schema version of the space. The plans built on a stale
+ * schema are never hit again and evicted as the least recently used.
+ * Each key keeps a pool of idle plan instances, a query checks out one instance by `acquire'
+ * and gives it back by `release' when finished.
+ */
+class PlanCache final : public cpp::NonCopyable, public cpp::NonMovable {
+public:
+    PlanCache(size_t capacity, int64_t ttlInSec, size_t maxInstancesPerKey);
+
+    PlanCacheKey makeKey(const std::string& query,
+                         GraphSpaceID space,
+                         std::string user,
+                         int64_t schemaVersion) const;
+
+    // Return nullptr if there is no idle instance for the key
+    std::unique_ptr<CachedPlan> acquire(const PlanCacheKey& key);
+
+    // Return an instance to cache
+    void release(const PlanCacheKey& key, std::unique_ptr<CachedPlan> plan);
+
+    size_t size() const;
+
+    // Collapse the whitespaces which are not quoted and trim the tailing semicolons
+    static std::string normalize(const std::string& query);
+
+    // Only the read-only queries, whose plans don't depend on the time of planning,
+    // could be cached
+    static bool isCacheable(const Sentence* sentence, const QueryContext* qctx);
+
+    // Digest the versions of all tags, edges and indexes of the space from the schema
+    // and index managers, which are synchronized with meta service
+    static StatusOr<int64_t> schemaVersion(const QueryContext* qctx, GraphSpaceID space);
+
+private:
+    using Instances = std::vector<std::unique_ptr<CachedPlan>>;
+    using LruList = std::list<std::pair<PlanCacheKey, Instances>>;
+
+    void evictIfNeeded();
+
+    const size_t                                                capacity_;
+    const int64_t                                               ttlInSec_;
+    const size_t                                                maxInstancesPerKey_;
+
+    mutable std::mutex                                          lock_;
+    // Most recently used at front
+    LruList                                                     lru_;
+    std::unordered_map<PlanCacheKey, LruList::iterator, PlanCacheKeyHash> index_;
+    size_t                                                      numInstances_{0};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // SERVICE_PLANCACHE_H_
@@ -23,12 +23,39 @@ DECLARE_string(meta_server_addrs);
 namespace nebula {
 namespace graph {
 
+// Names of spaces separated by comma
+static std::unordered_set<std::string> splitSpaces(const std::string& flag) {
+    std::vector<folly::StringPiece> names;
+    folly::split(",", flag, names, true);
+    std::unordered_set<std::string> spaces;
+    for (auto& name : names) {
+        spaces.emplace(folly::trimWhitespace(name).str());
+    }
+    return spaces;
+}
+
 Status QueryEngine::init(std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor,
                          meta::MetaClient* metaClient) {
     metaClient_ = metaClient;
     schemaManager_ = meta::ServerBasedSchemaManager::create(metaClient_);
     indexManager_ = meta::ServerBasedIndexManager::create(metaClient_);
     storage_ = std::make_unique<storage::GraphStorageClient>(ioExecutor, metaClient_);
+    if (FLAGS_storage_coalesce_window_ms > 0) {
+        storageCoalescer_ = std::make_unique<StorageCoalescer>(
+            storage_.get(), metaClient_, ioExecutor, FLAGS_storage_coalesce_window_ms);
+    }
+    if (!FLAGS_vertex_cache_spaces.empty()) {
+        vertexCache_ = std::make_unique<VertexCache>(FLAGS_vertex_cache_capacity,
+                                                     0,
+                                                     FLAGS_vertex_cache_ttl_secs,
+                                                     splitSpaces(FLAGS_vertex_cache_spaces));
+    }
+    if (!FLAGS_neighbor_cache_spaces.empty()) {
+        neighborCache_ = std::make_unique<VertexCache>(0,
+                                                       FLAGS_neighbor_cache_capacity_bytes,
+                                                       FLAGS_neighbor_cache_ttl_secs,
+                                                       splitSpaces(FLAGS_neighbor_cache_spaces));
+    }
     charsetInfo_ = CharsetInfo::instance();
 
     PlannersRegister::registPlanners();
@@ -39,6 +66,12 @@ Status QueryEngine::init(std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor
     }
     optimizer_ = std::make_unique<opt::Optimizer>(rulesets);
 
+    if (FLAGS_enable_plan_cache) {
+        planCache_ = std::make_unique<PlanCache>(FLAGS_plan_cache_capacity,
+                                                 FLAGS_plan_cache_ttl_secs,
+                                                 FLAGS_plan_cache_instances_per_query);
+    }
+
     return Status::OK();
 }
 
@@ -49,7 +82,10 @@ void QueryEngine::execute(RequestContextPtr rctx) {
                                                storage_.get(),
                                                metaClient_,
                                                charsetInfo_);
-    auto* instance = new QueryInstance(std::move(ectx), optimizer_.get());
+    ectx->setStorageCoalescer(storageCoalescer_.get());
+    ectx->setVertexCache(vertexCache_.get());
+    ectx->setNeighborCache(neighborCache_.get());
+    auto* instance = new QueryInstance(std::move(ectx), optimizer_.get(), planCache_.get());
     instance->execute();
 }
 
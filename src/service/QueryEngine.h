@@ -16,13 +16,16 @@
 #include "common/clients/storage/GraphStorageClient.h"
 #include "common/network/NetworkUtils.h"
 #include "common/charset/Charset.h"
+#include "context/StorageCoalescer.h"
+#include "context/VertexCache.h"
 #include "optimizer/Optimizer.h"
+#include "service/PlanCache.h"
 #include <folly/executors/IOThreadPoolExecutor.h>
 
 /**
  * QueryEngine is responsible to create and manage ExecutionPlan.
- * For the time being, we don't have the execution plan cache support,
- * instead we create a plan for each query, and destroy it upon finish.
+ * The plans of read-only queries could be kept in the plan cache if enabled,
+ * otherwise we create a plan for each query, and destroy it upon finish.
  */
 
 namespace nebula {
@@ -47,7 +50,11 @@ private:
     std::unique_ptr<meta::SchemaManager>              schemaManager_;
     std::unique_ptr<meta::IndexManager>               indexManager_;
     std::unique_ptr<storage::GraphStorageClient>      storage_;
+    std::unique_ptr<StorageCoalescer>                 storageCoalescer_;
+    std::unique_ptr<VertexCache>                      vertexCache_;
+    std::unique_ptr<VertexCache>                      neighborCache_;
     std::unique_ptr<opt::Optimizer>                   optimizer_;
+    std::unique_ptr<PlanCache>                        planCache_;
     meta::MetaClient                                 *metaClient_;
     CharsetInfo*                                      charsetInfo_{nullptr};
 };
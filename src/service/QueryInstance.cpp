@@ -27,9 +27,12 @@ using nebula::opt::RuleSet;
 namespace nebula {
 namespace graph {
 
-QueryInstance::QueryInstance(std::unique_ptr<QueryContext> qctx, Optimizer *optimizer) {
+QueryInstance::QueryInstance(std::unique_ptr<QueryContext> qctx,
+                             Optimizer *optimizer,
+                             PlanCache *planCache) {
     qctx_ = std::move(qctx);
     optimizer_ = DCHECK_NOTNULL(optimizer);
+    planCache_ = planCache;
     scheduler_ = std::make_unique<AsyncMsgNotifyBasedScheduler>(qctx_.get());
     qctx_->rctx()->session()->addQuery(qctx_.get());
 }
@@ -40,6 +43,12 @@ void QueryInstance::execute() {
         onError(std::move(status));
         return;
     }
+    // After planning, so that the parameters never be kept in the cached plan
+    status = bindParameters();
+    if (!status.ok()) {
+        onError(std::move(status));
+        return;
+    }
 
     if (!explainOrContinue()) {
         onFinish();
@@ -64,6 +73,11 @@ void QueryInstance::execute() {
 
 Status QueryInstance::validateAndOptimize() {
     auto *rctx = qctx()->rctx();
+    if (useCachedPlan()) {
+        VLOG(1) << "Reuse cached plan for query: " << rctx->query();
+        return cachedPlan_->checkPermission(qctx());
+    }
+
     VLOG(1) << "Parsing query: " << rctx->query();
     auto result = GQLParser(qctx()).parse(rctx->query());
     NG_RETURN_IF_ERROR(result);
@@ -72,11 +86,18 @@ Status QueryInstance::validateAndOptimize() {
     NG_RETURN_IF_ERROR(Validator::validate(sentence_.get(), qctx()));
     NG_RETURN_IF_ERROR(findBestPlan());
 
+    if (planCacheable_ && PlanCache::isCacheable(sentence_.get(), qctx())) {
+        // Keep the variables before they are changed by the execution
+        plannedEctx_ = std::make_unique<ExecutionContext>();
+        qctx_->ectx()->deepCopyTo(plannedEctx_.get());
+    }
+
     return Status::OK();
 }
 
 bool QueryInstance::explainOrContinue() {
-    if (sentence_->kind() != Sentence::Kind::kExplain) {
+    // Explain and profile sentences are never cached
+    if (cachedPlan_ != nullptr || sentence_->kind() != Sentence::Kind::kExplain) {
         return true;
     }
     auto &resp = qctx_->rctx()->resp();
@@ -99,6 +120,7 @@ void QueryInstance::onFinish() {
     rctx->finish();
 
     rctx->session()->deleteQuery(qctx_.get());
+    releasePlan(true);
     // The `QueryInstance' is the root node holding all resources during the execution.
     // When the whole query process is done, it's safe to release this object, as long as
     // no other contexts have chances to access these resources later on,
@@ -155,6 +177,7 @@ void QueryInstance::onError(Status status) {
     addSlowQueryStats(latency);
     rctx->session()->deleteQuery(qctx_.get());
     rctx->finish();
+    releasePlan(false);
     delete this;
 }
 
@@ -196,5 +219,54 @@ Status QueryInstance::findBestPlan() {
     return Status::OK();
 }
 
+Status QueryInstance::bindParameters() {
+    auto &params = qctx()->rctx()->parameterMap();
+    // The symbols of a cached plan are kept in the context it was built in
+    auto *planned = cachedPlan_ != nullptr ? cachedPlan_->plannedQctx() : qctx();
+    NG_RETURN_IF_ERROR(Validator::validateParameters(params, planned));
+    auto *ectx = qctx_->ectx();
+    for (auto &param : params) {
+        ectx->setValue(param.first, Value(param.second));
+    }
+    return Status::OK();
+}
+
+bool QueryInstance::useCachedPlan() {
+    if (planCache_ == nullptr) {
+        return false;
+    }
+    auto *rctx = qctx()->rctx();
+    auto *session = rctx->session();
+    auto space = session->space().id;
+    auto version = PlanCache::schemaVersion(qctx(), space);
+    if (!version.ok()) {
+        // E.g. the space has been dropped, left to the validator
+        return false;
+    }
+    planCacheable_ = true;
+    planCacheKey_ = planCache_->makeKey(rctx->query(), space, session->user(), version.value());
+    cachedPlan_ = planCache_->acquire(planCacheKey_);
+    if (cachedPlan_ == nullptr) {
+        return false;
+    }
+    cachedPlan_->instantiate(qctx_.get());
+    return true;
+}
+
+void QueryInstance::releasePlan(bool succeeded) {
+    if (!planCacheable_) {
+        return;
+    }
+    if (cachedPlan_ != nullptr) {
+        planCache_->release(planCacheKey_, std::move(cachedPlan_));
+        return;
+    }
+    if (succeeded && plannedEctx_ != nullptr) {
+        auto plan = std::make_unique<CachedPlan>(
+            std::move(qctx_), std::move(sentence_), std::move(plannedEctx_));
+        planCache_->release(planCacheKey_, std::move(plan));
+    }
+}
+
 }   // namespace graph
 }   // namespace nebula
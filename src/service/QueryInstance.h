@@ -13,6 +13,7 @@
 #include "optimizer/Optimizer.h"
 #include "parser/GQLParser.h"
 #include "scheduler/Scheduler.h"
+#include "service/PlanCache.h"
 
 /**
  * QueryInstance coordinates the execution process,
@@ -25,7 +26,9 @@ namespace graph {
 
 class QueryInstance final : public cpp::NonCopyable, public cpp::NonMovable {
 public:
-    explicit QueryInstance(std::unique_ptr<QueryContext> qctx, opt::Optimizer* optimizer);
+    QueryInstance(std::unique_ptr<QueryContext> qctx,
+                  opt::Optimizer* optimizer,
+                  PlanCache* planCache = nullptr);
     ~QueryInstance() = default;
 
     void execute();
@@ -54,11 +57,25 @@ private:
     void addSlowQueryStats(uint64_t latency) const;
     void fillRespData(ExecutionResponse* resp);
     Status findBestPlan();
+    // Bind the values of parameters to the variables with the same names, the ones conflicting
+    // with the variables of plan are rejected
+    Status bindParameters();
+    // Try to reuse a cached plan, return true if hit
+    bool useCachedPlan();
+    // Give the plan back to cache when the query is done
+    void releasePlan(bool succeeded);
 
     std::unique_ptr<Sentence>                   sentence_;
     std::unique_ptr<QueryContext>               qctx_;
     std::unique_ptr<Scheduler>                  scheduler_;
     opt::Optimizer*                             optimizer_{nullptr};
+    PlanCache*                                  planCache_{nullptr};
+    // Whether the key of plan cache is made
+    bool                                        planCacheable_{false};
+    PlanCacheKey                                planCacheKey_;
+    std::unique_ptr<CachedPlan>                 cachedPlan_;
+    // Variables initialized when planning, kept for caching the plan
+    std::unique_ptr<ExecutionContext>           plannedEctx_;
 };
 
 }   // namespace graph
@@ -10,6 +10,7 @@
 #include "common/base/Base.h"
 #include "common/interface/gen-cpp2/GraphService.h"
 #include "common/cpp/helpers.h"
+#include "common/datatypes/Value.h"
 #include "common/time/Duration.h"
 #include "session/ClientSession.h"
 #include "session/GraphSessionManager.h"
@@ -45,6 +46,15 @@ public:
         return query_;
     }
 
+    // The values bound to the parameters, i.e. `$name', referred by the query
+    void setParameterMap(std::unordered_map<std::string, Value> parameterMap) {
+        parameterMap_ = std::move(parameterMap);
+    }
+
+    const std::unordered_map<std::string, Value>& parameterMap() const {
+        return parameterMap_;
+    }
+
     Response& resp() {
         return resp_;
     }
@@ -92,6 +102,7 @@ public:
 private:
     time::Duration                              duration_;
     std::string                                 query_;
+    std::unordered_map<std::string, Value>      parameterMap_;
     Response                                    resp_;
     folly::Promise<Response>                    promise_;
     std::shared_ptr<ClientSession>              session_;
@@ -0,0 +1,177 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+
+#include "context/ExecutionContext.h"
+#include "context/QueryContext.h"
+#include "parser/GQLParser.h"
+#include "service/PlanCache.h"
+#include "stats/StatsDef.h"
+#include "validator/test/MockIndexManager.h"
+#include "validator/test/MockSchemaManager.h"
+
+namespace nebula {
+namespace graph {
+
+class PlanCacheTest : public testing::Test {
+protected:
+    static void SetUpTestCase() {
+        initCounters();
+    }
+
+    static std::unique_ptr<CachedPlan> newPlan() {
+        return std::make_unique<CachedPlan>(
+            std::make_unique<QueryContext>(), nullptr, std::make_unique<ExecutionContext>());
+    }
+
+    static StatusOr<bool> isCacheable(const std::string& query) {
+        QueryContext qctx;
+        auto result = GQLParser(&qctx).parse(query);
+        NG_RETURN_IF_ERROR(result);
+        return PlanCache::isCacheable(result.value().get(), &qctx);
+    }
+
+};
+
+TEST_F(PlanCacheTest, Normalize) {
+    EXPECT_EQ(PlanCache::normalize("  GO  FROM\t\"a\"\nOVER like ;; "), "GO FROM \"a\" OVER like");
+    // The quoted ones are kept as is
+    EXPECT_EQ(PlanCache::normalize("YIELD \"a  b\", 'c \\' ;d', `e  f`;"),
+              "YIELD \"a  b\", 'c \\' ;d', `e  f`");
+    EXPECT_EQ(PlanCache::normalize("YIELD 1"), PlanCache::normalize("YIELD   1;"));
+    EXPECT_NE(PlanCache::normalize("YIELD \"a b\""), PlanCache::normalize("YIELD \"a  b\""));
+}
+
+TEST_F(PlanCacheTest, IsCacheable) {
+    std::vector<std::pair<std::string, bool>> queries = {
+        {"YIELD abs(-1) AS a", true},
+        {"GO FROM \"a\" OVER like YIELD like.random AS r; YIELD 1 AS one", true},
+        // Only the function calls matter, not the names or strings alike
+        {"YIELD \"rand() now() uuid()\" AS s", true},
+        {"YIELD date(\"2021-01-01\") AS d, timestamp(\"2021-01-01T00:00:00\") AS t", true},
+        {"YIELD rand32() AS r", false},
+        {"YIELD abs(rand32(10)) + 1 AS r", false},
+        {"YIELD now() AS n", false},
+        {"YIELD date() AS d", false},
+        {"YIELD DATETIME() AS d", false},
+        {"GO FROM rand64() OVER like", false},
+        {"YIELD 1 AS one | YIELD $-.one + rand() AS r", false},
+        // Not read-only
+        {"INSERT VERTEX person(name) VALUES \"a\":(\"b\")", false},
+        {"SHOW SPACES", false},
+    };
+    for (auto& query : queries) {
+        auto result = isCacheable(query.first);
+        ASSERT_TRUE(result.ok()) << result.status();
+        EXPECT_EQ(result.value(), query.second) << query.first;
+    }
+}
+
+TEST_F(PlanCacheTest, AcquireAndRelease) {
+    PlanCache cache(10, 0, 2);
+    auto key = cache.makeKey("YIELD 1", 1, "root", 0);
+    EXPECT_EQ(cache.acquire(key), nullptr);
+
+    cache.release(key, newPlan());
+    cache.release(key, newPlan());
+    // Beyond the instances allowed for each key
+    cache.release(key, newPlan());
+    EXPECT_EQ(cache.size(), 2);
+
+    // Handed out exclusively
+    auto plan1 = cache.acquire(key);
+    auto plan2 = cache.acquire(key);
+    ASSERT_NE(plan1, nullptr);
+    ASSERT_NE(plan2, nullptr);
+    EXPECT_NE(plan1, plan2);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.acquire(key), nullptr);
+
+    cache.release(key, std::move(plan1));
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_NE(cache.acquire(key), nullptr);
+
+    // Keyed by the user and space too
+    cache.release(key, std::move(plan2));
+    EXPECT_EQ(cache.acquire(cache.makeKey("YIELD 1", 1, "guest", 0)), nullptr);
+    EXPECT_EQ(cache.acquire(cache.makeKey("YIELD 1", 2, "root", 0)), nullptr);
+    EXPECT_NE(cache.acquire(cache.makeKey("YIELD  1;", 1, "root", 0)), nullptr);
+}
+
+TEST_F(PlanCacheTest, EvictLeastRecentlyUsed) {
+    PlanCache cache(2, 0, 2);
+    auto key1 = cache.makeKey("YIELD 1", 1, "root", 0);
+    auto key2 = cache.makeKey("YIELD 2", 1, "root", 0);
+    auto key3 = cache.makeKey("YIELD 3", 1, "root", 0);
+    cache.release(key1, newPlan());
+    cache.release(key2, newPlan());
+
+    // Used recently
+    auto plan = cache.acquire(key1);
+    ASSERT_NE(plan, nullptr);
+    cache.release(key1, std::move(plan));
+
+    cache.release(key3, newPlan());
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.acquire(key2), nullptr);
+    EXPECT_NE(cache.acquire(key1), nullptr);
+    EXPECT_NE(cache.acquire(key3), nullptr);
+}
+
+TEST_F(PlanCacheTest, EvictExpired) {
+    PlanCache cache(10, 1, 2);
+    auto key = cache.makeKey("YIELD 1", 1, "root", 0);
+    cache.release(key, newPlan());
+    EXPECT_EQ(cache.size(), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_EQ(cache.acquire(key), nullptr);
+    EXPECT_EQ(cache.size(), 0);
+
+    // Cached again
+    cache.release(key, newPlan());
+    EXPECT_NE(cache.acquire(key), nullptr);
+}
+
+TEST_F(PlanCacheTest, KeyedBySchemaVersion) {
+    PlanCache cache(10, 0, 2);
+    auto key1 = cache.makeKey("YIELD 1", 1, "root", 1);
+    cache.release(key1, newPlan());
+    // The schema is altered
+    auto key2 = cache.makeKey("YIELD 1", 1, "root", 2);
+    EXPECT_EQ(cache.acquire(key2), nullptr);
+    cache.release(key2, newPlan());
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_NE(cache.acquire(key2), nullptr);
+
+    // The stale one is evicted as the least recently used
+    PlanCache small(1, 0, 2);
+    small.release(key1, newPlan());
+    small.release(key2, newPlan());
+    EXPECT_EQ(small.size(), 1);
+    EXPECT_EQ(small.acquire(key1), nullptr);
+    EXPECT_NE(small.acquire(key2), nullptr);
+}
+
+TEST_F(PlanCacheTest, SchemaVersion) {
+    auto schemaMng = MockSchemaManager::makeUnique();
+    auto indexMng = MockIndexManager::makeUnique();
+    QueryContext qctx;
+    qctx.setSchemaManager(schemaMng.get());
+    qctx.setIndexManager(indexMng.get());
+
+    auto version = PlanCache::schemaVersion(&qctx, 1);
+    ASSERT_TRUE(version.ok()) << version.status();
+    EXPECT_NE(version.value(), 0);
+    EXPECT_EQ(PlanCache::schemaVersion(&qctx, 1).value(), version.value());
+    // No space chosen
+    EXPECT_EQ(PlanCache::schemaVersion(&qctx, -1).value(), 0);
+    // The space is not found
+    EXPECT_FALSE(PlanCache::schemaVersion(&qctx, 100).ok());
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -9,6 +9,7 @@
 #include "common/clients/meta/MetaClient.h"
 #include "common/interface/gen-cpp2/meta_types.h"
 #include "common/time/Duration.h"
+#include "util/MemoryTracker.h"
 
 namespace nebula {
 namespace graph {
@@ -130,6 +131,11 @@ public:
         session_.set_space_name(spaceName);
     }
 
+    // Account the memory of all queries of the session
+    const std::shared_ptr<MemoryTracker>& memoryTracker() const {
+        return memTracker_;
+    }
+
     void addQuery(QueryContext* qctx);
 
     void deleteQuery(QueryContext* qctx);
@@ -158,6 +164,8 @@ private:
      */
     std::unordered_map<GraphSpaceID, meta::cpp2::RoleType> roles_;
     std::unordered_map<ExecutionPlanID, QueryContext*> contexts_;
+    std::shared_ptr<MemoryTracker> memTracker_{
+        std::make_shared<MemoryTracker>(MemoryTracker::process())};
 };
 
 }  // namespace graph
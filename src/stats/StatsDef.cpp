@@ -20,6 +20,15 @@ stats::CounterId kNumSlowQueries;
 stats::CounterId kNumQueryErrors;
 stats::CounterId kQueryLatencyUs;
 stats::CounterId kSlowQueryLatencyUs;
+stats::CounterId kNumPlanCacheHits;
+stats::CounterId kNumPlanCacheMisses;
+stats::CounterId kNumPlanCacheEvictions;
+stats::CounterId kNumVertexCacheHits;
+stats::CounterId kNumVertexCacheMisses;
+stats::CounterId kVertexCacheBytes;
+stats::CounterId kNumNeighborCacheHits;
+stats::CounterId kNumNeighborCacheMisses;
+stats::CounterId kNeighborCacheBytes;
 
 void initCounters() {
     kNumQueries = stats::StatsManager::registerStats("num_queries", "rate, sum");
@@ -29,6 +38,20 @@ void initCounters() {
         "query_latency_us", 1000, 0, 2000, "avg, p75, p95, p99, p999");
     kSlowQueryLatencyUs = stats::StatsManager::registerHisto(
         "slow_query_latency_us", 1000, 0, 2000, "avg, p75, p95, p99, p999");
+    kNumPlanCacheHits = stats::StatsManager::registerStats("num_plan_cache_hits", "rate, sum");
+    kNumPlanCacheMisses = stats::StatsManager::registerStats("num_plan_cache_misses", "rate, sum");
+    kNumPlanCacheEvictions =
+        stats::StatsManager::registerStats("num_plan_cache_evictions", "rate, sum");
+    kNumVertexCacheHits = stats::StatsManager::registerStats("num_vertex_cache_hits", "rate, sum");
+    kNumVertexCacheMisses =
+        stats::StatsManager::registerStats("num_vertex_cache_misses", "rate, sum");
+    // Sampled each time the cache is looked up
+    kVertexCacheBytes = stats::StatsManager::registerStats("vertex_cache_bytes", "avg");
+    kNumNeighborCacheHits =
+        stats::StatsManager::registerStats("num_neighbor_cache_hits", "rate, sum");
+    kNumNeighborCacheMisses =
+        stats::StatsManager::registerStats("num_neighbor_cache_misses", "rate, sum");
+    kNeighborCacheBytes = stats::StatsManager::registerStats("neighbor_cache_bytes", "avg");
 }
 
 }  // namespace nebula
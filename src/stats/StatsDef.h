@@ -20,6 +20,15 @@ extern stats::CounterId kNumSlowQueries;
 extern stats::CounterId kNumQueryErrors;
 extern stats::CounterId kQueryLatencyUs;
 extern stats::CounterId kSlowQueryLatencyUs;
+extern stats::CounterId kNumPlanCacheHits;
+extern stats::CounterId kNumPlanCacheMisses;
+extern stats::CounterId kNumPlanCacheEvictions;
+extern stats::CounterId kNumVertexCacheHits;
+extern stats::CounterId kNumVertexCacheMisses;
+extern stats::CounterId kVertexCacheBytes;
+extern stats::CounterId kNumNeighborCacheHits;
+extern stats::CounterId kNumNeighborCacheMisses;
+extern stats::CounterId kNeighborCacheBytes;
 
 void initCounters();
 
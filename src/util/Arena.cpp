@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/Arena.h"
+
+namespace nebula {
+namespace graph {
+
+constexpr size_t Arena::kMinChunkSize;
+constexpr size_t Arena::kMaxChunkSize;
+constexpr size_t Arena::kNumSizeClasses;
+
+Arena::~Arena() {
+    if (tracker_ != nullptr) {
+        tracker_->release(allocatedBytes_);
+    }
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    DCHECK_EQ(align & (align - 1), 0UL) << "Alignment must be power of 2";
+    if (size > sizeof(FreeBlock)) {
+        // The blocks in the list of ceil(log2(size)) are large enough
+        auto& head = freeLists_[64 - __builtin_clzll(size - 1)];
+        if (head != nullptr && reinterpret_cast<uintptr_t>(head) % align == 0) {
+            auto* block = head;
+            head = block->next;
+            return block;
+        }
+    }
+    auto space = static_cast<size_t>(end_ - cur_);
+    auto padding = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+    if (cur_ == nullptr || padding + size > space) {
+        newChunk(size + align);
+        padding = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+    }
+    auto* ptr = cur_ + padding;
+    cur_ = ptr + size;
+    return ptr;
+}
+
+void Arena::deallocate(void* ptr, size_t size) {
+    // The small ones are not worth it
+    if (ptr == nullptr || size <= sizeof(FreeBlock)) {
+        return;
+    }
+    auto& head = freeLists_[63 - __builtin_clzll(size)];
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = head;
+    head = block;
+}
+
+void Arena::newChunk(size_t size) {
+    // The chunks grow exponentially, the large allocation takes a chunk of its own
+    auto chunkSize = std::max(nextChunkSize_, size);
+    nextChunkSize_ = std::min(nextChunkSize_ * 2, kMaxChunkSize);
+    chunks_.emplace_back(new char[chunkSize]);
+    cur_ = chunks_.back().get();
+    end_ = cur_ + chunkSize;
+    allocatedBytes_ += chunkSize;
+    if (tracker_ != nullptr) {
+        tracker_->consume(chunkSize);
+    }
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,109 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTIL_ARENA_H_
+#define UTIL_ARENA_H_
+
+#include "common/base/Base.h"
+#include "util/MemoryTracker.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * Arena allocates memory by bumping a pointer in chunks, the chunks are only freed when the
+ * arena is destroyed, so the intermediate objects of an executor are released all at once
+ * instead of by millions of frees. The freed blocks, e.g. the old buffers of the growing
+ * vectors, are reused by the later allocations of no larger size. The chunks are accounted
+ * to the tracker if any. It's NOT thread-safe, each run of an executor has its own arena.
+ * Only the containers taking an allocator could be put in it, e.g. the hash tables of join;
+ * Row and Value of nebula-common always use the heap.
+ */
+class Arena final {
+public:
+    explicit Arena(std::shared_ptr<MemoryTracker> tracker = nullptr)
+        : tracker_(std::move(tracker)) {}
+
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    // Keep the block for reuse
+    void deallocate(void* ptr, size_t size);
+
+    // Bytes of all chunks
+    size_t allocatedBytes() const {
+        return allocatedBytes_;
+    }
+
+private:
+    static constexpr size_t kMinChunkSize = 4096;
+    static constexpr size_t kMaxChunkSize = 1 << 20;
+    static constexpr size_t kNumSizeClasses = 64;
+
+    struct FreeBlock {
+        FreeBlock*      next;
+    };
+
+    void newChunk(size_t size);
+
+    std::shared_ptr<MemoryTracker>              tracker_;
+    std::vector<std::unique_ptr<char[]>>        chunks_;
+    // The freed blocks of sizes in [2^i, 2^(i+1)) are in the i-th list
+    std::array<FreeBlock*, kNumSizeClasses>     freeLists_{};
+    char*                                       cur_{nullptr};
+    char*                                       end_{nullptr};
+    size_t                                      nextChunkSize_{kMinChunkSize};
+    size_t                                      allocatedBytes_{0};
+};
+
+// STL allocator on an arena
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena* arena) noexcept : arena_(DCHECK_NOTNULL(arena)) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        arena_->deallocate(ptr, n * sizeof(T));
+    }
+
+    Arena* arena() const {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& rhs) const {
+        return arena_ == rhs.arena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& rhs) const {
+        return arena_ != rhs.arena();
+    }
+
+private:
+    Arena*          arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // UTIL_ARENA_H_
@@ -10,6 +10,7 @@
 
 #include "common/expression/PropertyExpression.h"
 #include "common/function/AggFunctionManager.h"
+#include "common/function/FunctionManager.h"
 #include "context/QueryExpressionContext.h"
 #include "visitor/FoldConstantExprVisitor.h"
 #include "common/base/ObjectPool.h"
@@ -640,6 +641,31 @@ bool ExpressionUtils::findInnerRandFunction(const Expression *expr) {
     return false;
 }
 
+bool ExpressionUtils::findNonDeterministicFunction(const Expression *expr) {
+    auto finder = [](const Expression *e) -> bool {
+        if (e->kind() != Expression::Kind::kFunctionCall) {
+            return false;
+        }
+        auto call = static_cast<const FunctionCallExpression *>(e);
+        auto func = call->name();
+        std::transform(func.begin(), func.end(), func.begin(), ::tolower);
+        auto arity = call->args()->numArgs();
+        // The current time, which would be folded into the plan
+        if (arity == 0 && (!func.compare("timestamp") || !func.compare("date") ||
+                           !func.compare("time") || !func.compare("datetime"))) {
+            return true;
+        }
+        auto isPure = FunctionManager::getIsPure(func, arity);
+        return !isPure.ok() || !isPure.value();
+    };
+    if (finder(expr)) {
+        return true;
+    }
+    FindVisitor visitor(finder);
+    const_cast<Expression *>(expr)->accept(&visitor);
+    return !visitor.results().empty();
+}
+
 // Negate the given relational expr
 RelationalExpression *ExpressionUtils::reverseRelExpr(ObjectPool *pool,
                                                       RelationalExpression *expr) {
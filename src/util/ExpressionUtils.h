@@ -135,6 +135,9 @@ public:
 
     static bool findInnerRandFunction(const Expression *expr);
 
+    // Whether any function in expr returns different results in each call, e.g. rand(), now()
+    static bool findNonDeterministicFunction(const Expression *expr);
+
     // loop condition
     // ++loopSteps <= steps
     static Expression* stepCondition(ObjectPool* pool, const std::string& loopStep, uint32_t steps);
@@ -0,0 +1,129 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/MemoryTracker.h"
+
+#include "common/base/Memory.h"
+#include "common/thread/GenericWorker.h"
+#include "util/SpillFile.h"
+
+namespace nebula {
+namespace graph {
+
+// Number of rows sampled to estimate the size of a dataset
+static constexpr size_t kNumSampledRows = 64;
+
+// The last sample of system memory in KB
+static std::atomic<int64_t> gSystemMemUsedKB{0};
+static std::atomic<int64_t> gSystemMemTotalKB{0};
+
+// static
+std::shared_ptr<MemoryTracker> MemoryTracker::process() {
+    static auto tracker = std::make_shared<MemoryTracker>(nullptr);
+    return tracker;
+}
+
+void MemoryTracker::consume(int64_t bytes) {
+    for (auto* tracker = this; tracker != nullptr; tracker = tracker->parent_.get()) {
+        auto used = tracker->used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = tracker->peak_.load(std::memory_order_relaxed);
+        while (used > peak &&
+               !tracker->peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void MemoryTracker::release(int64_t bytes) {
+    for (auto* tracker = this; tracker != nullptr; tracker = tracker->parent_.get()) {
+        tracker->used_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+}
+
+Status MemoryTracker::checkLimit() const {
+    for (auto* tracker = this; tracker != nullptr; tracker = tracker->parent_.get()) {
+        if (tracker->exceedsLimit()) {
+            return Status::Error("Used memory(%ld bytes) of query exceeds the quota(%ld bytes).",
+                                 tracker->used(),
+                                 tracker->limit());
+        }
+    }
+    return Status::OK();
+}
+
+// static
+int64_t MemoryTracker::estimate(const Value& value) {
+    if (!value.isDataSet()) {
+        return SpillFile::estimateSize(value);
+    }
+    return sizeof(Value) + estimate(value.getDataSet());
+}
+
+// static
+int64_t MemoryTracker::estimate(const DataSet& ds) {
+    auto& rows = ds.rows;
+    int64_t size = sizeof(DataSet);
+    if (rows.empty()) {
+        return size;
+    }
+    // Sample the rows evenly
+    auto step = std::max<size_t>(rows.size() / kNumSampledRows, 1);
+    size_t sampled = 0;
+    int64_t sampledSize = 0;
+    for (size_t i = 0; i < rows.size() && sampled < kNumSampledRows; i += step, ++sampled) {
+        sampledSize += SpillFile::estimateSize(rows[i]);
+    }
+    return size + sampledSize / static_cast<int64_t>(sampled) * rows.size();
+}
+
+// static
+Status MemoryTracker::refreshSystemMemory() {
+    auto status = MemInfo::make();
+    NG_RETURN_IF_ERROR(status);
+    auto mem = std::move(status).value();
+    gSystemMemUsedKB.store(mem->usedInKB(), std::memory_order_relaxed);
+    gSystemMemTotalKB.store(mem->totalInKB(), std::memory_order_relaxed);
+    return Status::OK();
+}
+
+// static
+void MemoryTracker::startSystemMemoryRefresher(uint32_t intervalMs) {
+    static auto* worker = new thread::GenericWorker();
+    static std::once_flag once;
+    std::call_once(once, [intervalMs]() {
+        auto status = refreshSystemMemory();
+        if (!status.ok()) {
+            LOG(WARNING) << "Failed to sample system memory: " << status;
+        }
+        CHECK(worker->start("mem-sampler"));
+        worker->addRepeatTask(intervalMs, []() {
+            auto ret = refreshSystemMemory();
+            if (!ret.ok()) {
+                LOG(WARNING) << "Failed to sample system memory: " << ret;
+            }
+        });
+    });
+}
+
+// static
+Status MemoryTracker::checkSystemMemory(double highWatermarkRatio) {
+    if (gSystemMemTotalKB.load(std::memory_order_relaxed) == 0) {
+        // Not sampled by the background thread yet
+        NG_RETURN_IF_ERROR(refreshSystemMemory());
+    }
+    auto used = gSystemMemUsedKB.load(std::memory_order_relaxed);
+    auto total = gSystemMemTotalKB.load(std::memory_order_relaxed);
+    if (used > total * highWatermarkRatio) {
+        return Status::Error(
+            "Used memory(%ldKB) hits the high watermark(%lf) of total system memory(%ldKB).",
+            used,
+            highWatermarkRatio,
+            total);
+    }
+    return Status::OK();
+}
+
+}   // namespace graph
+}   // namespace nebula
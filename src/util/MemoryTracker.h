@@ -0,0 +1,84 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTIL_MEMORYTRACKER_H_
+#define UTIL_MEMORYTRACKER_H_
+
+#include "common/base/Base.h"
+#include "common/base/Status.h"
+#include "common/datatypes/Value.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * MemoryTracker accounts the memory held by the results of executors. The trackers make up
+ * a hierarchy of process -> session -> query -> executor, the bytes consumed by a tracker
+ * are consumed by all its ancestors too. A child holds its parent, so the parents always
+ * outlive the children.
+ */
+class MemoryTracker final {
+public:
+    // The root tracker of the graph daemon
+    static std::shared_ptr<MemoryTracker> process();
+
+    // `limit' less than or equal to 0 means no limit
+    explicit MemoryTracker(std::shared_ptr<MemoryTracker> parent, int64_t limit = 0)
+        : parent_(std::move(parent)), limit_(limit) {}
+
+    void consume(int64_t bytes);
+
+    void release(int64_t bytes);
+
+    int64_t used() const {
+        return used_.load(std::memory_order_relaxed);
+    }
+
+    // The max bytes used so far
+    int64_t peak() const {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+    int64_t limit() const {
+        return limit_;
+    }
+
+    bool exceedsLimit() const {
+        return limit_ > 0 && used() > limit_;
+    }
+
+    // Return error if this tracker or any of its ancestors exceeds the limit
+    Status checkLimit() const;
+
+    const std::shared_ptr<MemoryTracker>& parent() const {
+        return parent_;
+    }
+
+    // Rough memory footprint of the value, the rows of a large dataset are sampled
+    static int64_t estimate(const Value& value);
+
+    static int64_t estimate(const DataSet& ds);
+
+    // Sample the memory of system, it's done by a background thread periodically once
+    // started, so that checking the watermark is cheap
+    static Status refreshSystemMemory();
+
+    static void startSystemMemoryRefresher(uint32_t intervalMs);
+
+    // Return error if the last sample of used memory hits the high watermark of system
+    static Status checkSystemMemory(double highWatermarkRatio);
+
+private:
+    std::shared_ptr<MemoryTracker>      parent_;
+    int64_t                             limit_{0};
+    std::atomic<int64_t>                used_{0};
+    std::atomic<int64_t>                peak_{0};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // UTIL_MEMORYTRACKER_H_
@@ -34,6 +34,17 @@ void QueryUtil::buildConstantInput(QueryContext *qctx, Starts& starts, std::stri
 // static
 SubPlan QueryUtil::buildRuntimeInput(QueryContext* qctx, Starts& starts) {
     auto pool = qctx->objPool();
+    if (starts.originalSrc->kind() == Expression::Kind::kVar) {
+        // The parameter of vid list, e.g. `GO FROM $vids', is unwound into rows
+        auto* unwind = Unwind::make(qctx, nullptr, starts.originalSrc->clone(), kVid);
+        unwind->setColNames({kVid});
+        starts.src = InputPropertyExpression::make(pool, kVid);
+
+        SubPlan subPlan;
+        subPlan.root = Dedup::make(qctx, unwind);
+        subPlan.tail = unwind;
+        return subPlan;
+    }
     auto* columns = pool->add(new YieldColumns());
     auto* column = new YieldColumn(starts.originalSrc->clone(), kVid);
     columns->addColumn(column);
@@ -318,6 +318,17 @@ bool SchemaUtil::isValidVid(const Value &value) {
     return value.isStr() || value.isInt();
 }
 
+// static
+PartitionID SchemaUtil::partId(meta::MetaClient *metaClient, int32_t numParts, const Value &vid) {
+    if (vid.isInt()) {
+        // The storage client takes the int vid as its 8 bytes
+        auto id = vid.getInt();
+        return metaClient->partId(numParts,
+                                  std::string(reinterpret_cast<const char *>(&id), sizeof(id)));
+    }
+    return metaClient->partId(numParts, vid.getStr());
+}
+
 StatusOr<std::unique_ptr<std::vector<storage::cpp2::VertexProp>>>
 SchemaUtil::getAllVertexProp(QueryContext *qctx, const SpaceInfo &space, bool withProp) {
     // Get all tags in the space
@@ -17,6 +17,10 @@
 #include "parser/MaintainSentences.h"
 
 namespace nebula {
+namespace meta {
+class MetaClient;
+}   // namespace meta
+
 namespace graph {
 class QueryContext;
 struct SpaceInfo;
@@ -60,6 +64,10 @@ public:
 
     static bool isValidVid(const Value& value);
 
+    // The partition of the vid in the space of `numParts' partitions, the same as the one
+    // the storage client sends the vid to
+    static PartitionID partId(meta::MetaClient* metaClient, int32_t numParts, const Value& vid);
+
     // Fetch all tags in the space and retrieve props from tags
     // only take _tag when withProp is false
     static StatusOr<std::unique_ptr<std::vector<VertexProp>>>
@@ -0,0 +1,137 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/SpillFile.h"
+
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include "common/datatypes/DataSetOps-inl.h"
+
+namespace nebula {
+namespace graph {
+
+// static
+StatusOr<std::unique_ptr<SpillFile>> SpillFile::make(const std::string& dir) {
+    auto path = folly::stringPrintf("%s/nebula-graphd-spill-XXXXXX", dir.c_str());
+    int fd = ::mkstemp(&path[0]);
+    if (fd < 0) {
+        return Status::Error("Failed to create spill file `%s': %s",
+                             path.c_str(),
+                             ::strerror(errno));
+    }
+    ::unlink(path.c_str());
+    auto* file = ::fdopen(fd, "w+b");
+    if (file == nullptr) {
+        ::close(fd);
+        return Status::Error("Failed to open spill file `%s': %s",
+                             path.c_str(),
+                             ::strerror(errno));
+    }
+    ::setvbuf(file, nullptr, _IOFBF, kBufferSize);
+    return std::unique_ptr<SpillFile>(new SpillFile(file, std::move(path)));
+}
+
+SpillFile::SpillFile(FILE* file, std::string path) : file_(file), path_(std::move(path)) {}
+
+SpillFile::~SpillFile() {
+    if (file_ != nullptr) {
+        ::fclose(file_);
+    }
+}
+
+Status SpillFile::write(const Row& row) {
+    buffer_.clear();
+    apache::thrift::CompactSerializer::serialize(row, &buffer_);
+    uint32_t len = buffer_.size();
+    if (::fwrite(&len, sizeof(len), 1, file_) != 1 ||
+        ::fwrite(buffer_.data(), 1, len, file_) != len) {
+        return Status::Error("Failed to write spill file `%s': %s",
+                             path_.c_str(),
+                             ::strerror(errno));
+    }
+    numRows_++;
+    size_ += sizeof(len) + len;
+    return Status::OK();
+}
+
+Status SpillFile::rewind() {
+    if (::fflush(file_) != 0 || ::fseek(file_, 0, SEEK_SET) != 0) {
+        return Status::Error("Failed to rewind spill file `%s': %s",
+                             path_.c_str(),
+                             ::strerror(errno));
+    }
+    return Status::OK();
+}
+
+StatusOr<bool> SpillFile::read(Row* row) {
+    uint32_t len = 0;
+    if (::fread(&len, sizeof(len), 1, file_) != 1) {
+        if (::feof(file_)) {
+            return false;
+        }
+        return Status::Error("Failed to read spill file `%s': %s",
+                             path_.c_str(),
+                             ::strerror(errno));
+    }
+    buffer_.resize(len);
+    if (::fread(&buffer_[0], 1, len, file_) != len) {
+        return Status::Error("Truncated spill file `%s'", path_.c_str());
+    }
+    try {
+        row->values.clear();
+        apache::thrift::CompactSerializer::deserialize(buffer_, *row);
+    } catch (const std::exception& e) {
+        return Status::Error("Corrupted spill file `%s': %s", path_.c_str(), e.what());
+    }
+    return true;
+}
+
+// static
+size_t SpillFile::estimateSize(const Value& value) {
+    size_t size = sizeof(Value);
+    switch (value.type()) {
+        case Value::Type::STRING:
+            size += value.getStr().capacity();
+            break;
+        case Value::Type::LIST:
+            for (auto& v : value.getList().values) {
+                size += estimateSize(v);
+            }
+            break;
+        case Value::Type::SET:
+            for (auto& v : value.getSet().values) {
+                size += estimateSize(v);
+            }
+            break;
+        case Value::Type::MAP:
+            for (auto& kv : value.getMap().kvs) {
+                size += kv.first.capacity() + estimateSize(kv.second);
+            }
+            break;
+        case Value::Type::VERTEX:
+        case Value::Type::EDGE:
+        case Value::Type::PATH:
+        case Value::Type::DATASET:
+            // Not worth walking through the properties for a rough estimation
+            size += 256;
+            break;
+        default:
+            break;
+    }
+    return size;
+}
+
+// static
+size_t SpillFile::estimateSize(const Row& row) {
+    size_t size = sizeof(Row);
+    for (auto& value : row.values) {
+        size += estimateSize(value);
+    }
+    return size;
+}
+
+}   // namespace graph
+}   // namespace nebula
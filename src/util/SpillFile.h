@@ -0,0 +1,68 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTIL_SPILLFILE_H_
+#define UTIL_SPILLFILE_H_
+
+#include "common/base/Base.h"
+#include "common/base/StatusOr.h"
+#include "common/datatypes/DataSet.h"
+
+namespace nebula {
+namespace graph {
+
+/**
+ * SpillFile is a temporary file holding the rows spilled out of memory by the executors.
+ * Each row is encoded by the thrift compact protocol and prefixed by its length. The file
+ * is unlinked once created, so it's removed when closed even if graphd crashes.
+ */
+class SpillFile final {
+public:
+    // Size of the stdio buffer of each open file
+    static constexpr size_t kBufferSize = 64 << 10;
+
+    // Create the file in `dir'
+    static StatusOr<std::unique_ptr<SpillFile>> make(const std::string& dir);
+
+    ~SpillFile();
+
+    Status write(const Row& row);
+
+    // Flush the written rows and read them from the beginning
+    Status rewind();
+
+    // Read the next row into `row', return false at the end of file
+    StatusOr<bool> read(Row* row);
+
+    size_t numRows() const {
+        return numRows_;
+    }
+
+    // Bytes of the encoded rows
+    size_t size() const {
+        return size_;
+    }
+
+    // Rough memory footprint of the value, used to decide whether to spill
+    static size_t estimateSize(const Value& value);
+
+    static size_t estimateSize(const Row& row);
+
+private:
+    SpillFile(FILE* file, std::string path);
+
+    FILE*                       file_{nullptr};
+    std::string                 path_;
+    // Buffer to encode or decode one row
+    std::string                 buffer_;
+    size_t                      numRows_{0};
+    size_t                      size_{0};
+};
+
+}   // namespace graph
+}   // namespace nebula
+
+#endif   // UTIL_SPILLFILE_H_
@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include "common/datatypes/DataSet.h"
+#include "util/Arena.h"
+
+namespace nebula {
+namespace graph {
+
+// The build side of a hash join, 4 rows per key
+std::vector<Row> gRows;
+
+using RowList = ArenaVector<const Row*>;
+using ArenaHashTable = std::unordered_map<Value,
+                                          RowList,
+                                          std::hash<Value>,
+                                          std::equal_to<Value>,
+                                          ArenaAllocator<std::pair<const Value, RowList>>>;
+
+void setUpRows(size_t num) {
+    gRows.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        gRows.emplace_back(Row({Value(static_cast<int64_t>(i / 4)), Value("value")}));
+    }
+}
+
+size_t buildByHeap(size_t iters) {
+    size_t size = 0;
+    for (size_t i = 0; i < iters; ++i) {
+        std::unordered_map<Value, std::vector<const Row*>> hashTable;
+        hashTable.reserve(gRows.size());
+        for (auto& row : gRows) {
+            hashTable[row[0]].emplace_back(&row);
+        }
+        size += hashTable.size();
+    }
+    folly::doNotOptimizeAway(size);
+    return iters;
+}
+
+size_t buildInArena(size_t iters) {
+    size_t size = 0;
+    for (size_t i = 0; i < iters; ++i) {
+        Arena arena;
+        ArenaHashTable hashTable(gRows.size(),
+                                 std::hash<Value>(),
+                                 std::equal_to<Value>(),
+                                 ArenaHashTable::allocator_type(&arena));
+        RowList::allocator_type allocator(hashTable.get_allocator());
+        for (auto& row : gRows) {
+            auto found = hashTable.find(row[0]);
+            if (found == hashTable.end()) {
+                found = hashTable.emplace(row[0], RowList(allocator)).first;
+            }
+            found->second.emplace_back(&row);
+        }
+        size += hashTable.size();
+    }
+    folly::doNotOptimizeAway(size);
+    return iters;
+}
+
+BENCHMARK_NAMED_PARAM_MULTI(buildByHeap, hash_table)
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(buildInArena, hash_table)
+
+}   // namespace graph
+}   // namespace nebula
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    nebula::graph::setUpRows(1000000);
+    folly::runBenchmarks();
+    return 0;
+}
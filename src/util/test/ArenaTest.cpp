@@ -0,0 +1,88 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/Arena.h"
+
+#include <gtest/gtest.h>
+
+namespace nebula {
+namespace graph {
+
+TEST(ArenaTest, Allocate) {
+    Arena arena;
+    EXPECT_EQ(arena.allocatedBytes(), 0);
+    for (size_t i = 1; i < 1000; ++i) {
+        for (size_t align : {1, 2, 4, 8, 16}) {
+            auto* ptr = arena.allocate(i, align);
+            ASSERT_NE(ptr, nullptr);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % align, 0);
+            std::memset(ptr, 0xff, i);
+        }
+    }
+    // The large allocation
+    auto allocated = arena.allocatedBytes();
+    auto* ptr = arena.allocate(8 << 20);
+    std::memset(ptr, 0xff, 8 << 20);
+    EXPECT_GE(arena.allocatedBytes(), allocated + (8 << 20));
+}
+
+TEST(ArenaTest, Containers) {
+    Arena arena;
+    using Map = std::unordered_map<int64_t,
+                                   ArenaVector<int64_t>,
+                                   std::hash<int64_t>,
+                                   std::equal_to<int64_t>,
+                                   ArenaAllocator<std::pair<const int64_t, ArenaVector<int64_t>>>>;
+    Map map(16, std::hash<int64_t>(), std::equal_to<int64_t>(), Map::allocator_type(&arena));
+    ArenaVector<int64_t>::allocator_type allocator(map.get_allocator());
+    for (int64_t i = 0; i < 10000; ++i) {
+        auto found = map.find(i % 100);
+        if (found == map.end()) {
+            found = map.emplace(i % 100, ArenaVector<int64_t>(allocator)).first;
+        }
+        found->second.emplace_back(i);
+    }
+    ASSERT_EQ(map.size(), 100);
+    for (auto& kv : map) {
+        ASSERT_EQ(kv.second.size(), 100);
+        for (auto v : kv.second) {
+            EXPECT_EQ(v % 100, kv.first);
+        }
+    }
+    EXPECT_GT(arena.allocatedBytes(), 10000 * sizeof(int64_t));
+}
+
+TEST(ArenaTest, Reuse) {
+    Arena arena;
+    // The buffers of the vectors are reused by the later ones
+    for (int64_t i = 0; i < 1000; ++i) {
+        ArenaVector<int64_t> vec{ArenaVector<int64_t>::allocator_type(&arena)};
+        for (int64_t j = 0; j < 1000; ++j) {
+            vec.emplace_back(j);
+        }
+    }
+    EXPECT_LT(arena.allocatedBytes(), 1 << 20);
+
+    auto* ptr = arena.allocate(100, 16);
+    arena.deallocate(ptr, 100);
+    EXPECT_EQ(arena.allocate(64, 16), ptr);
+    EXPECT_NE(arena.allocate(64, 16), ptr);
+}
+
+TEST(ArenaTest, MemoryTracker) {
+    auto tracker = std::make_shared<MemoryTracker>(nullptr);
+    {
+        Arena arena(tracker);
+        arena.allocate(100);
+        EXPECT_EQ(tracker->used(), arena.allocatedBytes());
+        arena.allocate(8 << 20);
+        EXPECT_EQ(tracker->used(), arena.allocatedBytes());
+    }
+    EXPECT_EQ(tracker->used(), 0);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,64 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/MemoryTracker.h"
+
+#include <gtest/gtest.h>
+
+namespace nebula {
+namespace graph {
+
+TEST(MemoryTrackerTest, Hierarchy) {
+    auto session = std::make_shared<MemoryTracker>(nullptr);
+    auto query = std::make_shared<MemoryTracker>(session, 100);
+    auto executor1 = std::make_shared<MemoryTracker>(query);
+    auto executor2 = std::make_shared<MemoryTracker>(query);
+
+    executor1->consume(60);
+    executor2->consume(30);
+    EXPECT_EQ(executor1->used(), 60);
+    EXPECT_EQ(query->used(), 90);
+    EXPECT_EQ(session->used(), 90);
+    EXPECT_FALSE(query->exceedsLimit());
+
+    executor2->consume(20);
+    EXPECT_EQ(query->used(), 110);
+    EXPECT_TRUE(query->exceedsLimit());
+    EXPECT_FALSE(session->exceedsLimit());
+    // Checked through the ancestors
+    EXPECT_FALSE(executor1->checkLimit().ok());
+    EXPECT_TRUE(session->checkLimit().ok());
+
+    executor1->release(60);
+    EXPECT_EQ(executor1->used(), 0);
+    EXPECT_EQ(executor1->peak(), 60);
+    EXPECT_EQ(query->used(), 50);
+    EXPECT_EQ(query->peak(), 110);
+    EXPECT_FALSE(query->exceedsLimit());
+}
+
+TEST(MemoryTrackerTest, Estimate) {
+    DataSet small({"a", "b"});
+    DataSet large({"a", "b"});
+    for (int64_t i = 0; i < 1000; ++i) {
+        if (i < 10) {
+            small.emplace_back(Row({Value(i), Value("hello")}));
+        }
+        large.emplace_back(Row({Value(i), Value("hello")}));
+    }
+    auto smallSize = MemoryTracker::estimate(Value(std::move(small)));
+    auto largeSize = MemoryTracker::estimate(Value(std::move(large)));
+    EXPECT_GT(smallSize, 0);
+    EXPECT_GT(largeSize, smallSize * 50);
+}
+
+TEST(MemoryTrackerTest, SystemMemory) {
+    EXPECT_TRUE(MemoryTracker::checkSystemMemory(1.0).ok());
+    EXPECT_FALSE(MemoryTracker::checkSystemMemory(0.0).ok());
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "util/SpillFile.h"
+
+#include <gtest/gtest.h>
+
+namespace nebula {
+namespace graph {
+
+TEST(SpillFileTest, WriteAndRead) {
+    auto result = SpillFile::make("/tmp");
+    ASSERT_TRUE(result.ok()) << result.status();
+    auto file = std::move(result).value();
+
+    std::vector<Row> rows;
+    for (int64_t i = 0; i < 1000; ++i) {
+        Row row;
+        row.values.emplace_back(i);
+        row.values.emplace_back(folly::to<std::string>("name", i));
+        row.values.emplace_back(i % 3 == 0 ? Value(NullType::__NULL__) : Value(i * 0.5));
+        row.values.emplace_back(List({Value(i), Value("a")}));
+        rows.emplace_back(std::move(row));
+    }
+    for (auto& row : rows) {
+        ASSERT_TRUE(file->write(row).ok());
+    }
+    EXPECT_EQ(file->numRows(), rows.size());
+    EXPECT_GT(file->size(), 0);
+
+    // Read twice
+    for (auto round = 0; round < 2; ++round) {
+        ASSERT_TRUE(file->rewind().ok());
+        std::vector<Row> read;
+        Row row;
+        while (true) {
+            auto ret = file->read(&row);
+            ASSERT_TRUE(ret.ok()) << ret.status();
+            if (!ret.value()) {
+                break;
+            }
+            read.emplace_back(std::move(row));
+        }
+        EXPECT_EQ(read, rows);
+    }
+}
+
+TEST(SpillFileTest, BadDir) {
+    auto result = SpillFile::make("/not/existed/dir");
+    EXPECT_FALSE(result.ok());
+}
+
+TEST(SpillFileTest, EstimateSize) {
+    Row small({Value(1), Value(2)});
+    Row large({Value(1), Value(std::string(1024, 'a'))});
+    EXPECT_GT(SpillFile::estimateSize(large), SpillFile::estimateSize(small) + 1024);
+}
+
+}   // namespace graph
+}   // namespace nebula
@@ -7,6 +7,7 @@
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include "validator/TraversalValidator.h"
 #include "common/expression/VariableExpression.h"
+#include "util/QueryUtil.h"
 #include "util/SchemaUtil.h"
 
 namespace nebula {
@@ -18,6 +19,17 @@ Status TraversalValidator::validateStarts(const VerticesClause* clause, Starts&
     }
     if (clause->isRef()) {
         auto* src = clause->ref();
+        if (src->kind() == Expression::Kind::kVar) {
+            auto& name = static_cast<const VariableExpression*>(src)->var();
+            if (vctx_->existVar(name)) {
+                return Status::SemanticError(
+                    "`%s', the vids of variable should be referred by `$%s.<column>'.",
+                    src->toString().c_str(), name.c_str());
+            }
+            // The list of vids bound as a parameter, which is unwound at runtime
+            starts.originalSrc = src;
+            return Status::OK();
+        }
         if (src->kind() != Expression::Kind::kInputProperty
                 && src->kind() != Expression::Kind::kVarProperty) {
             return Status::SemanticError(
@@ -156,6 +168,11 @@ void TraversalValidator::buildConstantInput(Starts& starts, std::string& startVi
 
 PlanNode* TraversalValidator::buildRuntimeInput(Starts& starts, PlanNode*& projectStartVid) {
     auto pool = qctx_->objPool();
+    if (starts.originalSrc->kind() == Expression::Kind::kVar) {
+        auto subPlan = QueryUtil::buildRuntimeInput(qctx_, starts);
+        projectStartVid = subPlan.tail;
+        return subPlan.root;
+    }
     auto* columns = pool->add(new YieldColumns());
     auto* column = new YieldColumn(starts.originalSrc->clone(), kVid);
     columns->addColumn(column);
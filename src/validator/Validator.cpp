@@ -310,6 +310,25 @@ Status Validator::appendPlan(PlanNode* root) {
     return appendPlan(tail_, root);
 }
 
+// static
+Status Validator::validateParameters(const std::unordered_map<std::string, Value>& params,
+                                     const QueryContext* qctx) {
+    auto* symTable = qctx->symTable();
+    for (auto& param : params) {
+        if (symTable->getVar(param.first) != nullptr) {
+            return Status::SemanticError("Parameter `%s' conflicts with a variable of the query.",
+                                         param.first.c_str());
+        }
+    }
+    for (auto& name : qctx->referredVars()) {
+        if (symTable->getVar(name) == nullptr && params.find(name) == params.end()) {
+            return Status::SemanticError("`$%s' is neither a variable nor a bound parameter.",
+                                         name.c_str());
+        }
+    }
+    return Status::OK();
+}
+
 Status Validator::validate() {
     if (!vctx_) {
         VLOG(1) << "Validate context was not given.";
@@ -155,6 +155,13 @@ protected:
 
     static Status appendPlan(PlanNode* plan, PlanNode* appended);
 
+    // Check the parameters bound by the client against the statement planned in `qctx'.
+    // A parameter must not share the name with a variable of the plan, e.g. the anonymous
+    // ones and the loop counters, and each `$name' referred but not defined by the statement
+    // must be bound.
+    static Status validateParameters(const std::unordered_map<std::string, Value>& params,
+                                     const QueryContext* qctx);
+
     // use for simple Plan only contain one node
     template <typename Node, typename... Args>
     Status genSingleNodePlan(Args... args) {
@@ -80,6 +80,43 @@ TEST_F(QueryValidatorTest, GoZeroStep) {
     }
 }
 
+TEST_F(QueryValidatorTest, GoFromParameter) {
+    {
+        // The list of vids bound as a parameter is unwound at runtime
+        std::string query = "GO FROM $vids OVER like";
+        std::vector<PlanNode::Kind> expected = {
+            PK::kProject,
+            PK::kGetNeighbors,
+            PK::kDedup,
+            PK::kUnwind,
+            PK::kStart,
+        };
+        EXPECT_TRUE(checkResult(query, expected));
+    }
+    {
+        std::string query = "GO 2 STEPS FROM $vids OVER like";
+        std::vector<PlanNode::Kind> expected = {
+            PK::kProject,
+            PK::kGetNeighbors,
+            PK::kLoop,
+            PK::kDedup,
+            PK::kDedup,
+            PK::kUnwind,
+            PK::kProject,
+            PK::kStart,
+            PK::kGetNeighbors,
+            PK::kStart,
+        };
+        EXPECT_TRUE(checkResult(query, expected));
+    }
+    {
+        // Not a parameter but a variable of the query
+        std::string query = "$a = GO FROM \"1\" OVER like YIELD like._dst AS id; "
+                            "GO FROM $a OVER like";
+        EXPECT_FALSE(checkResult(query));
+    }
+}
+
 TEST_F(QueryValidatorTest, GoNSteps) {
     {
         std::string query = "GO 2 STEPS FROM \"1\" OVER like";
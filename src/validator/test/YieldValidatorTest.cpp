@@ -468,6 +468,33 @@ TEST_F(YieldValidatorTest, Error) {
     }
 }
 
+TEST_F(YieldValidatorTest, Parameters) {
+    {
+        auto result = validate("YIELD $p + 1 AS v");
+        ASSERT_TRUE(result.ok()) << result.status();
+        auto* qctx = std::move(result).value();
+        EXPECT_TRUE(Validator::validateParameters({{"p", 1}}, qctx).ok());
+        // Extra parameters which are not referred are allowed
+        EXPECT_TRUE(Validator::validateParameters({{"p", 1}, {"q", 2}}, qctx).ok());
+        auto status = Validator::validateParameters({}, qctx);
+        ASSERT_FALSE(status.ok());
+        EXPECT_EQ(std::string(status.toString()),
+                  "SemanticError: `$p' is neither a variable nor a bound parameter.");
+    }
+    {
+        auto result = validate("$a = YIELD 1 AS x; YIELD $a.x");
+        ASSERT_TRUE(result.ok()) << result.status();
+        auto* qctx = std::move(result).value();
+        auto status = Validator::validateParameters({{"a", 1}}, qctx);
+        ASSERT_FALSE(status.ok());
+        EXPECT_EQ(std::string(status.toString()),
+                  "SemanticError: Parameter `a' conflicts with a variable of the query.");
+        // The anonymous variables generated by the planner are guarded too
+        auto anon = qctx->plan()->root()->outputVar();
+        EXPECT_FALSE(Validator::validateParameters({{anon, 1}}, qctx).ok());
+    }
+}
+
 TEST_F(YieldValidatorTest, AggCall) {
     {
         std::string query = "YIELD COUNT(1), $-.name";